@@ -0,0 +1,193 @@
+#pragma once
+
+// 界面操作执行器：菜单/按钮触发的连接、断开、刷新等操作投递到固定数量的工作线程，
+// 队列有上限；带合并键的任务在同键任务仍在排队时直接合并（不再排队）。
+// SingleFlight：同一时刻只执行一次，期间的并发调用等待并共享这一次的结果（用于带扫描的设备刷新）。
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ActionExecutorStats {
+    uint64_t submitted = 0;     // 接受的任务
+    uint64_t executed = 0;      // 执行完的任务
+    uint64_t coalesced = 0;     // 因同键任务已在排队而合并的任务
+    uint64_t rejected = 0;      // 队列满或已关闭而拒绝的任务
+    size_t depth = 0;           // 当前排队数
+    size_t maxDepth = 0;        // 排队数峰值
+};
+
+class ActionExecutor {
+public:
+    typedef std::function<void()> Task;
+
+    ActionExecutor(int workerCount, size_t maxQueue)
+        : maxQueue_(maxQueue > 0 ? maxQueue : 1) {
+        if (workerCount < 1) workerCount = 1;
+        for (int i = 0; i < workerCount; i++) {
+            workers_.emplace_back(&ActionExecutor::WorkerLoop, this);
+        }
+    }
+
+    ~ActionExecutor() {
+        Shutdown();
+    }
+
+    ActionExecutor(const ActionExecutor&) = delete;
+    ActionExecutor& operator=(const ActionExecutor&) = delete;
+
+    // 投递任务；coalesceKey 非空且同键任务尚未开始执行时合并。被合并时也返回 true，拒绝时返回 false
+    bool Post(Task task, const std::string& coalesceKey = std::string()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            stats_.rejected++;
+            return false;
+        }
+        if (!coalesceKey.empty()) {
+            for (const auto& job : queue_) {
+                if (job.key == coalesceKey) {
+                    stats_.coalesced++;
+                    return true;
+                }
+            }
+        }
+        if (queue_.size() >= maxQueue_) {
+            stats_.rejected++;
+            return false;
+        }
+        queue_.push_back({ task, coalesceKey });
+        stats_.submitted++;
+        if (queue_.size() > stats_.maxDepth) stats_.maxDepth = queue_.size();
+        cv_.notify_one();
+        return true;
+    }
+
+    // 停止接受任务并丢弃排队中的任务，等待正在执行的任务完成
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return;
+            stopping_ = true;
+            queue_.clear();
+            cv_.notify_all();
+        }
+        for (auto& t : workers_) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    ActionExecutorStats Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ActionExecutorStats s = stats_;
+        s.depth = queue_.size();
+        return s;
+    }
+
+private:
+    struct Job {
+        Task task;
+        std::string key;
+    };
+
+    void WorkerLoop() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            job.task();
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.executed++;
+        }
+    }
+
+    size_t maxQueue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> queue_;
+    std::vector<std::thread> workers_;
+    ActionExecutorStats stats_;
+    bool stopping_ = false;
+};
+
+template <class T>
+class SingleFlight {
+public:
+    // 没有进行中的调用时执行 fn 并返回结果；否则等待进行中的那次完成，返回它的结果。
+    // fn 抛出异常时本次调用同样结束，等待方收到同一个异常
+    template <class Fn>
+    T Do(Fn fn) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (flight_) {
+            std::shared_ptr<Flight> flight = flight_;
+            coalesced_++;
+            cv_.wait(lock, [&flight] { return flight->done; });
+            if (flight->error) std::rethrow_exception(flight->error);
+            return flight->value;
+        }
+        std::shared_ptr<Flight> flight = std::make_shared<Flight>();
+        flight_ = flight;
+        lock.unlock();
+
+        Landing landing(*this, flight);
+        try {
+            flight->value = fn();
+        } catch (...) {
+            landing.error = std::current_exception();
+            throw;
+        }
+        return flight->value;
+    }
+
+    uint64_t Calls() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return calls_;
+    }
+
+    // 等待共享结果、没有自己执行的调用次数
+    uint64_t Coalesced() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return coalesced_;
+    }
+
+private:
+    struct Flight {
+        T value;
+        std::exception_ptr error;
+        bool done = false;
+    };
+
+    // 在每条退出路径上结束进行中的调用：否则 fn 抛出异常后等待方永远等待，之后的调用也都只会等待
+    struct Landing {
+        Landing(SingleFlight& o, const std::shared_ptr<Flight>& f) : owner(o), flight(f) {}
+        ~Landing() {
+            std::lock_guard<std::mutex> lock(owner.mutex_);
+            flight->error = error;
+            flight->done = true;
+            owner.flight_.reset();
+            owner.calls_++;
+            owner.cv_.notify_all();
+        }
+
+        SingleFlight& owner;
+        std::shared_ptr<Flight> flight;
+        std::exception_ptr error;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::shared_ptr<Flight> flight_;
+    uint64_t calls_ = 0;
+    uint64_t coalesced_ = 0;
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+// 到达时间预测：按一天中的时段（96 个 15 分钟时段）记录每台设备过去的到达（离线一段时间后重新连接）。
+// 每次到达先把该设备已有的权重乘以 DECAY 再在到达时段加一，规律改变后旧记录逐渐失去作用。
+// 预测：当前时段前后 WINDOW_SLOTS 个时段内的权重占该设备总权重的比例达到 EXPECT_SHARE 即"预计即将到达"；
+// 总权重不足 MIN_WEIGHT（约 3 次到达）时视为尚无规律。
+// 持久化到 arrival_history.txt，每行 "地址 时段:权重×100 ..."，只写非零时段。线程安全。
+
+#include "BtTypes.h"
+
+#include <cstdint>
+#include <cwchar>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+enum class ArrivalOutlook {
+    Unknown,    // 到达次数不足，没有规律可用
+    Expected,   // 预计在当前时刻前后到达
+    Unlikely,   // 当前时刻前后通常不会到达
+};
+
+struct ArrivalPredictorStats {
+    size_t devices = 0;             // 有记录的设备
+    size_t learned = 0;             // 已有规律的设备
+    uint64_t arrivals = 0;          // 本次运行记录的到达
+    uint64_t predicted = 0;         // 其中到达时设备已有规律的次数
+    uint64_t hits = 0;              // 其中落在"预计即将到达"时段内的次数
+};
+
+class ArrivalPredictor {
+public:
+    static constexpr int SLOTS = 96;
+    static constexpr int64_t SLOT_MS = 15 * 60000;
+    static constexpr int64_t DAY_MS = SLOTS * SLOT_MS;
+    static constexpr int WINDOW_SLOTS = 2;              // 前后各 30 分钟
+    static constexpr float DECAY = 0.9f;
+    static constexpr float MIN_WEIGHT = 2.5f;
+    static constexpr float EXPECT_SHARE = 0.2f;
+    static constexpr int64_t MIN_ABSENCE_MS = 10 * 60000;  // 离线不足 10 分钟的重连（链路抖动）不算到达
+
+    // 一天中的毫秒数（0 ~ DAY_MS-1）所在的时段
+    static int SlotOf(int64_t msOfDay) {
+        int64_t ms = msOfDay % DAY_MS;
+        if (ms < 0) ms += DAY_MS;
+        return (int)(ms / SLOT_MS);
+    }
+
+    // 记录一次到达；absenceMs 为离线时长，-1 表示未知（例如启动时就不在线）
+    // 返回是否计入（离线太短不计入）
+    bool RecordArrival(BtAddr address, int64_t msOfDay, int64_t absenceMs) {
+        if (absenceMs >= 0 && absenceMs < MIN_ABSENCE_MS) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        History& history = entries_[address & BT_ADDR_MASK];
+        int slot = SlotOf(msOfDay);
+        arrivals_++;
+        if (history.total >= MIN_WEIGHT) {
+            predicted_++;
+            if (IsExpected(history, slot)) hits_++;
+        }
+        history.total = 0;
+        for (int i = 0; i < SLOTS; i++) {
+            history.weights[i] *= DECAY;
+            history.total += history.weights[i];
+        }
+        history.weights[slot] += 1.0f;
+        history.total += 1.0f;
+        return true;
+    }
+
+    ArrivalOutlook Outlook(BtAddr address, int64_t msOfDay) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(address & BT_ADDR_MASK);
+        if (it == entries_.end() || it->second.total < MIN_WEIGHT) return ArrivalOutlook::Unknown;
+        return IsExpected(it->second, SlotOf(msOfDay)) ? ArrivalOutlook::Expected : ArrivalOutlook::Unlikely;
+    }
+
+    ArrivalPredictorStats Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ArrivalPredictorStats s;
+        s.devices = entries_.size();
+        for (const auto& entry : entries_) {
+            if (entry.second.total >= MIN_WEIGHT) s.learned++;
+        }
+        s.arrivals = arrivals_;
+        s.predicted = predicted_;
+        s.hits = hits_;
+        return s;
+    }
+
+    // 读取记录文件（替换内存中的结果），格式错误的项忽略
+    void Load(std::wistream& in) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        std::wstring line;
+        while (std::getline(in, line)) {
+            size_t commentPos = line.find(L'#');
+            if (commentPos != std::wstring::npos) line = line.substr(0, commentPos);
+
+            std::wistringstream fields(line);
+            std::wstring addrText, slotText;
+            BtAddr address;
+            if (!(fields >> addrText) || !ParseBtAddr(addrText, address)) continue;
+            History history;
+            while (fields >> slotText) {
+                unsigned slot = 0, weight = 0;
+                if (swscanf(slotText.c_str(), L"%u:%u", &slot, &weight) != 2 || slot >= (unsigned)SLOTS) continue;
+                history.weights[slot] = weight / 100.0f;
+                history.total += history.weights[slot];
+            }
+            if (history.total > 0) entries_[address] = history;
+        }
+    }
+
+    void Save(std::wostream& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out << L"# 设备到达时段记录（自动生成）：地址 时段(15 分钟):权重×100\n";
+        for (const auto& entry : entries_) {
+            out << BtAddrToString(entry.first);
+            for (int i = 0; i < SLOTS; i++) {
+                unsigned weight = (unsigned)(entry.second.weights[i] * 100.0f + 0.5f);
+                if (weight > 0) out << L" " << i << L":" << weight;
+            }
+            out << L"\n";
+        }
+    }
+
+private:
+    struct History {
+        float weights[SLOTS] = {};
+        float total = 0;
+    };
+
+    static bool IsExpected(const History& history, int slot) {
+        float around = 0;
+        for (int d = -WINDOW_SLOTS; d <= WINDOW_SLOTS; d++) {
+            around += history.weights[(slot + d + SLOTS) % SLOTS];
+        }
+        return around >= history.total * EXPECT_SHARE;
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<BtAddr, History> entries_;
+    uint64_t arrivals_ = 0;
+    uint64_t predicted_ = 0;
+    uint64_t hits_ = 0;
+};
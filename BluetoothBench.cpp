@@ -0,0 +1,2404 @@
+// 跨平台基准程序：使用模拟蓝牙组件运行监控核心逻辑，不依赖真实硬件，可在 Linux CI 上构建运行
+//
+// 用法:
+//   BluetoothBench            运行全部场景
+//   BluetoothBench <场景>...  只运行指定场景
+//   BluetoothBench --list     列出场景
+//   BluetoothBench --help     显示用法
+//
+// 各场景带有结果检查（一致性、泄漏、上限等，只检查与计时无关或留有足够余量的条件）；
+// 任一场景检查未通过时退出码为 1，CI 据此判定失败
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <codecvt>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <locale>
+#include <map>
+#include <mutex>
+#include <new>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ActionExecutor.h"
+#include "ArrivalPredictor.h"
+#include "Cancellation.h"
+#include "Clock.h"
+#include "DeviceDiff.h"
+#include "DeviceFeed.h"
+#include "DeviceRegistry.h"
+#include "DeviceStore.h"
+#include "LinkWaiter.h"
+#include "LogRing.h"
+#include "LogStore.h"
+#include "Metrics.h"
+#include "MonitorCore.h"
+#include "MonitorScheduler.h"
+#include "MonitorSupervisor.h"
+#include "PresenceEngine.h"
+#include "RadioManager.h"
+#include "ReconnectPool.h"
+#include "ScanArena.h"
+#include "ServiceCache.h"
+#include "ServiceRanking.h"
+#include "SimBluetooth.h"
+#include "Snapshot.h"
+
+using namespace std;
+
+// 全局分配计数：替换 operator new，用于检查稳态路径是否分配内存（计数为 relaxed 原子操作）
+static atomic<uint64_t> g_allocations{ 0 };
+
+// GCC 把内联后的 new/malloc 与 delete/free 配对视为不匹配（-Wmismatched-new-delete），这里的配对是有意的
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+// 宽字符串转 UTF-8，供 printf 输出头文件中的中文名称
+static string Utf8(const wstring& text) {
+    return wstring_convert<codecvt_utf8<wchar_t>>().to_bytes(text);
+}
+
+// 取样本的百分位（p 取 0~100）
+static uint64_t Percentile(vector<uint64_t> samples, double p) {
+    if (samples.empty()) return 0;
+    sort(samples.begin(), samples.end());
+    size_t idx = (size_t)(p / 100.0 * (samples.size() - 1) + 0.5);
+    return samples[min(idx, samples.size() - 1)];
+}
+
+// 场景：事件源投递 → 监控循环开始处理（发起连接）的延迟
+static bool BenchPresenceLatency() {
+    const int EVENTS = 2000;
+
+    PresenceEngine engine;
+    SimulatedPresenceSource source;
+    engine.AddSource(&source);
+    bool eventDriven = engine.Start();
+
+    mutex samplesMutex;
+    vector<uint64_t> samples;
+    samples.reserve(EVENTS);
+
+    thread consumer([&]() {
+        vector<PresenceEvent> events;
+        while (true) {
+            PresenceWake wake = engine.WaitFor(events, -1);
+            if (wake == PresenceWake::Stopped) break;
+            if (wake != PresenceWake::Events) continue;
+            for (const auto& ev : events) {
+                uint64_t us = engine.NoteReaction(ev);
+                lock_guard<mutex> lock(samplesMutex);
+                samples.push_back(us);
+            }
+        }
+    });
+
+    for (int i = 0; i < EVENTS; i++) {
+        source.Emit(PresenceEventType::Arrived, 0x001A7DDA7100ull + (i % 16));
+        this_thread::sleep_for(chrono::microseconds(200));
+    }
+
+    // 等待消费完毕
+    for (int i = 0; i < 200; i++) {
+        {
+            lock_guard<mutex> lock(samplesMutex);
+            if ((int)samples.size() >= EVENTS) break;
+        }
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+
+    // 事件源失效后调度器切换到回退轮询间隔
+    VirtualClock clock;
+    DeviceRegistry registry;
+    MonitorScheduler scheduler(clock, registry);
+    scheduler.Start(engine.IsEventDriven());
+    int eventPollMs = scheduler.PollIntervalMs();
+    source.SetAlive(false);
+    scheduler.SetEventDriven(engine.IsEventDriven());
+    int fallbackPollMs = scheduler.PollIntervalMs();
+
+    engine.Stop();
+    consumer.join();
+
+    int pollOnlyInquiryMs = 5000 * 3;   // 原先：5 秒轮询，每 3 次做一次主动扫描
+
+    printf("[presence] 事件驱动=%s 事件数=%d 已处理=%zu\n", eventDriven ? "是" : "否", EVENTS, samples.size());
+    printf("[presence] 检测→处理延迟 p50=%llu us p99=%llu us max=%llu us\n",
+        (unsigned long long)Percentile(samples, 50), (unsigned long long)Percentile(samples, 99),
+        (unsigned long long)Percentile(samples, 100));
+    printf("[presence] 纯轮询基线：平均 %d ms，最差 %d ms（每 %d ms 一次主动扫描）\n",
+        pollOnlyInquiryMs / 2, pollOnlyInquiryMs, pollOnlyInquiryMs);
+    printf("[presence] 兜底轮询间隔：事件源正常 %d ms，事件源失效后 %d ms\n", eventPollMs, fallbackPollMs);
+    return eventDriven && (int)samples.size() == EVENTS && fallbackPollMs < eventPollMs;
+}
+
+// 场景：多台离线设备同时重连，总耗时随每无线电并发上限的变化
+static bool BenchReconnectPool() {
+    const int DEVICES = 8;
+    const int CONNECT_MS = 50;     // 模拟一次完整的服务切换序列（按 1:20 缩短）
+    const int limits[] = { 1, 2, 4, 8 };
+
+    bool ok = true;
+    for (int limit : limits) {
+        SimulatedRadio radio(CONNECT_MS);
+        ReconnectPool pool(8, limit);
+
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < DEVICES; i++) {
+            BtAddr addr = 0x001A7DDA7100ull + i;
+            pool.Submit(addr, 0, [&radio, addr]() { return radio.Connect(addr); });
+        }
+        pool.WaitIdle();
+        auto totalMs = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+
+        vector<ReconnectResult> results;
+        pool.DrainResults(results);
+        vector<uint64_t> delays;
+        for (const auto& r : results) delays.push_back((uint64_t)r.queueDelayMs);
+        ok = ok && radio.MaxConcurrent() <= limit && (int)results.size() == DEVICES;
+
+        printf("[reconnect-pool] 并发上限=%d 设备=%d 总耗时=%lld ms 最大并发=%d 排队延迟 p50=%llu ms max=%llu ms\n",
+            limit, DEVICES, (long long)totalMs, radio.MaxConcurrent(),
+            (unsigned long long)Percentile(delays, 50), (unsigned long long)Percentile(delays, 100));
+    }
+    printf("[reconnect-pool] 串行基线（原先在监控循环内逐个连接）= %d ms\n", DEVICES * CONNECT_MS);
+    return ok;
+}
+
+// 场景：虚拟时钟上运行调度器，验证探测退避序列，并统计大量离线设备下一小时的唤醒与计时器开销
+static bool BenchScheduler() {
+    // 单台设备：断开后每次探测都失败，记录探测时间点
+    {
+        VirtualClock clock;
+        DeviceRegistry registry;
+        const BtAddr addr = 0x001A7DDA7100ull;
+        registry.Upsert(addr).monitored = true;
+        MonitorScheduler scheduler(clock, registry);
+        scheduler.Start(true);
+        scheduler.OnDeviceLost(addr);
+
+        vector<DueWork> due;
+        printf("[scheduler] 单设备探测时间点（秒）:");
+        int probes = 0;
+        while (probes < 8) {
+            clock.Advance(scheduler.MsUntilNext());
+            scheduler.Collect(due);
+            for (const auto& work : due) {
+                if (work.kind != ScheduledWork::Probe) continue;
+                printf(" %.1f", clock.NowMs() / 1000.0);
+                scheduler.OnAttemptStarted(work.address);
+                scheduler.OnAttemptFailed(work.address);
+                probes++;
+            }
+        }
+        printf("\n");
+    }
+
+    // 多台设备：全部离线且连接总是失败，模拟一小时
+    const int counts[] = { 10, 100, 1000 };
+    const int64_t HOUR_MS = 3600 * 1000;
+    bool ok = true;
+    for (int devices : counts) {
+        VirtualClock clock;
+        DeviceRegistry registry(devices);
+        for (int i = 0; i < devices; i++) registry.Upsert(0x001A7DDA0000ull + i).monitored = true;
+        MonitorScheduler scheduler(clock, registry);
+        scheduler.Start(true);
+        for (const auto& record : registry) scheduler.OnDeviceLost(record.address);
+
+        unordered_map<BtAddr, int64_t> lastAttempt;
+        vector<DueWork> due;
+        uint64_t wakeups = 0, polls = 0, inquiries = 0, probes = 0, cooldownViolations = 0;
+
+        auto start = chrono::steady_clock::now();
+        while (clock.NowMs() < HOUR_MS) {
+            clock.Advance(scheduler.MsUntilNext());
+            wakeups++;
+            scheduler.Collect(due);
+            for (const auto& work : due) {
+                if (work.kind == ScheduledWork::Poll) polls++;
+                else if (work.kind == ScheduledWork::Inquiry) inquiries++;
+                else if (work.kind == ScheduledWork::Probe) {
+                    probes++;
+                    auto it = lastAttempt.find(work.address);
+                    if (it != lastAttempt.end() && clock.NowMs() - it->second < scheduler.Options().cooldownMs) cooldownViolations++;
+                    lastAttempt[work.address] = clock.NowMs();
+                    scheduler.OnAttemptStarted(work.address);
+                    scheduler.OnAttemptFailed(work.address);
+                }
+            }
+        }
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        ok = ok && cooldownViolations == 0;
+
+        // 原先：每 5 秒唤醒一次并遍历全部设备，每 15 秒对每台离线设备尝试一次连接
+        uint64_t legacyWakeups = HOUR_MS / 5000;
+        uint64_t legacyAttempts = (uint64_t)(HOUR_MS / 15000) * devices;
+
+        printf("[scheduler] 设备=%d 虚拟 1 小时：唤醒=%llu 轮询=%llu 扫描=%llu 探测=%llu 冷却违例=%llu 处理耗时=%.2f ms（%.0f ns/探测）\n",
+            devices, (unsigned long long)wakeups, (unsigned long long)polls, (unsigned long long)inquiries,
+            (unsigned long long)probes, (unsigned long long)cooldownViolations, ns / 1e6,
+            probes ? (double)ns / probes : 0.0);
+        printf("[scheduler] 设备=%d 原固定节奏：唤醒=%llu 设备检查=%llu 连接尝试=%llu\n",
+            devices, (unsigned long long)legacyWakeups, (unsigned long long)(legacyWakeups * devices),
+            (unsigned long long)legacyAttempts);
+    }
+    return ok;
+}
+
+// 场景：一次轮询中把枚举结果与被监控设备对应起来，并查询阻止/冷却状态
+// 原实现：嵌套循环 memcmp 比较地址（O(N×M)），阻止/冷却表以格式化的 MAC 字符串为键
+static bool BenchDeviceRegistry() {
+    struct LegacyAddress { unsigned char rgBytes[8]; };    // 与 BLUETOOTH_ADDRESS 同为 8 字节
+    struct LegacyDevice { LegacyAddress address; wstring name; bool connected; };
+
+    const int counts[] = { 10, 100, 1000 };
+    bool ok = true;
+    for (int devices : counts) {
+        vector<LegacyDevice> monitored;
+        DeviceRegistry registry(devices);
+        set<wstring> legacyBlocked;
+        unordered_map<wstring, int64_t> legacyLastAttempt;
+        for (int i = 0; i < devices; i++) {
+            BtAddr addr = 0x001A7D000000ull + (uint64_t)i * 0x10001ull;
+            LegacyDevice d;
+            memset(&d.address, 0, sizeof(d.address));
+            memcpy(d.address.rgBytes, &addr, 6);
+            d.name = L"Device " + to_wstring(i);
+            d.connected = (i % 3) == 0;
+            monitored.push_back(d);
+
+            DeviceRecord& record = registry.Upsert(addr);
+            record.name = d.name;
+            record.connected = d.connected;
+            record.monitored = true;
+            record.blockAutoReconnect = (i % 7) == 0;
+            if (d.connected) legacyLastAttempt[BtAddrToString(addr)] = i;
+            if (record.blockAutoReconnect) legacyBlocked.insert(BtAddrToString(addr));
+        }
+        // 枚举结果顺序与监控列表不同
+        vector<LegacyDevice> current(monitored.rbegin(), monitored.rend());
+
+        const int passes = max(20, 200000 / devices);
+        uint64_t legacyHits = 0, registryHits = 0;
+
+        auto start = chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (const auto& device : monitored) {
+                for (const auto& c : current) {
+                    if (memcmp(&c.address, &device.address, sizeof(LegacyAddress)) == 0) {
+                        BtAddr addr = 0;
+                        memcpy(&addr, c.address.rgBytes, 6);
+                        wstring mac = BtAddrToString(addr);
+                        if (legacyBlocked.count(mac) == 0 && legacyLastAttempt.find(mac) == legacyLastAttempt.end()) legacyHits++;
+                        break;
+                    }
+                }
+            }
+        }
+        double legacyNs = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / passes;
+
+        start = chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (const auto& c : current) {
+                BtAddr addr = 0;
+                memcpy(&addr, c.address.rgBytes, 6);
+                const DeviceRecord* record = registry.Find(addr);
+                if (record && record->monitored && !record->blockAutoReconnect && !record->connected) registryHits++;
+            }
+        }
+        double registryNs = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / passes;
+
+        printf("[device-registry] 设备=%d 每次轮询：原实现 %.1f us，注册表 %.2f us（%.0fx） 命中 %llu/%llu\n",
+            devices, legacyNs / 1000.0, registryNs / 1000.0, registryNs > 0 ? legacyNs / registryNs : 0.0,
+            (unsigned long long)(legacyHits / passes), (unsigned long long)(registryHits / passes));
+        ok = ok && legacyHits == registryHits;
+    }
+    return ok;
+}
+
+// 场景：把一次枚举结果与被监控设备逐台对应（实验室规模的设备数）。
+// 原实现为嵌套循环 memcmp 比较 8 字节地址；结构数组存储按路径（逐个 / SSE2 / AVX2）向量化比较连续存放的地址，
+// 枚举顺序与上一次相反时每台都要整段查找，顺序相同时按预期位置一次命中
+static bool BenchDeviceStore() {
+    struct LegacyAddress { unsigned char rgBytes[8]; };    // 与 BLUETOOTH_ADDRESS 同为 8 字节
+
+    printf("[device-store] 本机地址比较路径：%s\n", AddressMatch::PathName(AddressMatch::DetectedPath()));
+    bool ok = true;
+    for (int devices : { 16, 64, 256, 1024 }) {
+        DeviceStore store;
+        vector<LegacyAddress> monitored(devices);
+        vector<BtAddr> enumerated(devices);
+        for (int i = 0; i < devices; i++) {
+            BtAddr addr = 0x001A7D000000ull + (uint64_t)i * 0x10001ull;
+            memset(&monitored[i], 0, sizeof(LegacyAddress));
+            memcpy(monitored[i].rgBytes, &addr, 6);
+            store.Add(addr, L"Device " + to_wstring(i), i % 3 == 0, 0);
+            enumerated[devices - 1 - i] = addr;     // 枚举顺序与存储顺序相反
+        }
+        vector<LegacyAddress> legacyEnumerated(monitored.rbegin(), monitored.rend());
+
+        const int passes = max(20, 4000000 / (devices * devices));
+        auto timeIt = [&](const function<uint64_t()>& pass, uint64_t& checksum) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < passes; i++) checksum += pass();
+            return (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / passes;
+        };
+
+        uint64_t legacySum = 0;
+        double legacyNs = timeIt([&]() {
+            uint64_t sum = 0;
+            for (size_t m = 0; m < monitored.size(); m++) {
+                for (size_t e = 0; e < legacyEnumerated.size(); e++) {
+                    if (memcmp(&legacyEnumerated[e], &monitored[m], sizeof(LegacyAddress)) == 0) {
+                        sum += m;
+                        break;
+                    }
+                }
+            }
+            return sum;
+        }, legacySum);
+
+        double pathNs[3] = {};
+        uint64_t pathSum[3] = {};
+        for (AddressMatchPath path : { AddressMatchPath::Scalar, AddressMatchPath::Sse2, AddressMatchPath::Avx2 }) {
+            pathNs[(int)path] = timeIt([&]() {
+                uint64_t sum = 0;
+                for (BtAddr addr : enumerated) {
+                    int slot = AddressMatch::FindWith(path, store.Addresses(), store.Size(), addr);
+                    if (slot >= 0) sum += (uint64_t)slot;
+                }
+                return sum;
+            }, pathSum[(int)path]);
+        }
+
+        // 顺序与存储相同：按预期位置查找
+        vector<BtAddr> inOrder(enumerated.rbegin(), enumerated.rend());
+        uint64_t hintSum = 0;
+        double hintNs = timeIt([&]() {
+            uint64_t sum = 0;
+            size_t hint = 0;
+            for (BtAddr addr : inOrder) {
+                int slot = store.Find(addr, hint);
+                if (slot < 0) continue;
+                sum += (uint64_t)slot;
+                hint = (size_t)slot + 1;
+            }
+            return sum;
+        }, hintSum);
+
+        bool consistent = pathSum[0] == legacySum && pathSum[1] == legacySum && pathSum[2] == legacySum && hintSum == legacySum;
+        printf("[device-store] %4d 台每次匹配：嵌套 memcmp %.2f us；结构数组 逐个 %.2f us、SSE2 %.2f us、AVX2 %.2f us（%.1fx）；"
+            "顺序相同按预期位置 %.3f us；结果一致：%s\n",
+            devices, legacyNs / 1000.0, pathNs[0] / 1000.0, pathNs[1] / 1000.0, pathNs[2] / 1000.0,
+            pathNs[2] > 0 ? legacyNs / pathNs[2] : 0.0, hintNs / 1000.0, consistent ? "是" : "否");
+        ok = ok && consistent;
+    }
+    return ok;
+}
+
+// 场景：虚拟 1 小时内全部离线设备按调度器探测，每次连接（以及一半设备的一次手动断开）都需要服务列表
+static bool BenchServiceCache() {
+    const int DEVICES = 100;
+    const int64_t HOUR_MS = 3600 * 1000;
+
+    VirtualClock clock;
+    DeviceRegistry registry(DEVICES);
+    for (int i = 0; i < DEVICES; i++) registry.Upsert(0x001A7DDA0000ull + i).monitored = true;
+    MonitorScheduler scheduler(clock, registry);
+    scheduler.Start(true);
+    for (const auto& record : registry) scheduler.OnDeviceLost(record.address);
+
+    ServiceCache cache;
+    uint64_t lookups = 0, enumerations = 0;
+    const BtUuid sink = { 0x0000110B, 0x0000, 0x1000, { 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB } };
+    auto installedServices = [&](BtAddr address) {
+        vector<BtUuid> services;
+        lookups++;
+        if (!cache.Lookup(address, services)) {
+            enumerations++;         // 模拟一次 BluetoothEnumerateInstalledServices
+            services.push_back(sink);
+            cache.Store(address, services);
+        }
+        return services.size();
+    };
+
+    vector<DueWork> due;
+    while (clock.NowMs() < HOUR_MS) {
+        clock.Advance(scheduler.MsUntilNext());
+        scheduler.Collect(due);
+        for (const auto& work : due) {
+            if (work.kind != ScheduledWork::Probe) continue;
+            installedServices(work.address);
+            scheduler.OnAttemptStarted(work.address);
+            scheduler.OnAttemptFailed(work.address);
+        }
+    }
+    for (int i = 0; i < DEVICES; i += 2) installedServices(0x001A7DDA0000ull + i);
+
+    ServiceCacheStats stats = cache.Stats();
+    printf("[service-cache] 设备=%d 虚拟 1 小时：服务列表请求=%llu 实际枚举=%llu 命中=%llu 未命中=%llu（无缓存时每次请求都枚举）\n",
+        DEVICES, (unsigned long long)lookups, (unsigned long long)enumerations,
+        (unsigned long long)stats.hits, (unsigned long long)stats.misses);
+    bool passed = enumerations == (uint64_t)DEVICES;      // 一小时内每台只枚举一次
+
+    // 按 ConnectDevice 的规则连接：从服务列表中挑出音频服务，一个都没有时按全量尝试；
+    // 系统报告服务不存在时，原规则只要列表非空就丢弃缓存，新规则只在该服务取自缓存命中的列表时丢弃
+    const int CONNECTS = 20;
+    auto uuid16 = [](uint32_t id) { return BtUuid{ id, 0x0000, 0x1000, { 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB } }; };
+    vector<BtUuid> wanted;
+    for (uint32_t id : { 0x110Bu, 0x110Au, 0x111Eu, 0x1108u, 0x110Cu, 0x110Eu }) wanted.push_back(uuid16(id));
+    auto contains = [](const vector<BtUuid>& list, const BtUuid& uuid) {
+        return find(list.begin(), list.end(), uuid) != list.end();
+    };
+    struct ConnectCase {
+        const char* name;
+        vector<BtUuid> actual;          // 设备实际提供的服务
+        vector<BtUuid> afterFirst;      // 第一次连接后服务变化（为空表示不变）
+        uint64_t expected;              // 新规则下应有的枚举次数
+    };
+    const ConnectCase cases[] = {
+        { "音频耳机", { uuid16(0x110B), uuid16(0x110E) }, {}, 1 },
+        { "HID 键盘", { uuid16(0x1124), uuid16(0x1200) }, {}, 1 },
+        { "服务变化的耳机", { uuid16(0x110B), uuid16(0x111E) }, { uuid16(0x110B) }, 2 },
+    };
+    for (const auto& c : cases) {
+        uint64_t counts[2] = {};
+        for (int legacy = 1; legacy >= 0; legacy--) {
+            ServiceCache connectCache;
+            const BtAddr address = 0x001A7DDA7200ull;
+            vector<BtUuid> actual = c.actual;
+            uint64_t& connectEnumerations = counts[legacy];
+            for (int i = 0; i < CONNECTS; i++) {
+                vector<BtUuid> installed;
+                bool fromCache = connectCache.Lookup(address, installed);
+                if (!fromCache) {
+                    connectEnumerations++;
+                    installed = actual;
+                    connectCache.Store(address, installed);
+                }
+                vector<BtUuid> services;
+                for (const auto& w : wanted) if (contains(installed, w)) services.push_back(w);
+                if (services.empty()) services = wanted;
+                for (const auto& svc : services) {
+                    if (contains(actual, svc)) continue;        // ERROR_SERVICE_DOES_NOT_EXIST
+                    if (legacy) {
+                        if (!installed.empty()) connectCache.Invalidate(address);
+                    } else {
+                        connectCache.OnServiceMissing(address, svc, fromCache);
+                    }
+                }
+                if (i == 0 && !c.afterFirst.empty()) actual = c.afterFirst;
+            }
+        }
+        bool ok = counts[0] == c.expected;
+        passed = passed && ok;
+        printf("[service-cache] %s 连接 %d 次：服务枚举 原规则 %llu 次，新规则 %llu 次（应为 %llu）— %s\n",
+            c.name, CONNECTS, (unsigned long long)counts[1], (unsigned long long)counts[0],
+            (unsigned long long)c.expected, ok ? "通过" : "未通过");
+    }
+    return passed;
+}
+
+// 场景：多线程并发连接/断开时的适配器句柄复用，中途模拟一次适配器拔插
+static bool BenchRadioManager() {
+    const int THREADS = 4;
+    const int CALLS = 500;     // 每线程的连接/断开次数
+
+    FakeRadioBackend backend(1);
+    RadioStats stats;
+    {
+        RadioManager radios(backend);
+        atomic<int> done{0};
+        vector<thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < CALLS; i++) {
+                    RadioLease radio = radios.Acquire();
+                    if (!radio) continue;
+                    // 句柄已失效：与 BluetoothSetServiceState 返回句柄错误时的处理一致
+                    if (!backend.IsValid(radio.Get())) radios.ReportFailure(radio);
+                    if (++done == THREADS * CALLS / 2) backend.Replug();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        stats = radios.Stats();
+    }
+
+    printf("[radio-manager] 调用=%d 借用=%llu 复用=%llu 打开=%llu 重新打开=%llu 句柄错误=%llu\n",
+        THREADS * CALLS, (unsigned long long)stats.acquires, (unsigned long long)stats.reuses,
+        (unsigned long long)stats.opens, (unsigned long long)stats.reopens, (unsigned long long)stats.failures);
+    printf("[radio-manager] 实际打开句柄=%llu（原实现每次调用打开一次=%d），销毁后未关闭句柄=%zu\n",
+        (unsigned long long)backend.Opened(), THREADS * CALLS, backend.OpenHandles());
+    return backend.OpenHandles() == 0;
+}
+
+// 场景：设备实际由第 3 个服务建立连接时，学习前后的连接耗时（按 ConnectDevice 的固定等待计算），
+// 并验证排名保存/读取后顺序不变（模拟重启）
+static bool BenchServiceRanking() {
+    const int DISABLE_WAIT_MS = 150;
+    const int LINK_WAIT_MS = 1200;
+    const BtAddr addr = 0x001A7DDA7101ull;
+
+    // A2DP 接收器/音频源、免提、头戴式、AVRCP 目标/控制器（与 ConnectDevice 的默认顺序一致）
+    vector<BtUuid> wanted;
+    const uint32_t ids[] = { 0x110B, 0x110A, 0x111E, 0x1108, 0x110C, 0x110E };
+    for (uint32_t id : ids) wanted.push_back(BtUuid{ id, 0x0000, 0x1000, { 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB } });
+    const BtUuid linkService = wanted[2];
+
+    ServiceRanking ranking;
+    auto connectOnce = [&](ServiceRanking& r) {
+        bool learned = r.HasRanking(addr);
+        uint64_t ms = 0;
+        for (const auto& svc : r.Order(addr, wanted)) {
+            ms += DISABLE_WAIT_MS + LINK_WAIT_MS;
+            if (svc == linkService) break;
+        }
+        r.RecordConnectTime(ms, learned);
+        r.RecordSuccess(addr, linkService);
+        return ms;
+    };
+
+    printf("[service-ranking] 逐次连接耗时（ms）:");
+    for (int i = 0; i < 5; i++) printf(" %llu", (unsigned long long)connectOnce(ranking));
+    printf("\n");
+
+    wstringstream file;
+    ranking.Save(file);
+    ServiceRanking restarted;
+    restarted.Load(file);
+    uint64_t afterRestart = connectOnce(restarted);
+
+    ConnectTimingStats stats = ranking.Timing();
+    printf("[service-ranking] 学习前平均 %llu ms（%llu 次），学习后平均 %llu ms（%llu 次），重启后首次 %llu ms\n",
+        (unsigned long long)stats.UnlearnedAvgMs(), (unsigned long long)stats.unlearnedConnects,
+        (unsigned long long)stats.LearnedAvgMs(), (unsigned long long)stats.learnedConnects,
+        (unsigned long long)afterRestart);
+    return afterRestart == (uint64_t)(DISABLE_WAIT_MS + LINK_WAIT_MS);     // 重启后第一个就试实际建链的服务
+}
+
+static bool BenchLinkWaiter() {
+    // 各类设备的建链耗时范围（毫秒）：音频设备常超过 1.2 s，外设通常几百毫秒
+    struct LinkProfile { uint32_t deviceClass; int minMs; int maxMs; };
+    const LinkProfile profiles[] = { { 0x04, 600, 2600 }, { 0x05, 80, 400 } };
+    const int FIXED_WAIT_MS = 1200;
+    const int CONNECTS = 200;
+
+    VirtualClock clock(0);
+    LinkWaiter waiter(clock);
+    mt19937 rng(42);
+    bool ok = true;
+    for (const auto& profile : profiles) {
+        uniform_int_distribution<int> linkMs(profile.minMs, profile.maxMs);
+        uint64_t fixedTotal = 0, adaptiveTotal = 0, polls = 0;
+        int fixedMissed = 0, adaptiveMissed = 0;
+        for (int i = 0; i < CONNECTS; i++) {
+            int link = linkMs(rng);
+
+            // 旧实现：固定等待 1200 ms 后检查一次
+            fixedTotal += FIXED_WAIT_MS;
+            if (link > FIXED_WAIT_MS) fixedMissed++;
+
+            int64_t start = clock.NowMs();
+            LinkWaitResult result = waiter.Wait(profile.deviceClass, [&]() { return clock.NowMs() - start >= link; });
+            adaptiveTotal += result.elapsedMs;
+            polls += result.polls;
+            if (!result.linked) adaptiveMissed++;
+        }
+        printf("[link-waiter] %s：固定等待平均 %llu ms、误判失败 %d 次；自适应平均 %llu ms、误判失败 %d 次、平均轮询 %.1f 次，学习后截止 %d ms\n",
+            Utf8(MajorDeviceClassName(profile.deviceClass)).c_str(),
+            (unsigned long long)(fixedTotal / CONNECTS), fixedMissed,
+            (unsigned long long)(adaptiveTotal / CONNECTS), adaptiveMissed, (double)polls / CONNECTS,
+            waiter.DeadlineMs(profile.deviceClass));
+        ok = ok && adaptiveMissed == 0;
+    }
+
+    for (const auto& s : waiter.Stats()) {
+        printf("[link-waiter] %s 分布：p50 %lld ms，p95 %lld ms，最大 %lld ms\n",
+            Utf8(MajorDeviceClassName(s.deviceClass)).c_str(), (long long)s.p50Ms, (long long)s.p95Ms, (long long)s.maxMs);
+    }
+    return ok;
+}
+
+// 场景：停止监控时进行中的连接多久结束（真实时间）。4 个不在场设备的连接同时进行，随机时刻停止并等待重连池关闭：
+// 原实现固定 Sleep、不检查停止，要等完整的服务切换序列；可取消的实现在每次 API 调用之间检查并在条件变量上等待，
+// 只需等当前这一次不可中断的 API 调用。另测截止时间：超过截止时间后多久返回
+static bool BenchCancelConnect() {
+    const int CONNECTS = 4;
+    SimToggleOptions toggleOptions;
+    toggleOptions.services = 2;
+    LinkWaitOptions linkOptions;
+    linkOptions.deadlineMs = 500;
+    SteadyClock clock;
+    LinkWaiter waiter(clock, linkOptions);
+    SimServiceToggle toggle(waiter, []() { return false; }, toggleOptions);
+    mt19937 rng(23);
+    uniform_int_distribution<int> stopAfterMs(50, 500);
+
+    auto stopLatency = [&](bool cancellable, int trials) {
+        vector<uint64_t> latencies;
+        for (int t = 0; t < trials; t++) {
+            CancelSource cancel;
+            ReconnectPool pool(CONNECTS, CONNECTS);
+            for (int i = 0; i < CONNECTS; i++) {
+                pool.Submit((BtAddr)(0x1000 + i), 0, [&toggle, &clock, &cancel, cancellable]() {
+                    if (!cancellable) return toggle.ConnectUncancellable();
+                    OperationContext op(clock, cancel.Token(), 20000);
+                    return toggle.Connect(op);
+                });
+            }
+            this_thread::sleep_for(chrono::milliseconds(stopAfterMs(rng)));
+            auto stopAt = chrono::steady_clock::now();
+            cancel.Cancel();
+            pool.Shutdown();
+            latencies.push_back((uint64_t)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - stopAt).count());
+        }
+        return latencies;
+    };
+
+    vector<uint64_t> legacy = stopLatency(false, 3);
+    vector<uint64_t> cancellable = stopLatency(true, 10);
+    printf("[cancel-connect] 停止延迟（%d 个连接进行中，单次 API %d ms）：原实现 p50 %.1f ms、最大 %.1f ms；"
+        "可取消 p50 %.1f ms、最大 %.1f ms\n", CONNECTS, toggleOptions.apiMs,
+        Percentile(legacy, 50) / 1000.0, Percentile(legacy, 100) / 1000.0,
+        Percentile(cancellable, 50) / 1000.0, Percentile(cancellable, 100) / 1000.0);
+    // 可取消实现最慢的一次也应快于原实现最快的一次（两者相差两个数量级，计时抖动不影响）
+    bool ok = Percentile(cancellable, 100) < Percentile(legacy, 0);
+
+    for (int deadlineMs : { 200, 700 }) {
+        CancelSource cancel;
+        OperationContext op(clock, cancel.Token(), deadlineMs);
+        auto start = chrono::steady_clock::now();
+        bool connected = toggle.Connect(op);
+        uint64_t elapsedUs = (uint64_t)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        printf("[cancel-connect] 截止 %d ms：%.1f ms 后返回（%s，%s）\n", deadlineMs, elapsedUs / 1000.0,
+            connected ? "已连接" : "未连接", Utf8(OperationStatusName(op.Check())).c_str());
+        ok = ok && !connected && op.Check() == OperationStatus::TimedOut;
+    }
+    return ok;
+}
+
+// 场景：GUI 监控循环的停止与重启（真实时间）。循环收到停止后还要 TEARDOWN_MS 收尾（结束扫描线程、关闭重连池）。
+// 原实现：g_bRunning 标志 + new thread，循环按 500 ms 分片检查标志；重启由另起的清理线程 join 旧线程、Sleep(500) 后再启动，
+// 停止后马上再启动时旧循环又看到标志为 true，两个循环同时运行。监督者在同一线程中依次运行循环，停止标记直接唤醒等待
+static bool BenchSupervisor() {
+    const int SLICE_MS = 500;
+    const int TEARDOWN_MS = 30;
+    const int RESTART_SLEEP_MS = 500;
+    atomic<int> active{0};
+    atomic<int> maxActive{0};
+    auto enter = [&]() {
+        int now = ++active;
+        int prev = maxActive.load();
+        while (now > prev && !maxActive.compare_exchange_weak(prev, now)) {
+        }
+    };
+    auto sinceUs = [](chrono::steady_clock::time_point start) {
+        return (uint64_t)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    };
+    mt19937 rng(24);
+    uniform_int_distribution<int> runMs(20, 200);
+
+    // 原实现（分离的清理线程收集起来，场景结束时等待）
+    vector<uint64_t> legacyRestarts;
+    int legacyOverlap = 0;
+    {
+        atomic<bool> running{false};
+        atomic<uint64_t> loopStarts{0};
+        mutex cleanupMutex;
+        vector<thread> cleanups;
+        auto loop = [&]() {
+            enter();
+            loopStarts++;
+            while (running) this_thread::sleep_for(chrono::milliseconds(SLICE_MS));
+            this_thread::sleep_for(chrono::milliseconds(TEARDOWN_MS));
+            --active;
+        };
+        running = true;
+        thread* current = new thread(loop);
+        for (int i = 0; i < 3; i++) {
+            this_thread::sleep_for(chrono::milliseconds(runMs(rng)));
+            uint64_t before = loopStarts;
+            auto requestedAt = chrono::steady_clock::now();
+            running = false;
+            thread* old = current;
+            thread* next = nullptr;
+            thread cleanup([&, old]() {
+                old->join();
+                delete old;
+                this_thread::sleep_for(chrono::milliseconds(RESTART_SLEEP_MS));
+                running = true;
+                next = new thread(loop);
+            });
+            cleanup.join();
+            current = next;
+            while (loopStarts == before) this_thread::yield();
+            legacyRestarts.push_back(sinceUs(requestedAt));
+        }
+
+        // 停止按钮后立即点开始：清理线程还在等旧循环，新线程已经启动
+        maxActive = 0;
+        running = false;
+        thread* old = current;
+        {
+            lock_guard<mutex> lock(cleanupMutex);
+            cleanups.emplace_back([old]() {
+                old->join();
+                delete old;
+            });
+        }
+        running = true;
+        current = new thread(loop);
+        this_thread::sleep_for(chrono::milliseconds(SLICE_MS + 100));
+        legacyOverlap = maxActive;
+        running = false;
+        current->join();
+        delete current;
+        for (auto& t : cleanups) t.join();
+    }
+
+    // 监督者
+    vector<uint64_t> restarts;
+    uint64_t hammerOps = 0;
+    SupervisorStats stats;
+    {
+        maxActive = 0;
+        MonitorSupervisor supervisor([&](const CancelToken& stop) {
+            enter();
+            while (!stop.WaitFor(1000)) {
+            }
+            this_thread::sleep_for(chrono::milliseconds(TEARDOWN_MS));
+            --active;
+        });
+        auto waitRuns = [&](uint64_t runs) {
+            while (supervisor.Stats().runs < runs || !supervisor.Stats().active) this_thread::yield();
+        };
+        supervisor.Start();
+        waitRuns(1);
+        for (int i = 0; i < 10; i++) {
+            this_thread::sleep_for(chrono::milliseconds(runMs(rng)));
+            uint64_t runs = supervisor.Stats().runs;
+            supervisor.Restart();
+            waitRuns(runs + 1);
+            restarts.push_back((uint64_t)supervisor.Stats().lastRestartUs);
+        }
+
+        // 多个线程随机启动、停止、重启（包括停止后立即启动）
+        vector<thread> callers;
+        atomic<uint64_t> ops{0};
+        for (int t = 0; t < 4; t++) {
+            callers.emplace_back([&supervisor, &ops, t]() {
+                mt19937 local(100 + t);
+                uniform_int_distribution<int> op(0, 2), pauseMs(0, 5);
+                for (int i = 0; i < 100; i++) {
+                    switch (op(local)) {
+                    case 0: supervisor.Start(); break;
+                    case 1: supervisor.Stop(); break;
+                    default: supervisor.Restart(); break;
+                    }
+                    ops++;
+                    this_thread::sleep_for(chrono::milliseconds(pauseMs(local)));
+                }
+            });
+        }
+        for (auto& t : callers) t.join();
+        hammerOps = ops;
+        supervisor.Shutdown();
+        stats = supervisor.Stats();
+    }
+
+    // 循环抛出异常：计入 failures 并把 what() 交给回调，之后仍能再次启动
+    SupervisorStats failed;
+    vector<string> reported;
+    {
+        mutex reportedMutex;
+        MonitorSupervisor supervisor([](const CancelToken&) {
+            throw runtime_error("radio lost");
+        }, [&](const string& what) {
+            lock_guard<mutex> lock(reportedMutex);
+            reported.push_back(what);
+        });
+        for (uint64_t runs = 1; runs <= 2; runs++) {
+            supervisor.Start();
+            while (supervisor.Stats().failures < runs) this_thread::yield();
+        }
+        supervisor.Shutdown();
+        failed = supervisor.Stats();
+    }
+    bool failuresOk = failed.runs == 2 && failed.failures == 2 && failed.lastFailure == "radio lost" &&
+        reported.size() == 2 && reported[1] == "radio lost";
+
+    printf("[supervisor] 原实现：重启耗时 p50 %.1f ms、最大 %.1f ms；停止后立即启动时同时运行的循环 %d 个\n",
+        Percentile(legacyRestarts, 50) / 1000.0, Percentile(legacyRestarts, 100) / 1000.0, legacyOverlap);
+    printf("[supervisor] 监督者：重启耗时 p50 %.1f ms、最大 %.1f ms（收尾 %d ms）；另 4 线程随机启停/重启 %llu 次，"
+        "共运行 %llu 个循环，同时运行的循环最多 %d 个\n",
+        Percentile(restarts, 50) / 1000.0, Percentile(restarts, 100) / 1000.0, TEARDOWN_MS,
+        (unsigned long long)hammerOps, (unsigned long long)stats.runs, maxActive.load());
+    printf("[supervisor] 抛出异常的循环：运行 %llu 次，failures %llu，回调 %zu 次（\"%s\"）%s\n",
+        (unsigned long long)failed.runs, (unsigned long long)failed.failures, reported.size(),
+        failed.lastFailure.c_str(), failuresOk ? "" : "，未如实记录");
+    return maxActive <= 1 && failuresOk;
+}
+
+static bool BenchMetrics() {
+    // 精度：对数正态分布的延迟样本，直方图百分位与精确百分位比较
+    const int SAMPLES = 200000;
+    mt19937 rng(7);
+    lognormal_distribution<double> latency(11.0, 1.0);     // 中位数约 60 ms（微秒）
+    vector<uint64_t> exact;
+    exact.reserve(SAMPLES);
+    LatencyHistogram accuracy;
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t us = (uint64_t)latency(rng);
+        exact.push_back(us);
+        accuracy.Record(us);
+    }
+    HistogramSnapshot snapshot = accuracy.Snapshot();
+    bool ok = true;
+    for (double p : { 50.0, 90.0, 99.0, 99.9 }) {
+        uint64_t truth = Percentile(exact, p);
+        uint64_t approx = snapshot.PercentileUs(p);
+        printf("[metrics] p%.1f 精确 %llu us，直方图 %llu us，误差 %+.2f%%\n", p,
+            (unsigned long long)truth, (unsigned long long)approx, (double)approx / truth * 100.0 - 100.0);
+        ok = ok && approx * 100 >= truth * 97 && approx * 100 <= truth * 103;     // 约 3% 相对误差
+    }
+
+    // 开销：多线程并发记录
+    const int PER_THREAD = 2000000;
+    for (int threads : { 1, 4 }) {
+        LatencyHistogram histogram;
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&histogram, t]() {
+                uint64_t x = 0x9E3779B97F4A7C15ull * (t + 1);
+                for (int i = 0; i < PER_THREAD; i++) {
+                    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                    histogram.Record(x & 0xFFFFFF);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        double ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        uint64_t recorded = histogram.Snapshot().count;
+        printf("[metrics] %d 线程记录 %llu 次，平均 %.1f ns/次（每线程）\n", threads,
+            (unsigned long long)recorded, ns / PER_THREAD);
+        ok = ok && recorded == (uint64_t)threads * PER_THREAD;
+    }
+    return ok;
+}
+
+// 设备列表刷新：整表重建（删除全部行、逐行格式化地址与状态再插入） vs 按地址差量只输出变化的行。
+// 每次刷新约 1% 设备状态变化、0.2% 设备消失或新出现；同时把差量操作依次作用在一份镜像列表上，校验结果与表一致
+static bool BenchDeviceDiff() {
+    const int TICKS = 200;
+    bool ok = true;
+    for (int devices : { 100, 1000, 10000 }) {
+        mt19937 rng(devices);
+        vector<DeviceRow> snapshot(devices);
+        BtAddr nextAddress = 0x001122000000ull;
+        for (int i = 0; i < devices; i++) {
+            snapshot[i].address = nextAddress++;
+            snapshot[i].name = L"蓝牙设备 " + to_wstring(i);
+            snapshot[i].connected = i % 3 == 0;
+            snapshot[i].monitored = i % 5 == 0;
+        }
+
+        DeviceTable table;
+        vector<DeviceDiffEntry> ops;
+        table.Apply(snapshot, ops);
+        vector<DeviceRow> mirror(snapshot);
+        ops.clear();
+
+        uniform_int_distribution<int> pick(0, devices - 1);
+        int changesPerTick = max(1, devices / 100);
+        int churnPerTick = max(1, devices / 500);
+        vector<wstring> rebuilt;
+        uint64_t rebuildNs = 0, diffNs = 0, opCount = 0;
+        bool consistent = true;
+        for (int tick = 0; tick < TICKS; tick++) {
+            for (int i = 0; i < changesPerTick; i++) {
+                DeviceRow& row = snapshot[pick(rng) % snapshot.size()];
+                row.connected = !row.connected;
+            }
+            for (int i = 0; i < churnPerTick; i++) {
+                snapshot.erase(snapshot.begin() + pick(rng) % snapshot.size());
+                DeviceRow added;
+                added.address = nextAddress++;
+                added.name = L"新设备 " + to_wstring(added.address & 0xFFFF);
+                snapshot.push_back(added);
+            }
+
+            // 原做法：每行重新格式化名称、地址、状态、监控四列
+            auto start = chrono::steady_clock::now();
+            rebuilt.clear();
+            for (const auto& row : snapshot) {
+                rebuilt.push_back(row.name);
+                rebuilt.push_back(BtAddrToString(row.address));
+                rebuilt.push_back(row.connected ? L"已连接" : L"未连接");
+                rebuilt.push_back(row.monitored ? L"是" : L"否");
+            }
+            rebuildNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+            start = chrono::steady_clock::now();
+            table.Apply(snapshot, ops);
+            diffNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+            opCount += ops.size();
+
+            for (const auto& op : ops) {
+                switch (op.op) {
+                case DeviceDiffOp::Remove: mirror.erase(mirror.begin() + op.index); break;
+                case DeviceDiffOp::Update: mirror[op.index] = table.Row(op.index); break;
+                case DeviceDiffOp::Insert: mirror.insert(mirror.begin() + op.index, table.Row(op.index)); break;
+                }
+            }
+            ops.clear();
+            if (mirror.size() != table.Count() || mirror.size() != snapshot.size()) consistent = false;
+            for (size_t i = 0; consistent && i < mirror.size(); i++) {
+                const DeviceRow& row = table.Row(i);
+                consistent = mirror[i].address == row.address && mirror[i].name == row.name &&
+                    mirror[i].connected == row.connected && table.IndexOf(row.address) == (int)i;
+            }
+        }
+
+        printf("[device-diff] %5d 台：整表重建 %.1f us/次（%d 行 × 4 列），差量 %.1f us/次（平均 %.1f 个操作），镜像一致：%s\n",
+            devices, rebuildNs / 1000.0 / TICKS, devices, diffNs / 1000.0 / TICKS, (double)opCount / TICKS,
+            consistent ? "是" : "否");
+        ok = ok && consistent;
+    }
+    return ok;
+}
+
+// 快照发布压力测试：读取线程不停读取设备列表快照并校验一致性（版本单调、已连接计数与各行相符），
+// 写入线程并发修改后发布；与整体加互斥锁的做法比较读取吞吐。用 -DBT_BENCH_TSAN=ON 构建可在 ThreadSanitizer 下运行
+struct BenchDeviceState {
+    vector<DeviceRow> rows;
+    size_t connected = 0;
+};
+
+static bool CheckDeviceState(const BenchDeviceState& state) {
+    size_t connected = 0;
+    for (const auto& row : state.rows) connected += row.connected ? 1 : 0;
+    return connected == state.connected;
+}
+
+static bool RunSnapshotStress(bool useSnapshot, int readers, int writers, int durationMs) {
+    const int ROWS = 256;
+    BenchDeviceState initial;
+    initial.rows.resize(ROWS);
+    for (int i = 0; i < ROWS; i++) {
+        initial.rows[i].address = 0x001122000000ull + i;
+        initial.rows[i].name = L"蓝牙设备 " + to_wstring(i);
+    }
+    SnapshotCell<BenchDeviceState> cell(initial);
+    BenchDeviceState locked = initial;
+    mutex lockedMutex;
+
+    atomic<bool> stop{ false };
+    atomic<uint64_t> reads{ 0 }, writes{ 0 }, violations{ 0 };
+    vector<thread> threads;
+    for (int t = 0; t < readers; t++) {
+        threads.emplace_back([&]() {
+            uint64_t count = 0, lastVersion = 0;
+            while (!stop) {
+                if (useSnapshot) {
+                    auto snapshot = cell.Load();
+                    if (snapshot->version < lastVersion || !CheckDeviceState(snapshot->value)) violations++;
+                    lastVersion = snapshot->version;
+                } else {
+                    lock_guard<mutex> lock(lockedMutex);
+                    if (!CheckDeviceState(locked)) violations++;
+                }
+                count++;
+            }
+            reads += count;
+        });
+    }
+    for (int t = 0; t < writers; t++) {
+        threads.emplace_back([&, t]() {
+            mt19937 rng(t + 1);
+            uint64_t count = 0;
+            auto flip = [&rng](BenchDeviceState& state) {
+                DeviceRow& row = state.rows[rng() % state.rows.size()];
+                row.connected = !row.connected;
+                state.connected += row.connected ? 1 : (size_t)-1;
+            };
+            while (!stop) {
+                // 一次刷新合并多处修改，只发布一次
+                if (useSnapshot) {
+                    cell.Update([&](BenchDeviceState& state) {
+                        for (int i = 0; i < 4; i++) flip(state);
+                    });
+                } else {
+                    lock_guard<mutex> lock(lockedMutex);
+                    for (int i = 0; i < 4; i++) flip(locked);
+                }
+                count++;
+                this_thread::sleep_for(chrono::microseconds(100));
+            }
+            writes += count;
+        });
+    }
+    this_thread::sleep_for(chrono::milliseconds(durationMs));
+    stop = true;
+    for (auto& t : threads) t.join();
+
+    printf("[snapshot] %s，%d 读 %d 写：读取 %.2f M 次/秒，发布 %llu 次，最终版本 %llu，不一致 %llu\n",
+        useSnapshot ? "快照发布" : "互斥锁", readers, writers, reads / (durationMs / 1000.0) / 1e6,
+        (unsigned long long)writes, useSnapshot ? (unsigned long long)cell.Load()->version : 0ull,
+        (unsigned long long)violations);
+    return violations == 0;
+}
+
+// 无写入：只比较读取路径（互斥锁下读取方互相排队，快照读取并行）；
+// 2 个写入方每 100 us 发布一次：远高于 GUI 的发布频率（每次刷新最多一次），快照每次发布复制整张列表，
+// 读取方遍历的是刚复制、不在缓存中的新快照，这部分开销与读取路径无关
+static bool BenchSnapshot() {
+    // 读取路径本身（单线程、无写入、不遍历内容）：互斥量加解锁 vs Load vs std::atomic_load(shared_ptr)（自旋锁池）
+    {
+        const int OPS = 2000000;
+        SnapshotCell<BenchDeviceState> cell;
+        shared_ptr<const Snapshot<BenchDeviceState>> legacy = cell.Load();
+        mutex m;
+        volatile uint64_t sink = 0;     // 防止读取被优化掉
+        auto timeNs = [OPS](const function<void()>& op) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < OPS; i++) op();
+            return (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / OPS;
+        };
+        double mutexNs = timeNs([&]() {
+            lock_guard<mutex> lock(m);
+            sink = sink + 1;
+        });
+        double loadNs = timeNs([&]() { sink = cell.Load()->version; });
+        double atomicLoadNs = timeNs([&]() { sink = atomic_load(&legacy)->version; });
+        printf("[snapshot] 读取路径（单线程）：互斥锁加解锁 %.1f ns，Load %.1f ns，std::atomic_load(shared_ptr) %.1f ns\n",
+            mutexNs, loadNs, atomicLoadNs);
+    }
+
+    bool ok = true;
+    for (int writers : { 0, 2 }) {
+        for (int readers : { 1, 4 }) {
+            ok = RunSnapshotStress(false, readers, writers, 500) && ok;
+            ok = RunSnapshotStress(true, readers, writers, 500) && ok;
+        }
+    }
+    return ok;
+}
+
+// 界面操作：每次点击新开线程 vs 固定工作线程 + 刷新合并/共享扫描。
+// 模拟 3 台设备各点一次连接（连接 150 ms 后刷新）并连点 8 次刷新；扫描一次 300 ms（缩短 10 倍），统计扫描次数与同时进行的扫描数
+// （模拟扫描只是等待，并发扫描不会像在真实无线电上那样互相拖慢，完成时间仅供参考）
+static bool RunUiActions(bool useExecutor) {
+    atomic<int> inquiries{ 0 }, concurrent{ 0 }, maxConcurrent{ 0 };
+    auto inquiry = [&]() {
+        inquiries++;
+        int now = ++concurrent;
+        int seen = maxConcurrent.load();
+        while (now > seen && !maxConcurrent.compare_exchange_weak(seen, now)) {
+        }
+        this_thread::sleep_for(chrono::milliseconds(300));
+        concurrent--;
+        return vector<int>(16);
+    };
+
+    SingleFlight<vector<int>> flight;
+    auto refresh = [&]() {
+        if (useExecutor) flight.Do(inquiry);
+        else inquiry();
+    };
+    auto connect = [&]() {
+        this_thread::sleep_for(chrono::milliseconds(150));
+        refresh();
+    };
+
+    auto start = chrono::steady_clock::now();
+    ActionExecutorStats stats;
+    if (useExecutor) {
+        ActionExecutor actions(2, 16);
+        for (int i = 0; i < 3; i++) actions.Post(connect);
+        for (int i = 0; i < 8; i++) {
+            actions.Post(refresh, "refresh");
+            this_thread::sleep_for(chrono::milliseconds(40));
+        }
+        while (actions.Stats().executed + actions.Stats().coalesced < 11) this_thread::sleep_for(chrono::milliseconds(5));
+        stats = actions.Stats();
+    } else {
+        vector<thread> threads;
+        for (int i = 0; i < 3; i++) threads.emplace_back(connect);
+        for (int i = 0; i < 8; i++) {
+            threads.emplace_back(refresh);
+            this_thread::sleep_for(chrono::milliseconds(40));
+        }
+        for (auto& t : threads) t.join();
+    }
+    auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+
+    printf("[ui-actions] %s：扫描 %d 次，同时扫描最多 %d 个，全部完成 %lld ms",
+        useExecutor ? "执行器 + 合并" : "每次新开线程", inquiries.load(), maxConcurrent.load(), (long long)ms);
+    if (useExecutor) {
+        printf("；排队峰值 %zu，队列合并 %llu，共享扫描结果 %llu", stats.maxDepth,
+            (unsigned long long)stats.coalesced, (unsigned long long)flight.Coalesced());
+    }
+    printf("\n");
+    return !useExecutor || maxConcurrent <= 1;     // 执行器合并后不应同时扫描
+}
+
+static bool BenchUiActions() {
+    bool ok = RunUiActions(false);
+    ok = RunUiActions(true) && ok;
+
+    // 扫描抛出异常：等待中的调用收到同一异常，之后的调用照常执行（不会一直等已经结束的那次）
+    SingleFlight<int> flight;
+    atomic<bool> started{ false };
+    thread owner([&flight, &started]() {
+        try {
+            flight.Do([&flight, &started]() -> int {
+                started = true;
+                while (flight.Coalesced() == 0) this_thread::sleep_for(chrono::milliseconds(1));   // 等另一个调用开始等待
+                throw runtime_error("inquiry failed");
+            });
+        } catch (const runtime_error&) {
+        }
+    });
+    while (!started) this_thread::sleep_for(chrono::milliseconds(1));
+    bool waiterThrew = false;
+    try {
+        flight.Do([]() { return 1; });
+    } catch (const runtime_error&) {
+        waiterThrew = true;
+    }
+    owner.join();
+    int after = flight.Do([]() { return 2; });
+    printf("[ui-actions] 扫描抛出异常：等待方收到异常=%s，之后的调用结果=%d\n", waiterThrew ? "是" : "否", after);
+    return ok && waiterThrew && after == 2;
+}
+
+// 日志写入：加锁同步写日志框（UI 忙时写入方一起等待） vs 无锁环形缓冲区 + UI 定时批量取出。
+// UI 线程每 100 ms 处理一次，其中 busyMs 毫秒在忙别的事（窗口最小化、重绘等）；
+// 每个写入线程写 perThread 条，两条之间停 pauseUs 微秒（0 表示突发写入）
+static bool RunLogWriters(bool useRing, int producers, int busyMs, int perThread, int pauseUs) {
+    const wstring line = L"[重连] 已连接: 蓝牙耳机 [00:11:22:33:44:55]，连接耗时 1234 ms";
+    LogRing ring;
+    mutex logMutex;
+    wstring logText;
+    atomic<bool> done{ false };
+    atomic<uint64_t> drained{ 0 };
+
+    thread ui([&]() {
+        while (!done) {
+            if (useRing) {
+                this_thread::sleep_for(chrono::milliseconds(busyMs));
+                drained += ring.Drain([&](const wchar_t* text, size_t length) {
+                    logText.append(text, length);
+                    logText += L"\r\n";
+                });
+            } else {
+                lock_guard<mutex> lock(logMutex);
+                this_thread::sleep_for(chrono::milliseconds(busyMs));
+            }
+            if (logText.size() > (1u << 20)) logText.clear();
+            this_thread::sleep_for(chrono::milliseconds(100 - busyMs));
+        }
+    });
+
+    vector<vector<uint64_t>> latencies(producers);
+    vector<thread> workers;
+    for (int t = 0; t < producers; t++) {
+        workers.emplace_back([&, t]() {
+            latencies[t].reserve(perThread);
+            for (int i = 0; i < perThread; i++) {
+                auto start = chrono::steady_clock::now();
+                if (useRing) {
+                    ring.Push(line);
+                } else {
+                    lock_guard<mutex> lock(logMutex);
+                    logText += line;
+                    logText += L"\r\n";
+                }
+                latencies[t].push_back((uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+                if (pauseUs > 0) this_thread::sleep_for(chrono::microseconds(pauseUs));
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    done = true;
+    ui.join();
+
+    vector<uint64_t> all;
+    for (const auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    LogRingStats stats = ring.Stats();
+    printf("[log-ring] %s，%d 线程%s，UI 每 100 ms 忙 %2d ms：写入 p50 %.2f us、p99 %.2f us、最大 %.1f ms",
+        useRing ? "环形缓冲区" : "加锁同步写", producers, pauseUs > 0 ? "" : "突发", busyMs,
+        Percentile(all, 50) / 1000.0, Percentile(all, 99) / 1000.0, Percentile(all, 100) / 1e6);
+    if (useRing) {
+        printf("；写入 %llu、丢弃 %llu、截断 %llu", (unsigned long long)stats.pushed,
+            (unsigned long long)stats.dropped, (unsigned long long)stats.truncated);
+    }
+    printf("\n");
+    // 每条记录要么写入、要么计入丢弃
+    return !useRing || stats.pushed + stats.dropped == (uint64_t)producers * perThread;
+}
+
+static bool BenchLogRing() {
+    bool ok = true;
+    for (int busyMs : { 0, 80 }) {
+        ok = RunLogWriters(false, 4, busyMs, 4000, 50) && ok;
+        ok = RunLogWriters(true, 4, busyMs, 4000, 50) && ok;
+    }
+    // 突发：4 个线程各连续写 4000 条，超过缓冲区容量的部分丢弃并计数
+    ok = RunLogWriters(false, 4, 80, 4000, 0) && ok;
+    return RunLogWriters(true, 4, 80, 4000, 0) && ok;
+}
+
+// 日志框存储：一直追加的整块文本（原日志编辑框） vs 定长 LogStore，记录内存与每行追加开销随运行时间的变化
+static bool BenchLogStore() {
+    const int DAYS = 7;
+    const int LINES_PER_DAY = 200000;       // 约每秒 2 行
+    mt19937 rng(11);
+    uniform_int_distribution<int> extra(0, 60);
+    vector<wstring> lines;
+    for (int i = 0; i < 1024; i++) {
+        lines.push_back(L"[重连] 已连接: 蓝牙耳机 [00:11:22:33:44:55]，连接耗时 " + to_wstring(800 + i) + L" ms" + wstring(extra(rng), L'.'));
+    }
+
+    wstring editText;
+    LogStore store;
+    uint64_t spilledChars = 0;
+    auto spill = [&spilledChars](const wchar_t*, size_t length) { spilledChars += length + 1; };
+    size_t next = 0;
+    for (int day = 1; day <= DAYS; day++) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < LINES_PER_DAY; i++) {
+            const wstring& line = lines[next++ % lines.size()];
+            editText += line;
+            editText += L"\r\n";
+        }
+        double editNs = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / LINES_PER_DAY;
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < LINES_PER_DAY; i++) {
+            const wstring& line = lines[(next - LINES_PER_DAY + i) % lines.size()];
+            store.Append(line.data(), line.size(), spill);
+        }
+        double storeNs = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / LINES_PER_DAY;
+
+        size_t storeBytes = store.Capacity() * 8 + store.ArenaChars() * sizeof(wchar_t);
+        printf("[log-store] 第 %d 天：整块文本 %6.1f MB（%.1f ns/行）；LogStore %.1f MB（%.1f ns/行），显示 %zu 行，写入磁盘 %llu 行\n",
+            day, editText.capacity() * sizeof(wchar_t) / 1048576.0, editNs, storeBytes / 1048576.0, storeNs,
+            store.Count(), (unsigned long long)store.Stats().spilled);
+    }
+
+    // 一致性：显示的行与写入磁盘的行加起来等于写入的行，且最后一行内容完整
+    size_t length = 0;
+    const wchar_t* last = store.Line(store.Count() - 1, &length);
+    const wstring& expected = lines[(next - 1) % lines.size()];
+    bool ok = store.Count() + store.Stats().spilled == store.Stats().appended &&
+        wstring(last, length) == expected;
+    printf("[log-store] 行数守恒、最后一行一致：%s\n", ok ? "是" : "否");
+    return ok;
+}
+
+// 基准用的监控回调：日志只计数（保留拼接日志字符串的开销）
+class CountingMonitorHost : public IMonitorHost {
+public:
+    void Log(const wstring& line) override {
+        lines++;
+        chars += line.size();
+    }
+
+    uint64_t lines = 0;
+    uint64_t chars = 0;
+};
+
+// 在虚拟时钟上用模拟设备群运行真实的监控核心，统计每次 Step 的 CPU 开销与断开→重连耗时。
+// asyncInquiry 为 false 时主动扫描在 Step 中同步进行（扫描期间虚拟时间前进、其他处理等待）
+static bool RunFleet(int devices, bool eventDriven, int64_t durationMs, bool asyncInquiry = true) {
+    const int RECONNECT_WORKERS = 4;
+    const int RECONNECT_PER_RADIO = 2;
+    VirtualClock clock(0);
+    SimFleetOptions options;
+    options.devices = devices;
+    options.emitEvents = eventDriven;
+    SimulatedFleet fleet(clock, options);
+    Metrics metrics;
+    fleet.SetMetrics(&metrics);
+
+    DeviceRegistry registry(devices);
+    vector<PairedDevice> paired;
+    fleet.EnumeratePaired(false, paired);
+    for (const auto& device : paired) {
+        DeviceRecord& record = registry.Upsert(device.address);
+        record.name = device.name;
+        record.connected = device.connected;
+        record.monitored = true;
+    }
+
+    SimReconnectExecutor executor(clock, RECONNECT_WORKERS, RECONNECT_PER_RADIO,
+        [&fleet](BtAddr address) { return fleet.ConnectDurationMs(address); });
+    SimInquiryStage inquiry(clock, fleet);
+    CountingMonitorHost host;
+    MonitorCore core(clock, registry, fleet, executor, host);
+    core.SetMetrics(&metrics);
+    if (asyncInquiry) core.SetInquiryStage(&inquiry);
+    core.Start(eventDriven);
+
+    vector<PresenceEvent> events;
+    vector<uint64_t> stepNs;
+    auto wallStart = chrono::steady_clock::now();
+    int64_t end = clock.NowMs() + durationMs;
+    while (clock.NowMs() < end) {
+        // 时间直接跳到下一件事：调度工作到期、重连完成或设备状态变化
+        int64_t now = clock.NowMs();
+        int64_t next = end;
+        int64_t due = core.MsUntilNext();
+        if (due >= 0) next = min(next, now + due);
+        int64_t done = executor.NextCompletionMs();
+        if (done >= 0) next = min(next, done);
+        int64_t change = fleet.NextChangeMs();
+        if (change >= 0) next = min(next, change);
+        int64_t scanned = inquiry.NextCompletionMs();
+        if (scanned >= 0) next = min(next, scanned);
+        if (next > now) clock.Set(next);
+
+        fleet.Advance(events);
+        executor.Advance();
+        auto stepStart = chrono::steady_clock::now();
+        core.Step(events, eventDriven);
+        stepNs.push_back((uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - stepStart).count());
+    }
+    double wallMs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - wallStart).count() / 1000.0;
+
+    const MonitorCoreStats& stats = core.Stats();
+    printf("[fleet] %5d 台（%s%s）：Step %llu 次，墙钟 %.0f ms（%.0f 次/秒），单次 p50 %.1f us、p99 %.1f us、最大 %.1f us\n",
+        devices, eventDriven ? "事件" : "轮询", asyncInquiry ? "" : "，同步扫描", (unsigned long long)stats.steps, wallMs, stats.steps / (wallMs / 1000.0),
+        Percentile(stepNs, 50) / 1000.0, Percentile(stepNs, 99) / 1000.0, Percentile(stepNs, 100) / 1000.0);
+
+    HistogramSnapshot reconnect = metrics.reconnect.Snapshot();
+    HistogramSnapshot tick = metrics.tick.Snapshot();
+    HistogramSnapshot eventDelay = fleet.EventDelay();
+    printf("[fleet]        单次处理（虚拟时间）p50 %.0f ms、p99 %.0f ms、最大 %.0f ms；事件等待处理 p99 %.0f ms、最大 %.0f ms\n",
+        tick.PercentileUs(50) / 1000.0, tick.PercentileUs(99) / 1000.0, tick.maxUs / 1000.0,
+        eventDelay.PercentileUs(99) / 1000.0, eventDelay.maxUs / 1000.0);
+    printf("[fleet]        设备离开 %llu、链路断开 %llu、回到范围 %llu；轮询 %llu（扫描 %llu）；重连提交 %llu、成功 %llu、失败 %llu\n",
+        (unsigned long long)fleet.Departures(), (unsigned long long)fleet.LinkDrops(), (unsigned long long)fleet.Arrivals(),
+        (unsigned long long)stats.polls, (unsigned long long)stats.inquiries,
+        (unsigned long long)stats.reconnectsSubmitted, (unsigned long long)stats.reconnectsSucceeded,
+        (unsigned long long)stats.reconnectsFailed);
+
+    map<uint32_t, uint64_t> errors;
+    for (const auto& entry : metrics.Outcomes()) {
+        for (const auto& failure : entry.second.failures) errors[failure.first] += failure.second;
+    }
+    printf("[fleet]        断开→重连 %llu 次：p50 %.1f s、p90 %.1f s、p99 %.1f s；失败错误码:",
+        (unsigned long long)reconnect.count, reconnect.PercentileUs(50) / 1e6, reconnect.PercentileUs(90) / 1e6,
+        reconnect.PercentileUs(99) / 1e6);
+    for (const auto& error : errors) printf(" %u×%llu", error.first, (unsigned long long)error.second);
+    printf("；结束时在线 %zu/%zu\n", fleet.ConnectedCount(), fleet.PresentCount());
+
+    // 容量上限：同时进行的连接最多 slots 个，在范围内的一次连接平均占用一个连接槽 meanConnectMs，
+    // 按失败率折算后每小时最多成功 capacity 次。需要的重连（回到范围 + 链路断开）不超过容量一半时
+    // 应跟得上：结束时在线不少于在范围内的 90%，断开→重连 p50 不超过平均离开时长加探测退避上限；
+    // 超出容量时在线比例由容量决定，只要求连接槽没有被离线设备的探测占满（成功数不少于容量的 35%）
+    int slots = min(RECONNECT_WORKERS, options.radios * RECONNECT_PER_RADIO);
+    double meanConnectMs = (options.connectMinMs + options.connectMaxMs) / 2.0;
+    double hours = durationMs / 3600000.0;
+    double capacity = slots * 3600000.0 / meanConnectMs * (1.0 - options.failureRate) * hours;
+    uint64_t demand = fleet.Arrivals() + fleet.LinkDrops();
+    bool withinCapacity = demand <= capacity / 2;
+    double online = fleet.PresentCount() ? (double)fleet.ConnectedCount() / fleet.PresentCount() : 1.0;
+    int64_t p50Limit = options.meanAbsentMs + SchedulerOptions().maxProbeMs;
+    bool served = withinCapacity ? online >= 0.9 && reconnect.PercentileUs(50) <= (uint64_t)p50Limit * 1000
+                                 : stats.reconnectsSucceeded >= capacity * 0.35;
+    printf("[fleet]        需要重连 %llu 次，容量上限约 %.0f 次（%d 个连接槽）：%s；结束时在线 %.0f%%、重连成功 %.0f%% 容量%s\n",
+        (unsigned long long)demand, capacity, slots, withinCapacity ? "不超过容量一半" : "超过容量一半", online * 100,
+        stats.reconnectsSucceeded * 100.0 / capacity, served ? "" : "，未达标");
+    // 完成的重连不多于提交的，已连接的设备都在范围内，并满足上面的容量要求
+    return stats.reconnectsSucceeded + stats.reconnectsFailed <= stats.reconnectsSubmitted &&
+        fleet.ConnectedCount() <= fleet.PresentCount() && served;
+}
+
+// 订阅者：按收到的变化维护一份设备镜像，用于校验变化流没有遗漏
+class MirrorFeedSubscriber : public IDeviceFeedSubscriber {
+public:
+    void OnDeviceChanges(const vector<DeviceChange>& changes, const DeviceFeed& feed) override {
+        (void)feed;
+        batches++;
+        for (const auto& change : changes) {
+            if (change.type == DeviceChangeType::Vanished) {
+                devices.erase(change.address);
+                continue;
+            }
+            PairedDevice& device = devices[change.address];
+            device.address = change.address;
+            device.name = *change.name;
+            device.connected = change.connected;
+            device.radio = change.radio;
+        }
+    }
+
+    bool Matches(const vector<PairedDevice>& snapshot) const {
+        if (devices.size() != snapshot.size()) return false;
+        for (const auto& device : snapshot) {
+            auto it = devices.find(device.address);
+            if (it == devices.end() || it->second.name != device.name || it->second.connected != device.connected ||
+                it->second.radio != device.radio) return false;
+        }
+        return true;
+    }
+
+    unordered_map<BtAddr, PairedDevice> devices;
+    uint64_t batches = 0;
+};
+
+// 设备变化流：空闲（没有变化）时每次枚举的分配次数与 CPU 耗时。
+// 原做法为每次枚举后各使用方自行处理整张列表：复制设备名称生成列表行（GUI 设备列表）、
+// 收集全部地址建集合（服务缓存保留）、再按地址比较（DeviceTable）；变化流只比较一次、没有变化时不通知。
+// 随后加入随机变化，校验订阅者按变化维护的镜像与快照一致；最后在虚拟时钟上运行空闲的监控核心
+static bool BenchDeviceFeed() {
+    const int TICKS = 200;
+    bool ok = true;
+    for (int devices : { 100, 1000, 10000 }) {
+        vector<PairedDevice> snapshot(devices);
+        for (int i = 0; i < devices; i++) {
+            snapshot[i].address = 0x001122000000ull + i;
+            snapshot[i].name = L"蓝牙设备 " + to_wstring(i);
+            snapshot[i].connected = i % 3 == 0;
+            snapshot[i].radio = i % 2;
+        }
+
+        DeviceTable table;
+        vector<DeviceRow> rows;
+        vector<DeviceDiffEntry> ops;
+        DeviceFeed feed;
+        MirrorFeedSubscriber mirror;
+        feed.Subscribe(&mirror);
+        feed.Apply(snapshot);
+
+        uint64_t oldNs = 0, oldAllocs = 0, feedNs = 0, feedAllocs = 0, notified = 0;
+        for (int tick = 0; tick < TICKS; tick++) {
+            uint64_t allocsBefore = g_allocations.load(memory_order_relaxed);
+            auto start = chrono::steady_clock::now();
+            vector<PairedDevice> copy(snapshot);
+            vector<BtAddr> addresses;
+            for (const auto& device : copy) addresses.push_back(device.address);
+            unordered_set<BtAddr> keep(addresses.begin(), addresses.end());
+            rows.clear();
+            for (const auto& device : copy) {
+                DeviceRow row;
+                row.address = device.address;
+                row.name = device.name;
+                row.connected = device.connected;
+                row.radio = device.radio;
+                rows.push_back(row);
+            }
+            table.Apply(rows, ops);
+            ops.clear();
+            oldNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+            oldAllocs += g_allocations.load(memory_order_relaxed) - allocsBefore;
+
+            allocsBefore = g_allocations.load(memory_order_relaxed);
+            start = chrono::steady_clock::now();
+            notified += feed.Apply(snapshot);
+            feedNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+            feedAllocs += g_allocations.load(memory_order_relaxed) - allocsBefore;
+        }
+
+        // 随机变化：连接/断开、改名、换适配器、取消配对与新配对
+        mt19937 rng(devices);
+        uniform_int_distribution<int> pick(0, devices - 1);
+        BtAddr nextAddress = 0x001133000000ull;
+        bool consistent = mirror.Matches(snapshot);
+        uint64_t changes = 0;
+        for (int tick = 0; tick < TICKS && consistent; tick++) {
+            for (int i = 0; i < max(1, devices / 100); i++) {
+                PairedDevice& device = snapshot[pick(rng) % snapshot.size()];
+                switch (pick(rng) % 4) {
+                case 0: device.name += L"'"; break;
+                case 1: device.radio ^= 1; break;
+                default: device.connected = !device.connected; break;
+                }
+            }
+            snapshot.erase(snapshot.begin() + pick(rng) % snapshot.size());
+            PairedDevice added;
+            added.address = nextAddress++;
+            added.name = L"新设备";
+            snapshot.push_back(added);
+            changes += feed.Apply(snapshot);
+            consistent = mirror.Matches(snapshot) && feed.Devices().Size() == snapshot.size();
+        }
+
+        printf("[device-feed] %5d 台空闲：整表处理 %.1f us/次、%.0f 次分配/次；变化流 %.2f us/次、%.0f 次分配/次（变化 %llu 个）；"
+            "随机变化 %llu 个，镜像一致：%s\n",
+            devices, oldNs / 1000.0 / TICKS, (double)oldAllocs / TICKS, feedNs / 1000.0 / TICKS, (double)feedAllocs / TICKS,
+            (unsigned long long)notified, (unsigned long long)changes, consistent ? "是" : "否");
+        ok = ok && consistent && feedAllocs == 0 && notified == 0;
+    }
+
+    // 空闲的设备群（全部在线、不离开）：监控核心每次 Step 的分配次数与耗时，跳过第一分钟（各缓冲区首次扩容）
+    for (int devices : { 1000, 10000 }) {
+        VirtualClock clock(0);
+        SimFleetOptions options;
+        options.devices = devices;
+        options.emitEvents = false;
+        options.meanPresentMs = 1000LL * 3600000;
+        options.meanAbsentMs = 1;
+        SimulatedFleet fleet(clock, options);
+
+        DeviceRegistry registry(devices);
+        vector<PairedDevice> paired;
+        fleet.Snapshot(paired);
+        for (const auto& device : paired) {
+            DeviceRecord& record = registry.Upsert(device.address);
+            record.name = device.name;
+            record.connected = device.connected;
+            record.monitored = true;
+        }
+
+        SimReconnectExecutor executor(clock, 4, 2, [&fleet](BtAddr address) { return fleet.ConnectDurationMs(address); });
+        SimInquiryStage inquiry(clock, fleet);
+        CountingMonitorHost host;
+        MonitorCore core(clock, registry, fleet, executor, host);
+        core.SetInquiryStage(&inquiry);
+        core.Start(false);
+
+        vector<PresenceEvent> events;
+        vector<uint64_t> stepNs;
+        uint64_t allocs = 0;
+        int64_t end = 30 * 60000;
+        while (clock.NowMs() < end) {
+            int64_t now = clock.NowMs();
+            int64_t next = end;
+            int64_t due = core.MsUntilNext();
+            if (due >= 0) next = min(next, now + due);
+            int64_t scanned = inquiry.NextCompletionMs();
+            if (scanned >= 0) next = min(next, scanned);
+            if (next > now) clock.Set(next);
+
+            uint64_t allocsBefore = g_allocations.load(memory_order_relaxed);
+            auto stepStart = chrono::steady_clock::now();
+            core.Step(events, false);
+            uint64_t ns = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - stepStart).count();
+            if (clock.NowMs() < 60000) continue;
+            allocs += g_allocations.load(memory_order_relaxed) - allocsBefore;
+            stepNs.push_back(ns);
+        }
+        const DeviceFeedStats& feedStats = core.Feed().Stats();
+        printf("[device-feed] 监控核心 %5d 台空闲 30 分钟：Step %zu 次，共 %llu 次分配，单次 p50 %.1f us、p99 %.1f us；"
+            "枚举 %llu 次，无变化 %llu 次\n",
+            devices, stepNs.size(), (unsigned long long)allocs, Percentile(stepNs, 50) / 1000.0, Percentile(stepNs, 99) / 1000.0,
+            (unsigned long long)feedStats.applies, (unsigned long long)feedStats.idle);
+        ok = ok && allocs == 0;
+    }
+    return ok;
+}
+
+// 模拟 Windows 后端的枚举路径：每个适配器各报告一遍全部设备（只有所属适配器报告已连接），
+// 原始记录经 ScanArena 合并、NameTable 驻留后写入列表，与 WinBluetoothBackend::EnumeratePaired 相同
+class ArenaFleetBackend : public IBluetoothBackend {
+public:
+    ArenaFleetBackend(SimulatedFleet& fleet, int radios) : fleet_(fleet), perRadio_(radios > 0 ? radios : 1) {}
+
+    void EnumeratePaired(bool inquiry, vector<PairedDevice>& out) override {
+        fleet_.EnumeratePaired(inquiry, raw_);
+        merged_.Reset();
+        for (size_t radio = 0; radio < perRadio_.size(); radio++) {
+            ScanArena& arena = perRadio_[radio];
+            arena.Reset();
+            for (const auto& device : raw_) {
+                arena.Add(device.address, device.name.c_str(), device.connected && device.radio == (int)radio, (int)radio);
+            }
+            merged_.Append(arena);
+        }
+        merged_.Merge();
+        merged_.CopyTo(out, names_);
+    }
+
+    bool IsConnected(BtAddr address) override { return fleet_.IsConnected(address); }
+    bool Connect(BtAddr address, int radio, const wstring& name, OperationContext& op) override {
+        return fleet_.Connect(address, radio, name, op);
+    }
+
+    NameTable& Names() { return names_; }
+
+private:
+    SimulatedFleet& fleet_;
+    vector<PairedDevice> raw_;
+    vector<ScanArena> perRadio_;
+    ScanArena merged_;
+    NameTable names_;
+};
+
+// 原枚举路径：每个适配器的结果放进新建的列表（逐台复制名称），逐台查找合并，再逐台复制到输出列表
+struct LegacyDeviceInfo {
+    BtAddr address;
+    wstring name;
+    bool connected;
+    int radio;
+};
+
+static void LegacyEnumerate(const vector<PairedDevice>& raw, int radios, vector<PairedDevice>& out) {
+    vector<vector<LegacyDeviceInfo>> found(radios);
+    for (int radio = 0; radio < radios; radio++) {
+        for (const auto& device : raw) {
+            LegacyDeviceInfo info;
+            info.address = device.address;
+            info.name = device.name.c_str();
+            info.connected = device.connected && device.radio == radio;
+            info.radio = radio;
+            found[radio].push_back(info);
+        }
+    }
+    vector<LegacyDeviceInfo> devices;
+    for (const auto& list : found) {
+        for (const auto& info : list) {
+            bool merged = false;
+            for (auto& device : devices) {
+                if (device.address != info.address) continue;
+                if (info.connected && !device.connected) device = info;
+                merged = true;
+                break;
+            }
+            if (!merged) devices.push_back(info);
+        }
+    }
+    out.clear();
+    for (const auto& device : devices) {
+        PairedDevice paired;
+        paired.address = device.address;
+        paired.name = device.name;
+        paired.connected = device.connected;
+        paired.radio = device.radio;
+        out.push_back(paired);
+    }
+}
+
+// 枚举路径的堆分配：原做法 vs 暂存区 + 名称驻留（每次枚举的分配次数与耗时，结果一致性），
+// 以及在虚拟时钟上经暂存区枚举运行监控核心：一台离线设备使主动扫描与探测照常进行，统计稳态 Step 的分配
+static bool BenchScanPath() {
+    const int TICKS = 100;
+    bool ok = true;
+    for (int radios : { 1, 2 }) {
+        for (int devices : { 100, 1000 }) {
+            VirtualClock clock(0);
+            SimFleetOptions options;
+            options.devices = devices;
+            options.radios = radios;
+            options.enumerateMs = 0;
+            SimulatedFleet fleet(clock, options);
+            ArenaFleetBackend backend(fleet, radios);
+            vector<PairedDevice> raw, legacy, arena;
+            fleet.Snapshot(raw);
+            backend.EnumeratePaired(false, arena);
+
+            uint64_t legacyNs = 0, legacyAllocs = 0, arenaNs = 0, arenaAllocs = 0;
+            bool consistent = true;
+            for (int tick = 0; tick < TICKS; tick++) {
+                uint64_t before = g_allocations.load(memory_order_relaxed);
+                auto start = chrono::steady_clock::now();
+                LegacyEnumerate(raw, radios, legacy);
+                legacyNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+                legacyAllocs += g_allocations.load(memory_order_relaxed) - before;
+
+                before = g_allocations.load(memory_order_relaxed);
+                start = chrono::steady_clock::now();
+                backend.EnumeratePaired(false, arena);
+                arenaNs += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+                arenaAllocs += g_allocations.load(memory_order_relaxed) - before;
+            }
+            // 原做法保持枚举顺序，暂存区按地址排序：按地址比较
+            unordered_map<BtAddr, const PairedDevice*> byAddress;
+            for (const auto& device : legacy) byAddress[device.address] = &device;
+            consistent = legacy.size() == arena.size();
+            for (size_t i = 0; consistent && i < arena.size(); i++) {
+                auto it = byAddress.find(arena[i].address);
+                consistent = it != byAddress.end() && it->second->name == arena[i].name &&
+                    it->second->connected == arena[i].connected && it->second->radio == arena[i].radio;
+            }
+            printf("[scan-path] %d 个适配器 × %4d 台：原做法 %.1f us/次、%.0f 次分配/次；暂存区 %.1f us/次、%.1f 次分配/次；结果一致：%s\n",
+                radios, devices, legacyNs / 1000.0 / TICKS, (double)legacyAllocs / TICKS, arenaNs / 1000.0 / TICKS,
+                (double)arenaAllocs / TICKS, consistent ? "是" : "否");
+            ok = ok && consistent;
+        }
+    }
+
+    // 监控核心：全部设备常在线，另有一台永远不出现的离线设备，轮询、主动扫描（含日志）与探测照常进行；
+    // 跳过第一分钟（各缓冲区首次扩容），分别统计没有提交重连的 Step 与提交了重连的 Step
+    for (int radios : { 1, 2 }) {
+        const int DEVICES = 1000;
+        VirtualClock clock(0);
+        SimFleetOptions options;
+        options.devices = DEVICES;
+        options.radios = radios;
+        options.emitEvents = false;
+        options.meanPresentMs = 1000LL * 3600000;
+        options.meanAbsentMs = 1;
+        SimulatedFleet fleet(clock, options);
+        ArenaFleetBackend backend(fleet, radios);
+
+        DeviceRegistry registry(DEVICES + 1);
+        vector<PairedDevice> paired;
+        fleet.Snapshot(paired);
+        for (const auto& device : paired) {
+            DeviceRecord& record = registry.Upsert(device.address);
+            record.name = device.name;
+            record.connected = device.connected;
+            record.radio = device.radio;
+            record.monitored = true;
+        }
+        DeviceRecord& stray = registry.Upsert(0x5B0000000001ull);
+        stray.name = L"Stray";
+        stray.monitored = true;
+
+        SimReconnectExecutor executor(clock, 4, 2, [&fleet](BtAddr address) { return fleet.ConnectDurationMs(address); });
+        CountingMonitorHost host;
+        MonitorCore core(clock, registry, backend, executor, host);
+        core.Start(false);
+
+        vector<PresenceEvent> events;
+        uint64_t quietSteps = 0, quietAllocs = 0, submitSteps = 0, submitAllocs = 0;
+        int64_t end = 60 * 60000;
+        while (clock.NowMs() < end) {
+            int64_t now = clock.NowMs();
+            int64_t next = end;
+            int64_t due = core.MsUntilNext();
+            if (due >= 0) next = min(next, now + due);
+            int64_t done = executor.NextCompletionMs();
+            if (done >= 0) next = min(next, done);
+            if (next > now) clock.Set(next);
+
+            executor.Advance();
+            uint64_t submitted = core.Stats().reconnectsSubmitted;
+            uint64_t before = g_allocations.load(memory_order_relaxed);
+            core.Step(events, false);
+            uint64_t allocs = g_allocations.load(memory_order_relaxed) - before;
+            if (clock.NowMs() < 60000) continue;
+            if (core.Stats().reconnectsSubmitted == submitted) {
+                quietSteps++;
+                quietAllocs += allocs;
+            } else {
+                submitSteps++;
+                submitAllocs += allocs;
+            }
+        }
+        const MonitorCoreStats& stats = core.Stats();
+        NameTableStats names = backend.Names().Stats();
+        printf("[scan-path] 监控核心 %d 个适配器 × %d 台 + 1 台离线，1 小时：轮询 %llu（扫描 %llu），日志 %llu 行；"
+            "未提交重连的 Step %llu 次共 %llu 次分配，提交重连的 Step %llu 次平均 %.1f 次分配；名称复制 %llu 次\n",
+            radios, DEVICES, (unsigned long long)stats.polls, (unsigned long long)stats.inquiries, (unsigned long long)host.lines,
+            (unsigned long long)quietSteps, (unsigned long long)quietAllocs, (unsigned long long)submitSteps,
+            submitSteps ? (double)submitAllocs / submitSteps : 0.0, (unsigned long long)names.interned);
+        ok = ok && quietAllocs == 0;
+    }
+    return ok;
+}
+
+// 主动扫描：在监控循环中同步进行 vs 独立阶段异步进行，比较单次处理耗时与事件等待
+static bool BenchInquiryPipeline() {
+    const int64_t HOUR_MS = 3600000;
+    bool ok = true;
+    for (bool eventDriven : { true, false }) {
+        ok = RunFleet(1000, eventDriven, HOUR_MS, false) && ok;
+        ok = RunFleet(1000, eventDriven, HOUR_MS, true) && ok;
+    }
+    return ok;
+}
+
+// 主动扫描预算：在虚拟时钟上运行监控核心，统计扫描次数、跳过原因与每小时扫描秒数。
+// strayOffline 额外登记一台永远不会出现的离线设备（例如关机的耳机），blocked 为它是否被用户手动断开
+static bool RunInquiryBudget(const char* label, const SimFleetOptions& options, int budgetMs, bool strayOffline, bool blocked,
+    int64_t durationMs) {
+    VirtualClock clock(0);
+    SimulatedFleet fleet(clock, options);
+
+    DeviceRegistry registry(options.devices + 1);
+    vector<PairedDevice> paired;
+    fleet.Snapshot(paired);
+    for (const auto& device : paired) {
+        DeviceRecord& record = registry.Upsert(device.address);
+        record.name = device.name;
+        record.connected = device.connected;
+        record.monitored = true;
+    }
+    if (strayOffline) {
+        DeviceRecord& record = registry.Upsert(0x5B0000000001ull);
+        record.name = L"Stray";
+        record.monitored = true;
+        record.blockAutoReconnect = blocked;
+    }
+
+    SimReconnectExecutor executor(clock, 4, 2, [&fleet](BtAddr address) { return fleet.ConnectDurationMs(address); });
+    SimInquiryStage inquiry(clock, fleet);
+    CountingMonitorHost host;
+    MonitorCore core(clock, registry, fleet, executor, host);
+    core.SetInquiryStage(&inquiry);
+    core.SetInquiryBudget(budgetMs);
+    core.Start(options.emitEvents);
+
+    vector<PresenceEvent> events;
+    int64_t end = clock.NowMs() + durationMs;
+    while (clock.NowMs() < end) {
+        int64_t now = clock.NowMs();
+        int64_t next = end;
+        int64_t due = core.MsUntilNext();
+        if (due >= 0) next = min(next, now + due);
+        int64_t done = executor.NextCompletionMs();
+        if (done >= 0) next = min(next, done);
+        int64_t change = fleet.NextChangeMs();
+        if (change >= 0) next = min(next, change);
+        int64_t scanned = inquiry.NextCompletionMs();
+        if (scanned >= 0) next = min(next, scanned);
+        if (next > now) clock.Set(next);
+
+        fleet.Advance(events);
+        executor.Advance();
+        core.Step(events, options.emitEvents);
+    }
+
+    InquiryPlannerStats s = core.Planner().Stats();
+    uint64_t dueCount = s.scans + s.skippedIdle + s.skippedBudget;
+    double hours = durationMs / 3600000.0;
+    printf("[inquiry-budget] %s，预算 %d ms/分钟：到期 %llu 次，扫描 %llu、无需扫描 %llu、超出预算 %llu；"
+        "扫描 %.1f 秒/小时（每次到期都扫描约 %.1f 秒/小时）\n",
+        label, budgetMs, (unsigned long long)dueCount, (unsigned long long)s.scans,
+        (unsigned long long)s.skippedIdle, (unsigned long long)s.skippedBudget, s.SecondsPerHour(),
+        dueCount * fleet.InquiryMs() / 1000.0 / hours);
+    // 任一分钟内的扫描时长不超过预算，一小时合计也不超过 60 倍预算
+    return s.SecondsPerHour() <= budgetMs * 60 / 1000.0;
+}
+
+static bool BenchInquiryBudget() {
+    const int64_t HOURS_MS = 8 * 3600000;
+
+    // 桌面场景：几台设备长时间在线，偶尔离开
+    SimFleetOptions desk;
+    desk.devices = 5;
+    desk.meanPresentMs = 4 * 3600000;
+    desk.meanAbsentMs = 10 * 60000;
+    bool ok = RunInquiryBudget("5 台常在线", desk, 12000, false, false, HOURS_MS);
+    ok = RunInquiryBudget("5 台常在线 + 手动断开的 1 台", desk, 12000, true, true, HOURS_MS) && ok;
+    ok = RunInquiryBudget("5 台常在线 + 关机的 1 台", desk, 12000, true, false, HOURS_MS) && ok;
+    ok = RunInquiryBudget("5 台常在线 + 关机的 1 台", desk, 3000, true, false, HOURS_MS) && ok;
+
+    // 设备群：总有设备离线，扫描占用由预算决定
+    SimFleetOptions fleet;
+    fleet.devices = 1000;
+    for (int budget : { 60000, 12000, 5000, 0 }) {
+        ok = RunInquiryBudget("1000 台设备群", fleet, budget, false, false, HOURS_MS) && ok;
+    }
+    return ok;
+}
+
+// 到达预测回放：按日常规律生成若干天的到达/离开（SimulatedFleet 的脚本设备，不产生在场事件），
+// 在虚拟时钟上运行真实的监控核心：到达由 MarkConnected 记录，扫描是否到期、疏密由 MeasureInquiryDemand
+// （冷却期、进行中的重连）与 InquiryPlanner 的预算决定，刚到达的设备经探测/扫描后的重连才被发现。
+// 比较固定扫描间隔与按预测疏密扫描的每天扫描时长与发现延迟（长期离线设备的探测退避上限为 maxProbeMs，
+// 发现延迟主要由它决定）。前 TRAIN_DAYS 天只学习、不计入统计
+struct ArrivalRoutine {
+    const char* name;
+    int arriveMin;      // 到达时刻（一天中的分钟），-1 表示 8:00~23:00 内随机
+    int stayMin;        // 停留时长
+    int jitterMin;      // 到达时刻的标准差
+};
+
+static const ArrivalRoutine ARRIVAL_ROUTINES[] = {
+    { "键盘", 9 * 60, 9 * 60, 10 },
+    { "鼠标", 8 * 60 + 50, 9 * 60, 15 },
+    { "耳机", 13 * 60 + 30, 120, 20 },
+    { "音箱", 20 * 60, 150, 30 },
+    { "手柄", -1, 90, 0 },
+};
+
+enum class ReplayPolicy { Dense, Sparse, Predicted };
+
+struct ReplayResult {
+    double scanSecondsPerDay = 0;
+    uint64_t missed = 0;
+};
+
+static ReplayResult ReplayArrivals(const char* label, ReplayPolicy policy, const vector<vector<SimVisit>>& visits,
+    int days, int trainDays) {
+    const int64_t DAY_MS = ArrivalPredictor::DAY_MS;
+    VirtualClock clock(0);
+    SimFleetOptions fleetOptions;
+    fleetOptions.devices = 0;
+    fleetOptions.emitEvents = false;    // 到达只能由探测/扫描后的重连发现
+    SimulatedFleet fleet(clock, fleetOptions);
+
+    size_t n = visits.size();
+    DeviceRegistry registry(n);
+    vector<BtAddr> addresses;
+    for (size_t i = 0; i < n; i++) {
+        BtAddr address = fleet.AddScripted(L"Replay-" + to_wstring(i), visits[i]);
+        DeviceRecord& record = registry.Upsert(address);
+        record.name = L"Replay-" + to_wstring(i);
+        record.monitored = true;
+        addresses.push_back(address);
+    }
+
+    SchedulerOptions options;
+    if (policy == ReplayPolicy::Sparse) options.inquiryMs = options.sparseInquiryMs;
+    ArrivalPredictor predictor;
+    SimReconnectExecutor executor(clock, 4, 2, [&fleet](BtAddr address) { return fleet.ConnectDurationMs(address); });
+    SimInquiryStage inquiry(clock, fleet);
+    CountingMonitorHost host;
+    MonitorCore core(clock, registry, fleet, executor, host, options);
+    core.SetInquiryStage(&inquiry);
+    if (policy == ReplayPolicy::Predicted) core.SetArrivalPredictor(&predictor, 0);
+    core.Start(false);
+
+    vector<size_t> current(n, 0);
+    vector<bool> detected(n, false);
+    vector<uint64_t> latencyMs;
+    uint64_t missed = 0;
+    uint64_t trainScans = 0;
+    int64_t end = days * DAY_MS;
+    int64_t testStart = trainDays * DAY_MS;
+    bool testing = false;
+    vector<PresenceEvent> events;
+    while (clock.NowMs() < end) {
+        int64_t now = clock.NowMs();
+        int64_t next = testing ? end : testStart;
+        int64_t due = core.MsUntilNext();
+        if (due >= 0) next = min(next, now + due);
+        int64_t done = executor.NextCompletionMs();
+        if (done >= 0) next = min(next, done);
+        int64_t change = fleet.NextChangeMs();
+        if (change >= 0) next = min(next, change);
+        int64_t scanned = inquiry.NextCompletionMs();
+        if (scanned >= 0) next = min(next, scanned);
+        if (next > now) clock.Set(next);
+        now = clock.NowMs();
+        if (!testing && now >= testStart) {
+            testing = true;
+            trainScans = core.Planner().Stats().scans;
+        }
+
+        fleet.Advance(events);
+        executor.Advance();
+        core.Step(events, false);
+
+        // 监控核心认为已连接（且确实连接）即为发现；离开前未被发现的到访记为漏检
+        for (size_t i = 0; i < n; i++) {
+            while (current[i] < visits[i].size() && visits[i][current[i]].leaveMs <= now) {
+                if (!detected[i] && visits[i][current[i]].arriveMs >= testStart) missed++;
+                detected[i] = false;
+                current[i]++;
+            }
+            if (detected[i] || current[i] >= visits[i].size() || visits[i][current[i]].arriveMs > now) continue;
+            const DeviceRecord* record = registry.Find(addresses[i]);
+            if (!record || !record->connected || !fleet.IsConnected(addresses[i])) continue;
+            detected[i] = true;
+            if (visits[i][current[i]].arriveMs >= testStart) {
+                latencyMs.push_back((uint64_t)(now - visits[i][current[i]].arriveMs));
+            }
+        }
+    }
+
+    int testDays = days - trainDays;
+    InquiryPlannerStats planned = core.Planner().Stats();
+    uint64_t testScans = planned.scans - trainScans;
+    ArrivalPredictorStats stats = predictor.Stats();
+    ReplayResult result;
+    result.scanSecondsPerDay = testScans * fleet.InquiryMs() / 1000.0 / testDays;
+    result.missed = missed;
+    printf("[arrival-replay] %s：扫描 %6.0f 秒/天（%5.0f 次/天，超出预算跳过 %llu、无需扫描 %llu）；"
+        "发现延迟 p50 %5.1f s、p90 %5.1f s、p99 %5.1f s、最大 %5.1f s；漏检 %llu",
+        label, result.scanSecondsPerDay, (double)testScans / testDays, (unsigned long long)planned.skippedBudget,
+        (unsigned long long)planned.skippedIdle, Percentile(latencyMs, 50) / 1000.0, Percentile(latencyMs, 90) / 1000.0,
+        Percentile(latencyMs, 99) / 1000.0, Percentile(latencyMs, 100) / 1000.0, (unsigned long long)missed);
+    if (policy == ReplayPolicy::Predicted) {
+        printf("；到达落在预计时段 %llu/%llu", (unsigned long long)stats.hits, (unsigned long long)stats.predicted);
+    }
+    printf("\n");
+    return result;
+}
+
+static bool BenchArrivalReplay() {
+    const int DAYS = 28;
+    const int TRAIN_DAYS = 7;
+    const int64_t DAY_MS = ArrivalPredictor::DAY_MS;
+    mt19937 rng(7);
+    normal_distribution<double> normal(0.0, 1.0);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // 每台设备每天以 85% 的概率按规律到访一次（其余日子不出现，例如周末）
+    vector<vector<SimVisit>> visits;
+    for (const auto& routine : ARRIVAL_ROUTINES) {
+        vector<SimVisit> deviceVisits;
+        for (int day = 0; day < DAYS; day++) {
+            if (unit(rng) >= 0.85) continue;
+            double arriveMin = routine.arriveMin >= 0 ? routine.arriveMin + normal(rng) * routine.jitterMin
+                                                      : 8 * 60 + unit(rng) * 15 * 60;
+            int64_t arrive = day * DAY_MS + (int64_t)(arriveMin * 60000);
+            int64_t stay = (int64_t)(routine.stayMin * 60000 * (0.8 + 0.4 * unit(rng)));
+            deviceVisits.push_back({ arrive, arrive + stay });
+        }
+        visits.push_back(deviceVisits);
+    }
+
+    printf("[arrival-replay] %zu 台设备、%d 天（前 %d 天只学习）：", visits.size(), DAYS, TRAIN_DAYS);
+    for (const auto& routine : ARRIVAL_ROUTINES) printf(" %s", routine.name);
+    printf("\n");
+    ReplayResult dense = ReplayArrivals("固定 15 秒", ReplayPolicy::Dense, visits, DAYS, TRAIN_DAYS);
+    ReplayResult sparse = ReplayArrivals("固定 60 秒", ReplayPolicy::Sparse, visits, DAYS, TRAIN_DAYS);
+    ReplayResult predicted = ReplayArrivals("按预测", ReplayPolicy::Predicted, visits, DAYS, TRAIN_DAYS);
+    // 没有漏检，按预测扫描的时长不超过固定 15 秒
+    return dense.missed == 0 && sparse.missed == 0 && predicted.missed == 0 &&
+        predicted.scanSecondsPerDay <= dense.scanSecondsPerDay;
+}
+
+// 多适配器重连风暴：所有在范围内的设备同时断开（例如系统休眠唤醒），统计全部重连完成的虚拟时间与吞吐量。
+// 重连工作线程固定为 8，每个适配器同时最多 2 个连接，设备轮流分配到各适配器
+static bool RunRadioStorm(int radios, int failingRadio) {
+    const int DEVICES = 200;
+    const int64_t LIMIT_MS = 3600000;
+    VirtualClock clock(0);
+    SimFleetOptions options;
+    options.devices = DEVICES;
+    options.radios = radios;
+    options.failingRadio = failingRadio;
+    options.startLinkDown = true;
+    options.meanPresentMs = 24 * 3600000ll;     // 全部设备在范围内，风暴期间不离开
+    options.meanAbsentMs = 1;
+    SimulatedFleet fleet(clock, options);
+
+    DeviceRegistry registry(DEVICES);
+    vector<PairedDevice> paired;
+    fleet.Snapshot(paired);
+    for (const auto& device : paired) {
+        DeviceRecord& record = registry.Upsert(device.address);
+        record.name = device.name;
+        record.connected = device.connected;
+        record.radio = device.radio;
+        record.monitored = true;
+    }
+
+    SimReconnectExecutor executor(clock, 8, 2, [&fleet](BtAddr address) { return fleet.ConnectDurationMs(address); });
+    CountingMonitorHost host;
+    MonitorCore core(clock, registry, fleet, executor, host);
+    core.Start(true);
+
+    // 故障适配器上的设备永远连不上，只等其余设备
+    size_t reachable = 0;
+    for (const auto& device : paired) {
+        if (device.radio != failingRadio) reachable++;
+    }
+    size_t present = reachable;
+
+    vector<PresenceEvent> events;
+    int64_t doneMs = -1;
+    while (clock.NowMs() < LIMIT_MS) {
+        size_t connected = 0;
+        for (const auto& record : registry) {
+            if (record.connected && record.radio != failingRadio) connected++;
+        }
+        if (connected >= present) {
+            doneMs = clock.NowMs();
+            break;
+        }
+        int64_t now = clock.NowMs();
+        int64_t next = LIMIT_MS;
+        int64_t due = core.MsUntilNext();
+        if (due >= 0) next = min(next, now + due);
+        int64_t done = executor.NextCompletionMs();
+        if (done >= 0) next = min(next, done);
+        int64_t change = fleet.NextChangeMs();
+        if (change >= 0) next = min(next, change);
+        if (next > now) clock.Set(next);
+
+        fleet.Advance(events);
+        executor.Advance();
+        core.Step(events, true);
+    }
+
+    const MonitorCoreStats& stats = core.Stats();
+    double seconds = (doneMs >= 0 ? doneMs : LIMIT_MS) / 1000.0;
+    printf("[multi-radio] %d 个适配器%s：%zu 台在范围内的设备全部重连用时 %.1f s（%.1f 台/分钟），重连提交 %llu、成功 %llu、失败 %llu；各适配器 成功/失败:",
+        radios, failingRadio >= 0 ? "（其中 1 个故障）" : "", present, seconds, present * 60.0 / seconds,
+        (unsigned long long)stats.reconnectsSubmitted, (unsigned long long)stats.reconnectsSucceeded,
+        (unsigned long long)stats.reconnectsFailed);
+    vector<pair<uint64_t, uint64_t>> outcomes = fleet.RadioOutcomes();
+    for (size_t i = 0; i < outcomes.size(); i++) {
+        printf(" #%zu %llu/%llu", i, (unsigned long long)outcomes[i].first, (unsigned long long)outcomes[i].second);
+    }
+    printf("\n");
+    return doneMs >= 0;
+}
+
+static bool BenchMultiRadio() {
+    bool ok = true;
+    for (int radios : { 1, 2, 4 }) ok = RunRadioStorm(radios, -1) && ok;
+    ok = RunRadioStorm(2, 1) && ok;
+
+    // 句柄故障隔离：第 2 个适配器报告句柄错误后只替换它的句柄，第 1 个适配器的句柄继续使用
+    FakeRadioBackend backend(2);
+    bool firstKept = false, secondReplaced = false;
+    {
+        RadioManager radios(backend);
+        RadioLease first = radios.Acquire(0);
+        RadioLease second = radios.Acquire(1);
+        RadioHandle firstHandle = first.Get();
+        RadioHandle secondHandle = second.Get();
+        radios.ReportFailure(second);
+        second = RadioLease();
+        firstKept = radios.Acquire(0).Get() == firstHandle;
+        secondReplaced = radios.Acquire(1).Get() != secondHandle;
+        first = RadioLease();
+        RadioStats stats = radios.Stats();
+        printf("[multi-radio] 句柄故障隔离：适配器 #0 句柄保留=%s，#1 重新打开=%s，#1 句柄错误=%llu，打开 %llu 次",
+            firstKept ? "是" : "否", secondReplaced ? "是" : "否",
+            (unsigned long long)(stats.radioFailures.size() > 1 ? stats.radioFailures[1] : 0), (unsigned long long)stats.opens);
+    }
+    printf("，销毁后未关闭句柄=%zu\n", backend.OpenHandles());
+    return ok && firstKept && secondReplaced && backend.OpenHandles() == 0;
+}
+
+static bool BenchFleet() {
+    const int64_t HOUR_MS = 3600000;
+    bool ok = true;
+    for (int devices : { 100, 1000, 5000 }) {
+        ok = RunFleet(devices, true, HOUR_MS) && ok;
+        ok = RunFleet(devices, false, HOUR_MS) && ok;
+    }
+    return ok;
+}
+
+// 在虚拟时钟上运行监控核心 durationMs，统计监控循环的唤醒次数（每次 Step 即一次唤醒）
+struct IdleWakeResult {
+    double wakeupsPerHour = 0;
+    uint64_t steps = 0;
+    uint64_t emptySteps = 0;
+    uint64_t polls = 0;
+    uint64_t inquiryWakeups = 0;    // 主动扫描到期（包括规划判断无需扫描的）
+    uint64_t reconnects = 0;
+    HistogramSnapshot reconnect;
+    size_t connected = 0;
+    size_t present = 0;
+};
+
+static IdleWakeResult RunIdleWakeups(const SimFleetOptions& options, int64_t durationMs) {
+    VirtualClock clock(0);
+    SimulatedFleet fleet(clock, options);
+    Metrics metrics;
+
+    DeviceRegistry registry(options.devices);
+    vector<PairedDevice> paired;
+    fleet.EnumeratePaired(false, paired);
+    for (const auto& device : paired) {
+        DeviceRecord& record = registry.Upsert(device.address);
+        record.name = device.name;
+        record.connected = device.connected;
+        record.monitored = true;
+    }
+
+    SimReconnectExecutor executor(clock, 4, 2, [&fleet](BtAddr address) { return fleet.ConnectDurationMs(address); });
+    SimInquiryStage inquiry(clock, fleet);
+    CountingMonitorHost host;
+    MonitorCore core(clock, registry, fleet, executor, host);
+    core.SetMetrics(&metrics);
+    core.SetInquiryStage(&inquiry);
+    core.Start(options.emitEvents);
+
+    vector<PresenceEvent> events;
+    int64_t end = clock.NowMs() + durationMs;
+    while (clock.NowMs() < end) {
+        int64_t now = clock.NowMs();
+        int64_t next = end;
+        int64_t due = core.MsUntilNext();
+        if (due >= 0) next = min(next, now + due);
+        int64_t done = executor.NextCompletionMs();
+        if (done >= 0) next = min(next, done);
+        int64_t change = fleet.NextChangeMs();
+        if (change >= 0) next = min(next, change);
+        int64_t scanned = inquiry.NextCompletionMs();
+        if (scanned >= 0) next = min(next, scanned);
+        if (next >= end) break;     // 结束前没有任何事，不算一次唤醒
+        if (next > now) clock.Set(next);
+
+        fleet.Advance(events);
+        executor.Advance();
+        core.Step(events, options.emitEvents);
+    }
+    clock.Set(end);
+
+    const MonitorCoreStats& stats = core.Stats();
+    IdleWakeResult result;
+    result.wakeupsPerHour = core.WakeupsPerHour();
+    result.steps = stats.steps;
+    result.emptySteps = stats.emptySteps;
+    result.polls = stats.polls;
+    result.inquiryWakeups = stats.inquiries + stats.inquiriesSkipped + stats.inquiriesPlannedOut;
+    result.reconnects = stats.reconnectsSucceeded;
+    result.reconnect = metrics.reconnect.Snapshot();
+    result.connected = fleet.ConnectedCount();
+    result.present = fleet.PresentCount();
+    return result;
+}
+
+// 空闲唤醒：设备都已连接时监控循环只应在兜底轮询与统计输出时醒来
+static bool BenchIdleWakeups() {
+    const int64_t HOUR_MS = 3600000;
+    const int64_t DAY_MS = 24 * HOUR_MS;
+    SchedulerOptions defaults;
+
+    // 原做法的固定节奏：GUI 每 500 ms 醒来检查停止标志，控制台事件源正常时 15 s 兜底轮询 + 15 s 扫描定时
+    printf("[idle-wakeups] 原做法（固定节奏）：GUI 500 ms 分片 %lld 次/小时，事件驱动 %lld 次/小时，轮询 %lld 次/小时\n",
+        (long long)(HOUR_MS / 500), (long long)(HOUR_MS / defaults.eventPollMs + HOUR_MS / defaults.inquiryMs),
+        (long long)(HOUR_MS / defaults.fallbackPollMs));
+
+    // 一整天内没有任何设备离开（全部保持连接）
+    SimFleetOptions quiet;
+    quiet.devices = 16;
+    quiet.meanPresentMs = 1000 * DAY_MS;
+    quiet.meanAbsentMs = 60000;
+    quiet.linkDropRate = 1.0;
+    // 空闲目标：事件源覆盖全部适配器时每小时 6 次兜底轮询 + 1 次统计输出
+    const double goal = (double)(HOUR_MS / defaults.idlePollMs + 1);
+    bool passed = true;
+    for (bool eventDriven : { true, false }) {
+        quiet.emitEvents = eventDriven;
+        IdleWakeResult r = RunIdleWakeups(quiet, DAY_MS);
+        bool quietOk = r.inquiryWakeups == 0 && r.connected == r.present;
+        if (eventDriven) {
+            bool ok = quietOk && r.wakeupsPerHour <= goal + 0.5;
+            passed = passed && ok;
+            printf("[idle-wakeups] 全部已连接（事件，%d 台，24 小时）：唤醒 %llu 次（%.1f 次/小时，目标 ≤ %.0f），其中无事可做 %llu；"
+                "轮询 %llu、扫描到期 %llu；在线 %zu/%zu — %s\n",
+                quiet.devices, (unsigned long long)r.steps, r.wakeupsPerHour, goal,
+                (unsigned long long)r.emptySteps, (unsigned long long)r.polls, (unsigned long long)r.inquiryWakeups,
+                r.connected, r.present, ok ? "通过" : "未通过");
+        } else {
+            // 轮询模式达不到空闲目标：没有事件源时兜底轮询是发现断开的唯一途径，只能按 fallbackPollMs 醒来。
+            // 这里只检查没有轮询之外的唤醒
+            double cadence = (double)(HOUR_MS / defaults.fallbackPollMs + 1);
+            bool ok = quietOk && r.wakeupsPerHour <= cadence + 0.5;
+            passed = passed && ok;
+            printf("[idle-wakeups] 全部已连接（轮询，%d 台，24 小时）：唤醒 %.1f 次/小时，不满足空闲目标（≤ %.0f）——"
+                "无事件源时只能每 %d ms 轮询发现断开；轮询之外的唤醒 %s，在线 %zu/%zu\n",
+                quiet.devices, r.wakeupsPerHour, goal, defaults.fallbackPollMs,
+                ok ? "无" : "存在（未通过）", r.connected, r.present);
+        }
+    }
+
+    // 偶尔断开：离开空闲后重连不受影响，之后重新进入空闲
+    SimFleetOptions churn = quiet;
+    churn.emitEvents = true;
+    churn.meanPresentMs = 6 * HOUR_MS;
+    churn.meanAbsentMs = 10 * 60000;
+    churn.linkDropRate = 0.5;
+    IdleWakeResult r = RunIdleWakeups(churn, DAY_MS);
+    printf("[idle-wakeups] 偶尔断开（事件，%d 台，24 小时）：唤醒 %.1f 次/小时，其中无事可做 %llu；断开→重连 %llu 次 p50 %.1f s、p99 %.1f s；"
+        "结束时在线 %zu/%zu\n",
+        churn.devices, r.wakeupsPerHour, (unsigned long long)r.emptySteps, (unsigned long long)r.reconnect.count,
+        r.reconnect.PercentileUs(50) / 1e6, r.reconnect.PercentileUs(99) / 1e6, r.connected, r.present);
+    printf("[idle-wakeups] 空闲唤醒检查：%s\n", passed ? "通过" : "未通过");
+    return passed;
+}
+
+struct BenchScenario {
+    const char* name;
+    const char* description;
+    bool (*run)();     // 返回场景检查是否通过
+};
+
+static const BenchScenario SCENARIOS[] = {
+    { "presence", "事件驱动在场检测的检测→处理延迟", BenchPresenceLatency },
+    { "reconnect-pool", "重连工作池：总耗时随并发上限的变化", BenchReconnectPool },
+    { "scheduler", "时间轮调度器：探测退避与虚拟时钟下的一小时开销", BenchScheduler },
+    { "device-registry", "设备注册表：按地址查找 vs 嵌套 memcmp + 字符串键", BenchDeviceRegistry },
+    { "device-store", "结构数组设备存储：地址匹配 嵌套 memcmp vs 逐个 / SSE2 / AVX2 比较", BenchDeviceStore },
+    { "device-diff", "设备列表刷新：整表重建 vs 按地址差量", BenchDeviceDiff },
+    { "scan-path", "枚举路径：原做法 vs 暂存区 + 名称驻留的堆分配次数，监控核心稳态 Step 的分配", BenchScanPath },
+    { "device-feed", "设备变化流：空闲时每次枚举的分配次数与 CPU 耗时，随机变化下订阅者镜像一致性", BenchDeviceFeed },
+    { "service-cache", "已安装服务缓存：一小时内省去的服务枚举次数", BenchServiceCache },
+    { "radio-manager", "适配器句柄管理：复用/重新打开次数与句柄泄漏检查", BenchRadioManager },
+    { "service-ranking", "服务切换顺序学习：学习前后的连接耗时", BenchServiceRanking },
+    { "link-waiter", "链路建立等待：固定 1200 ms vs 递增间隔轮询与按类别学习的截止时间", BenchLinkWaiter },
+    { "cancel-connect", "停止监控时进行中连接的结束延迟：固定 Sleep vs 可取消操作，及截止时间", BenchCancelConnect },
+    { "supervisor", "监控循环停止/重启：分离线程 + Sleep(500) vs 单线程监督者（重启耗时、循环重叠）", BenchSupervisor },
+    { "metrics", "延迟直方图：百分位误差与并发记录开销", BenchMetrics },
+    { "fleet", "模拟设备群：虚拟时钟上运行真实监控核心一小时的开销与重连耗时", BenchFleet },
+    { "idle-wakeups", "空闲唤醒：设备都已连接时每小时的唤醒次数，以及偶尔断开时的重连耗时", BenchIdleWakeups },
+    { "snapshot", "设备状态快照发布：并发读写一致性压力测试与读取吞吐", BenchSnapshot },
+    { "ui-actions", "界面操作：每次新开线程 vs 固定执行器 + 刷新合并与共享扫描", BenchUiActions },
+    { "multi-radio", "多适配器：重连风暴的吞吐量随适配器数的变化，以及单个适配器故障的隔离", BenchMultiRadio },
+    { "inquiry-pipeline", "主动扫描：监控循环内同步 vs 独立阶段异步，单次处理耗时与事件等待", BenchInquiryPipeline },
+    { "inquiry-budget", "主动扫描规划：没有需要发现的设备时不扫描，每分钟扫描时长预算", BenchInquiryBudget },
+    { "arrival-replay", "到达时段预测：按日常规律回放，固定扫描间隔 vs 按预测疏密扫描的扫描时长与发现延迟", BenchArrivalReplay },
+    { "log-ring", "日志写入：加锁同步写 vs 无锁环形缓冲区，UI 忙时写入方的等待与丢弃计数", BenchLogRing },
+    { "log-store", "日志框存储：一直增长的整块文本 vs 定长记录环 + 字符区", BenchLogStore },
+};
+
+static void PrintUsage() {
+    printf("用法:\n"
+        "  BluetoothBench            运行全部场景\n"
+        "  BluetoothBench <场景>...  只运行指定场景\n"
+        "  BluetoothBench --list     列出场景\n"
+        "  BluetoothBench --help     显示本说明\n"
+        "任一场景检查未通过时退出码为 1\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0)) {
+        PrintUsage();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--list") == 0) {
+        for (const auto& s : SCENARIOS) printf("%-12s %s\n", s.name, s.description);
+        return 0;
+    }
+
+    int ran = 0;
+    vector<const char*> failed;
+    for (const auto& s : SCENARIOS) {
+        bool selected = argc <= 1;
+        for (int i = 1; i < argc && !selected; i++) {
+            if (strcmp(argv[i], s.name) == 0) selected = true;
+        }
+        if (!selected) continue;
+        auto start = chrono::steady_clock::now();
+        bool ok = s.run();
+        auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        printf("[%s] %s，用时 %lld ms\n\n", s.name, ok ? "完成" : "检查未通过", (long long)ms);
+        if (!ok) failed.push_back(s.name);
+        ran++;
+    }
+
+    if (ran == 0) {
+        fprintf(stderr, "未知场景，使用 --list 查看可用场景\n");
+        return 1;
+    }
+    if (!failed.empty()) {
+        fprintf(stderr, "检查未通过的场景:");
+        for (const char* name : failed) fprintf(stderr, " %s", name);
+        fprintf(stderr, "\n");
+        return 1;
+    }
+    return 0;
+}
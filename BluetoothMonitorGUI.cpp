@@ -8,9 +8,36 @@
 #include <thread>
 #include <mutex>
 #include <fstream>
+#include <sstream>
 #include <codecvt>
 #include <locale>
 #include <unordered_map>
+#include <atomic>
+
+#include "ActionExecutor.h"
+#include "ArrivalPredictor.h"
+#include "Cancellation.h"
+#include "DeviceDiff.h"
+#include "DeviceRegistry.h"
+#include "InquiryStage.h"
+#include "LinkWaiter.h"
+#include "LogRing.h"
+#include "LogStore.h"
+#include "Metrics.h"
+#include "MonitorCore.h"
+#include "MonitorScheduler.h"
+#include "MonitorSupervisor.h"
+#include "PresenceEngine.h"
+#include "ReconnectPool.h"
+#include "RadioManager.h"
+#include "ScanArena.h"
+#include "ServiceCache.h"
+#include "ServiceRanking.h"
+#include "Settings.h"
+#include "Snapshot.h"
+#include "WinBluetooth.h"
+#include "WinPresenceSource.h"
+#include "WinRadioBackend.h"
 
 #pragma comment(lib, "Bthprops.lib")
 #pragma comment(lib, "ws2_32.lib")
@@ -26,14 +53,16 @@ const wchar_t WINDOW_TITLE[] = L"蓝牙设备自动连接";
 
 // 消息和控件ID
 #define WM_TRAYICON (WM_USER + 1)
+#define WM_DEVICES_CHANGED (WM_USER + 2)
 #define ID_TRAY_EXIT 1001
 #define ID_TRAY_SHOW 1002
 #define ID_TRAY_CONFIG 1003
-#define ID_LOG_EDIT 2001
+#define ID_LOG_LIST 2001
 #define ID_DEVICE_LIST 2002
 #define ID_BTN_START 2003
 #define ID_BTN_STOP 2004
 #define ID_BTN_CLEAR 2005
+#define ID_BTN_METRICS 2006
 #define ID_DEVICE_CONNECT 3001
 #define ID_DEVICE_DISCONNECT 3002
 #define ID_DEVICE_COPY_MAC 3003
@@ -41,13 +70,7 @@ const wchar_t WINDOW_TITLE[] = L"蓝牙设备自动连接";
 #define ID_DEVICE_COPY_NAME 3005
 #define ID_DEVICE_ADD_MONITOR 3006
 #define ID_DEVICE_REMOVE_MONITOR 3007
-
-// 蓝牙设备信息结构
-struct BluetoothDeviceInfo {
-    BLUETOOTH_ADDRESS address;
-    wstring name;
-    bool connected;
-};
+#define ID_TIMER_LOG 4001
 
 // 全局变量
 HINSTANCE g_hInst = nullptr;
@@ -55,37 +78,129 @@ HWND g_hwndMain = nullptr;
 HWND g_hwndLog = nullptr;
 HWND g_hwndDeviceList = nullptr;
 NOTIFYICONDATAW g_nid = {};
-bool g_bRunning = true;
-mutex g_logMutex;
-thread* g_pMonitorThread = nullptr;
-vector<BluetoothDeviceInfo> g_currentDevices;
-set<wstring> g_monitorDevices;
-// 手动断开后，阻止自动重连的设备（按MAC字符串标识）
-set<wstring> g_blockAutoReconnect;
-// 每台设备的重连冷却时间戳
-unordered_map<wstring, chrono::steady_clock::time_point> g_lastConnectAttempt;
-static const int CONNECT_COOLDOWN_MS = 8000; // 8秒冷却
-
-// 将 BLUETOOTH_ADDRESS 转换为字符串
-wstring BluetoothAddressToString(const BLUETOOTH_ADDRESS& addr) {
-    wchar_t buffer[18];
-    swprintf_s(buffer, L"%02X:%02X:%02X:%02X:%02X:%02X",
-        addr.rgBytes[5], addr.rgBytes[4], addr.rgBytes[3],
-        addr.rgBytes[2], addr.rgBytes[1], addr.rgBytes[0]);
-    return wstring(buffer);
+// 监控循环由 g_monitor 在同一个线程中依次运行：停止、重启、修改监控列表只取消当前循环（进行中的重连随之结束），
+// 不阻塞 UI 线程，任何时刻最多一个循环。退出时另外取消手动连接/断开（g_appCancel）。
+// 手动操作的截止时间取自最近一次读取的 settings.txt
+void MonitorThread(const CancelToken& stop);
+void OnMonitorFailure(const string& what);
+MonitorSupervisor g_monitor(MonitorThread, OnMonitorFailure);
+CancelSource g_appCancel;
+atomic<int> g_connectDeadlineMs{ MonitorSettings().connectDeadlineMs };
+// 日志环形缓冲区：各线程写入，UI 线程每 LOG_DRAIN_MS 毫秒批量取出追加到日志框
+LogRing g_logRing;
+const UINT LOG_DRAIN_MS = 100;
+const size_t LOG_DRAIN_BATCH = 1024;
+// 日志框只显示最近的 LogStore 容量内的行，更早的行写入磁盘日志
+LogStore g_logStore;
+const wchar_t LOG_SPILL_FILE[] = L"monitor_log.txt";
+wofstream g_logSpillFile;
+// 设备列表的差量：任意线程用新快照更新（只记录变化），UI 线程收到 WM_DEVICES_CHANGED 后应用到虚拟列表。
+// 写入方之间用 g_deviceTableMutex 串行
+DeviceTable g_deviceTable;
+vector<DeviceDiffEntry> g_pendingDeviceOps;
+mutex g_deviceTableMutex;
+// 发布给读取方的不可变快照：设备列表各行、要监控的设备名。读取时不加锁，每次刷新最多发布一次
+SnapshotCell<vector<DeviceRow>> g_deviceRows;
+SnapshotCell<set<wstring>> g_monitorDevices;
+// 虚拟列表当前显示的行：与 UI 线程最后应用的差量对应（只在 UI 线程读写），
+// 显示与选中项都按它取设备，避免新快照已发布、列表布局尚未更新时下标对应到别的设备
+SnapshotCell<vector<DeviceRow>>::Ptr g_listedRows;
+// 设备注册表：按地址保存每台设备的状态（连接、手动断开阻止、重连冷却、统计），
+// 监控线程与手动连接/断开线程共用，访问时持有 g_registryMutex
+DeviceRegistry g_deviceRegistry;
+mutex g_registryMutex;
+// 正在运行的监控循环的在场引擎：空闲时循环只在截止时间或事件到来时醒来，
+// 其他线程改变了它需要知道的状态（例如解除手动断开阻止）时通过 WakeMonitor 唤醒
+PresenceEngine* g_monitorPresence = nullptr;
+mutex g_monitorPresenceMutex;
+
+// 唤醒监控循环重新检查注册表（可在任意线程调用，没有循环在运行时不做任何事）
+void WakeMonitor() {
+    lock_guard<mutex> lock(g_monitorPresenceMutex);
+    if (g_monitorPresence) g_monitorPresence->Interrupt();
+}
+
+// 设置/解除手动断开后的自动重连阻止（可在任意线程调用）；解除后唤醒监控循环，空闲时也能立即恢复自动重连
+void SetAutoReconnectBlocked(const BLUETOOTH_ADDRESS& address, bool blocked) {
+    {
+        lock_guard<mutex> lock(g_registryMutex);
+        g_deviceRegistry.Upsert(ToBtAddr(address)).blockAutoReconnect = blocked;
+    }
+    if (!blocked) WakeMonitor();
 }
 
 // 添加日志
 void AddLog(const wstring& message) {
-    lock_guard<mutex> lock(g_logMutex);
-    
-    if (g_hwndLog) {
-        int len = GetWindowTextLength(g_hwndLog);
-        SendMessage(g_hwndLog, EM_SETSEL, len, len);
-        SendMessage(g_hwndLog, EM_REPLACESEL, FALSE, (LPARAM)message.c_str());
-        SendMessage(g_hwndLog, EM_REPLACESEL, FALSE, (LPARAM)L"\r\n");
-        SendMessage(g_hwndLog, EM_SCROLLCARET, 0, 0);
+    g_logRing.Push(message);
+}
+
+// 从日志框淘汰的行追加到磁盘日志（UTF-8）
+void SpillLogLine(const wchar_t* text, size_t length) {
+    if (!g_logSpillFile.is_open()) {
+        g_logSpillFile.open(LOG_SPILL_FILE, ios::out | ios::app);
+        g_logSpillFile.imbue(locale(locale(), new codecvt_utf8<wchar_t>));
     }
+    g_logSpillFile.write(text, length);
+    g_logSpillFile.put(L'\n');
+}
+
+void AppendLogLine(const wstring& line) {
+    g_logStore.Append(line.data(), line.size(), SpillLogLine);
+}
+
+// 刷新日志框：只更新行数，可见行在 LVN_GETDISPINFO 中按需读取；原本停在末尾时继续跟随
+void RefreshLogView() {
+    if (!g_hwndLog) return;
+    int previous = ListView_GetItemCount(g_hwndLog);
+    bool follow = ListView_GetTopIndex(g_hwndLog) + ListView_GetCountPerPage(g_hwndLog) >= previous;
+    int count = (int)g_logStore.Count();
+    ListView_SetItemCountEx(g_hwndLog, count, LVSICF_NOSCROLL);
+    if (follow && count > 0) ListView_EnsureVisible(g_hwndLog, count - 1, FALSE);
+    InvalidateRect(g_hwndLog, NULL, FALSE);
+}
+
+// 取出缓冲区中的日志（最多 maxRecords 条）一次性追加到日志框（仅在 UI 线程调用）
+void DrainLog(size_t maxRecords = LOG_DRAIN_BATCH) {
+    static LogRingStats reported;
+    size_t drained = g_logRing.Drain([](const wchar_t* text, size_t length) {
+        g_logStore.Append(text, length, SpillLogLine);
+    }, maxRecords);
+
+    LogRingStats stats = g_logRing.Stats();
+    if (stats.dropped != reported.dropped) {
+        AppendLogLine(L"[日志] 缓冲区已满，丢弃 " + to_wstring(stats.dropped - reported.dropped) + L" 条日志");
+        drained++;
+    }
+    if (stats.truncated != reported.truncated) {
+        AppendLogLine(L"[日志] " + to_wstring(stats.truncated - reported.truncated) + L" 条日志超过 " +
+            to_wstring(LogRing::SLOT_CHARS) + L" 字符被截断");
+        drained++;
+    }
+    reported = stats;
+
+    if (drained == 0) return;
+    if (g_logSpillFile.is_open()) g_logSpillFile.flush();
+    RefreshLogView();
+}
+
+// 日志框的 LVN_GETDISPINFO：复制第 iItem 行的文本
+void GetLogDispInfo(NMLVDISPINFO* info) {
+    if (!(info->item.mask & LVIF_TEXT) || info->item.cchTextMax <= 0) return;
+    size_t length = 0;
+    const wchar_t* text = L"";
+    if (info->item.iItem >= 0 && (size_t)info->item.iItem < g_logStore.Count()) {
+        text = g_logStore.Line(info->item.iItem, &length);
+    }
+    length = min(length, (size_t)info->item.cchTextMax - 1);
+    wmemcpy(info->item.pszText, text, length);
+    info->item.pszText[length] = L'\0';
+}
+
+// 清空日志框，已显示的行先写入磁盘日志
+void ClearLogView() {
+    g_logStore.Clear(SpillLogLine);
+    if (g_logSpillFile.is_open()) g_logSpillFile.flush();
+    RefreshLogView();
 }
 
 // 读取配置文件
@@ -147,6 +262,15 @@ bool SaveConfig(const wstring& configFile, const set<wstring>& monitorDevices) {
     return file.good() || !file.bad();
 }
 
+// 读取运行参数（settings.txt），文件不存在时使用默认值
+MonitorSettings LoadSettings(const wstring& settingsFile) {
+    wifstream file(settingsFile);
+    if (!file.is_open()) {
+        return MonitorSettings();
+    }
+    return ParseSettings(file);
+}
+
 // 名称匹配：patterns 中任意一项作为子串出现在 text 中即认为匹配
 bool MatchAnySubstring(const wstring& text, const set<wstring>& patterns) {
     if (patterns.empty()) return true;
@@ -156,223 +280,8 @@ bool MatchAnySubstring(const wstring& text, const set<wstring>& patterns) {
     return false;
 }
 
-// 获取所有已配对的蓝牙设备
-vector<BluetoothDeviceInfo> GetPairedDevices() {
-    vector<BluetoothDeviceInfo> devices;
-    
-    BLUETOOTH_DEVICE_SEARCH_PARAMS searchParams = { 0 };
-    searchParams.dwSize = sizeof(BLUETOOTH_DEVICE_SEARCH_PARAMS);
-    searchParams.fReturnAuthenticated = TRUE;
-    searchParams.fReturnRemembered = TRUE;
-    searchParams.fReturnConnected = TRUE;
-    searchParams.fReturnUnknown = FALSE;
-    searchParams.fIssueInquiry = FALSE;
-    searchParams.cTimeoutMultiplier = 1;
-
-    BLUETOOTH_DEVICE_INFO deviceInfo = { 0 };
-    deviceInfo.dwSize = sizeof(BLUETOOTH_DEVICE_INFO);
-
-    HBLUETOOTH_DEVICE_FIND hFind = BluetoothFindFirstDevice(&searchParams, &deviceInfo);
-    
-    if (hFind != NULL) {
-        do {
-            BluetoothDeviceInfo info;
-            info.address = deviceInfo.Address;
-            info.name = deviceInfo.szName;
-            info.connected = deviceInfo.fConnected;
-            devices.push_back(info);
-        } while (BluetoothFindNextDevice(hFind, &deviceInfo));
-        
-        BluetoothFindDeviceClose(hFind);
-    }
-    
-    return devices;
-}
-
-// 带可选主动查询的设备获取（用于提高“在线/可连接”检测的及时性）
-vector<BluetoothDeviceInfo> GetPairedDevicesWithInquiry(bool doInquiry) {
-    vector<BluetoothDeviceInfo> devices;
-    
-    BLUETOOTH_DEVICE_SEARCH_PARAMS searchParams = { 0 };
-    searchParams.dwSize = sizeof(BLUETOOTH_DEVICE_SEARCH_PARAMS);
-    searchParams.fReturnAuthenticated = TRUE;
-    searchParams.fReturnRemembered = TRUE;
-    searchParams.fReturnConnected = TRUE;
-    searchParams.fReturnUnknown = FALSE;
-    searchParams.fIssueInquiry = doInquiry ? TRUE : FALSE;
-    searchParams.cTimeoutMultiplier = doInquiry ? 2 : 1;
-
-    BLUETOOTH_DEVICE_INFO deviceInfo = { 0 };
-    deviceInfo.dwSize = sizeof(BLUETOOTH_DEVICE_INFO);
-
-    HBLUETOOTH_DEVICE_FIND hFind = BluetoothFindFirstDevice(&searchParams, &deviceInfo);
-    
-    if (hFind != NULL) {
-        do {
-            BluetoothDeviceInfo info;
-            info.address = deviceInfo.Address;
-            info.name = deviceInfo.szName;
-            info.connected = deviceInfo.fConnected;
-            devices.push_back(info);
-        } while (BluetoothFindNextDevice(hFind, &deviceInfo));
-        
-        BluetoothFindDeviceClose(hFind);
-    }
-    
-    return devices;
-}
-
-// 辅助：错误码转字符串
-wstring Win32ErrorToString(DWORD code) {
-    LPWSTR buf = nullptr;
-    DWORD len = FormatMessageW(
-        FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-        NULL, code, 0, (LPWSTR)&buf, 0, NULL);
-    wstring msg = len ? wstring(buf) : L"";
-    if (buf) LocalFree(buf);
-    return msg;
-}
-
-// 辅助：GUID 转字符串
-wstring GuidToString(const GUID& g) {
-    wchar_t buf[64];
-    swprintf_s(buf, 64, L"{%08lX-%04hX-%04hX-%02X%02X-%02X%02X%02X%02X%02X%02X}",
-        g.Data1, g.Data2, g.Data3,
-        g.Data4[0], g.Data4[1], g.Data4[2], g.Data4[3], g.Data4[4], g.Data4[5], g.Data4[6], g.Data4[7]);
-    return wstring(buf);
-}
-
-// 辅助：打开第一个蓝牙无线电句柄
-HANDLE OpenFirstRadio() {
-    BLUETOOTH_FIND_RADIO_PARAMS params = { sizeof(BLUETOOTH_FIND_RADIO_PARAMS) };
-    HBLUETOOTH_RADIO_FIND hFind = nullptr;
-    HANDLE hRadio = nullptr;
-    hFind = BluetoothFindFirstRadio(&params, &hRadio);
-    if (hFind != NULL) {
-        BluetoothFindRadioClose(hFind);
-        return hRadio;
-    }
-    return nullptr;
-}
-
-// 辅助：判断服务是否为音频相关
-bool IsAudioService(const GUID& guid) {
-    return (guid == AudioSinkServiceClass_UUID ||
-            guid == AudioSourceServiceClass_UUID ||
-            guid == AVRemoteControlTargetServiceClass_UUID ||
-            guid == AVRemoteControlServiceClass_UUID ||
-            guid == HandsfreeServiceClass_UUID ||
-            guid == HeadsetServiceClass_UUID);
-}
-
-// 辅助：判断服务是否为 GATT 服务
-bool IsGATTService(const GUID& guid) {
-    return (guid.Data1 == 0x1800 || guid.Data1 == 0x1801) &&
-           guid.Data2 == 0x0000 && guid.Data3 == 0x1000;
-}
-
-// 连接蓝牙设备（参考提供的代码：通过禁用/启用音频相关服务触发连接）
-bool ConnectDevice(const BLUETOOTH_ADDRESS& address, const wstring& deviceName) {
-    AddLog(L"尝试连接设备: " + deviceName + L" [" + BluetoothAddressToString(address) + L"]");
-
-    BLUETOOTH_DEVICE_INFO deviceInfo = { 0 };
-    deviceInfo.dwSize = sizeof(BLUETOOTH_DEVICE_INFO);
-    deviceInfo.Address = address;
-
-    DWORD result = BluetoothGetDeviceInfo(NULL, &deviceInfo);
-    if (result != ERROR_SUCCESS) {
-        AddLog(L"  获取设备信息失败: " + to_wstring(result) + L" " + Win32ErrorToString(result));
-        return false;
-    }
-
-    if (deviceInfo.fConnected) {
-        AddLog(L"  设备已连接");
-        return true;
-    }
-
-    HANDLE hRadio = OpenFirstRadio();
-    if (!hRadio) {
-        AddLog(L"  未找到蓝牙适配器");
-        return false;
-    }
-
-    // 优先从“已安装服务”中过滤目标服务，减少 1060/87 错误
-    vector<GUID> installed;
-    {
-        const DWORD CAP = 32;
-        GUID guids[CAP] = {};
-        DWORD returned = CAP;
-        DWORD er = BluetoothEnumerateInstalledServices(hRadio, &deviceInfo, &returned, guids);
-        if (er == ERROR_SUCCESS && returned > 0) {
-            for (DWORD i = 0; i < returned; ++i) installed.push_back(guids[i]);
-        }
-    }
-
-    auto contains = [](const vector<GUID>& vec, const GUID& g) {
-        for (const auto& x : vec) if (x == g) return true; return false;
-    };
-
-    // 参考实现：先禁用再启用常见音频相关服务（按优先级）
-    vector<GUID> wanted = {
-        AudioSinkServiceClass_UUID,                 // A2DP 音频接收器
-        AudioSourceServiceClass_UUID,               // A2DP 音频源
-        HandsfreeServiceClass_UUID,                 // 免提
-        HeadsetServiceClass_UUID,                   // 头戴式/耳机
-        AVRemoteControlTargetServiceClass_UUID,     // AVRCP 目标
-        AVRemoteControlServiceClass_UUID            // AVRCP 控制器
-    };
-
-    vector<GUID> services;
-    if (!installed.empty()) {
-        for (const auto& g : wanted) if (contains(installed, g)) services.push_back(g);
-    }
-    if (services.empty()) services = wanted; // 无法枚举时按全量尝试
-
-    bool anySuccess = false;
-    for (const auto& svc : services) {
-        // 先禁用
-        BluetoothSetServiceState(hRadio, &deviceInfo, &svc, BLUETOOTH_SERVICE_DISABLE);
-        Sleep(150);
-
-        // 再启用（先用 hRadio，87 时回退到 NULL）
-        DWORD r = BluetoothSetServiceState(hRadio, &deviceInfo, &svc, BLUETOOTH_SERVICE_ENABLE);
-        if (r == ERROR_INVALID_PARAMETER) {
-            r = BluetoothSetServiceState(NULL, &deviceInfo, &svc, BLUETOOTH_SERVICE_ENABLE);
-        }
-        if (r == ERROR_SUCCESS) {
-            anySuccess = true;
-            AddLog(L"  成功启用服务: " + GuidToString(svc));
-            Sleep(1200);
-
-            // 检查是否已连接
-            DWORD r2 = BluetoothGetDeviceInfo(NULL, &deviceInfo);
-            if (r2 == ERROR_SUCCESS && deviceInfo.fConnected) {
-                AddLog(L"  连接成功");
-                CloseHandle(hRadio);
-                return true;
-            }
-        } else if (r == ERROR_SERVICE_DOES_NOT_EXIST) {
-            // 跳过未安装的服务
-        } else {
-            AddLog(L"  启用服务失败: " + to_wstring(r) + L" " + Win32ErrorToString(r));
-        }
-    }
-
-    // 最终再检查一次连接状态
-    DWORD r3 = BluetoothGetDeviceInfo(NULL, &deviceInfo);
-    if (r3 == ERROR_SUCCESS && deviceInfo.fConnected) {
-        AddLog(L"  连接成功");
-        CloseHandle(hRadio);
-        return true;
-    }
-
-    CloseHandle(hRadio);
-    AddLog(L"  连接失败");
-    return false;
-}
-
-// 断开蓝牙设备（遍历已安装服务逐一禁用）
-bool DisconnectDevice(const BLUETOOTH_ADDRESS& address, const wstring& deviceName) {
+// 断开蓝牙设备（遍历已安装服务逐一禁用）；op 取消或超过截止时间时不再禁用剩余的服务
+bool DisconnectDevice(const BLUETOOTH_ADDRESS& address, const wstring& deviceName, int radioIndex, OperationContext& op) {
     wstring msg = L"尝试断开设备: " + deviceName + L" [" + BluetoothAddressToString(address) + L"]";
     AddLog(msg);
 
@@ -391,20 +300,15 @@ bool DisconnectDevice(const BLUETOOTH_ADDRESS& address, const wstring& deviceNam
         return true;
     }
 
-    HANDLE hRadio = OpenFirstRadio();
-    if (!hRadio) {
+    RadioLease radio = g_radios.Acquire(radioIndex);
+    if (!radio) radio = g_radios.Acquire();
+    if (!radio) {
         AddLog(L"  无法打开本地蓝牙适配器");
         return false;
     }
+    HANDLE hRadio = radio.Get();
     
-    vector<GUID> serviceGuids;
-    const DWORD CAP = 32;
-    GUID guids[CAP] = {};
-    DWORD returned = CAP;
-    result = BluetoothEnumerateInstalledServices(hRadio, &deviceInfo, &returned, guids);
-    if (result == ERROR_SUCCESS && returned > 0) {
-        for (DWORD i = 0; i < returned; ++i) serviceGuids.push_back(guids[i]);
-    }
+    vector<GUID> serviceGuids = GetInstalledServices(hRadio, deviceInfo);
 
     if (serviceGuids.empty()) {
         serviceGuids.push_back(HumanInterfaceDeviceServiceClass_UUID);      // HID
@@ -418,84 +322,195 @@ bool DisconnectDevice(const BLUETOOTH_ADDRESS& address, const wstring& deviceNam
     }
 
     bool ok = false;
+    OperationStatus status = op.Check();
     for (const auto& svc : serviceGuids) {
+        if (status != OperationStatus::Ok) break;
         result = BluetoothSetServiceState(hRadio, &deviceInfo, &svc, BLUETOOTH_SERVICE_DISABLE);
         if (result == ERROR_SUCCESS) ok = true;
+        else if (IsRadioHandleError(result)) g_radios.ReportFailure(radio);
+        status = op.Check();
     }
 
-    if (hRadio) CloseHandle(hRadio);
-    this_thread::sleep_for(chrono::milliseconds(500));
+    // 等待链路断开，取消时立即结束
+    if (status == OperationStatus::Ok) op.Wait(500);
+    if (status != OperationStatus::Ok) {
+        AddLog(wstring(L"  断开") + OperationStatusName(status));
+        return false;
+    }
 
     AddLog(ok ? L"  断开成功" : L"  断开失败");
 
     // 若断开成功，标记此设备禁止自动重连，直到用户手动连接为止
     if (ok) {
-        wstring key = BluetoothAddressToString(address);
-        g_blockAutoReconnect.insert(key);
+        SetAutoReconnectBlocked(address, true);
         AddLog(L"  已设置为手动断开：自动重连已禁用（直到手动连接）");
     }
     return ok;
 }
 
-// 更新设备列表显示
-void UpdateDeviceList(const vector<BluetoothDeviceInfo>& devices, const set<wstring>& monitorDevices) {
+// 更新设备列表显示（任意线程）；“监控”列按当前发布的监控列表标记，监控列表只由 UI 线程发布
+void UpdateDeviceList(const vector<BluetoothDeviceInfo>& devices) {
     if (!g_hwndDeviceList) return;
     
-    g_currentDevices = devices;
-    g_monitorDevices = monitorDevices;
+    auto monitorSnapshot = g_monitorDevices.Load();
+    const set<wstring>& monitorDevices = monitorSnapshot->value;
+    vector<DeviceRow> snapshot(devices.size());
+    for (size_t i = 0; i < devices.size(); i++) {
+        snapshot[i].address = ToBtAddr(devices[i].address);
+        snapshot[i].name = devices[i].name;
+        snapshot[i].connected = devices[i].connected;
+        snapshot[i].radio = devices[i].radio;
+        snapshot[i].monitored = !monitorDevices.empty() && MatchAnySubstring(devices[i].name, monitorDevices);
+    }
     
-    // 保存当前选中的设备名称
-    wstring selectedDeviceName;
-    int selectedIndex = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
-    if (selectedIndex != -1 && selectedIndex < (int)g_currentDevices.size()) {
-        selectedDeviceName = g_currentDevices[selectedIndex].name;
+    // 只在待处理操作从无到有时通知 UI 线程，多次更新合并为一次重绘
+    bool notify;
+    {
+        lock_guard<mutex> lock(g_deviceTableMutex);
+        bool idle = g_pendingDeviceOps.empty();
+        bool changed = g_deviceTable.Apply(snapshot, g_pendingDeviceOps) > 0;
+        if (changed) g_deviceRows.Publish(g_deviceTable.Rows());
+        notify = changed && idle;
+    }
+    if (notify) PostMessage(g_hwndMain, WM_DEVICES_CHANGED, 0, 0);
+}
+
+// 把累积的差量应用到设备列表：更新行数，只重绘变化的行，删除行后保持原设备的选中状态（仅在 UI 线程调用）
+void ApplyDeviceListChanges() {
+    vector<DeviceDiffEntry> ops;
+    size_t count;
+    {
+        lock_guard<mutex> lock(g_deviceTableMutex);
+        ops.swap(g_pendingDeviceOps);
+        count = g_deviceTable.Count();
+        // 差量与快照在同一把锁下发布，这里取到的快照正好对应取走的差量
+        if (!ops.empty()) g_listedRows = g_deviceRows.Load();
     }
+    if (ops.empty()) return;
     
-    ListView_DeleteAllItems(g_hwndDeviceList);
+    int selected = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
+    bool shifted = false;
+    for (const auto& op : ops) {
+        if (op.op != DeviceDiffOp::Remove) continue;
+        shifted = true;
+        if (selected == (int)op.index) selected = -1;
+        else if (selected > (int)op.index) selected--;
+    }
     
-    int newSelectedIndex = -1;
-    for (size_t i = 0; i < devices.size(); i++) {
-        const auto& device = devices[i];
-        bool shouldMonitor = !monitorDevices.empty() && MatchAnySubstring(device.name, monitorDevices);
-        
-        LVITEM lvi = {};
-        lvi.mask = LVIF_TEXT;
-        lvi.iItem = (int)i;
-        lvi.iSubItem = 0;
-        lvi.pszText = (LPWSTR)device.name.c_str();
-        ListView_InsertItem(g_hwndDeviceList, &lvi);
-        
-        wstring addr = BluetoothAddressToString(device.address);
-        ListView_SetItemText(g_hwndDeviceList, (int)i, 1, (LPWSTR)addr.c_str());
-        
-        const wchar_t* status = device.connected ? L"已连接" : L"未连接";
-        ListView_SetItemText(g_hwndDeviceList, (int)i, 2, (LPWSTR)status);
-        
-        const wchar_t* monitor = shouldMonitor ? L"是" : L"否";
-        ListView_SetItemText(g_hwndDeviceList, (int)i, 3, (LPWSTR)monitor);
-        
-        // 记录之前选中的设备的新位置
-        if (!selectedDeviceName.empty() && device.name == selectedDeviceName) {
-            newSelectedIndex = (int)i;
+    ListView_SetItemCountEx(g_hwndDeviceList, (int)count, LVSICF_NOSCROLL | LVSICF_NOINVALIDATEALL);
+    if (shifted) {
+        ListView_SetItemState(g_hwndDeviceList, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+        if (selected != -1) {
+            ListView_SetItemState(g_hwndDeviceList, selected, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
+        }
+        InvalidateRect(g_hwndDeviceList, NULL, FALSE);
+    } else {
+        for (const auto& op : ops) {
+            if (op.index < count) ListView_RedrawItems(g_hwndDeviceList, (int)op.index, (int)op.index);
         }
     }
-    
-    // 恢复选中状态
-    if (newSelectedIndex != -1) {
-        ListView_SetItemState(g_hwndDeviceList, newSelectedIndex, LVIS_SELECTED | LVIS_FOCUSED, LVIS_SELECTED | LVIS_FOCUSED);
-        ListView_EnsureVisible(g_hwndDeviceList, newSelectedIndex, FALSE);
+}
+
+// 设备列表的 LVN_GETDISPINFO：按列格式化第 iItem 行（仅在 UI 线程调用）
+void GetDeviceDispInfo(NMLVDISPINFO* info) {
+    if (!(info->item.mask & LVIF_TEXT) || info->item.cchTextMax <= 0) return;
+    wstring text;
+    if (g_listedRows && info->item.iItem >= 0 && (size_t)info->item.iItem < g_listedRows->value.size()) {
+        const DeviceRow& row = g_listedRows->value[info->item.iItem];
+        switch (info->item.iSubItem) {
+        case 0: text = row.name; break;
+        case 1: text = BtAddrToString(row.address); break;
+        case 2: text = row.connected ? L"已连接" : L"未连接"; break;
+        case 3: text = row.monitored ? L"是" : L"否"; break;
+        }
+    }
+    size_t length = min(text.size(), (size_t)info->item.cchTextMax - 1);
+    wmemcpy(info->item.pszText, text.c_str(), length);
+    info->item.pszText[length] = L'\0';
+}
+
+// 读取设备列表第 index 行对应的设备，即界面上显示的那一行（仅在 UI 线程调用）
+bool GetListedDevice(int index, BluetoothDeviceInfo& device) {
+    if (!g_listedRows || index < 0 || (size_t)index >= g_listedRows->value.size()) return false;
+    const DeviceRow& row = g_listedRows->value[index];
+    device.address = ToBluetoothAddress(row.address);
+    device.name = row.name;
+    device.connected = row.connected;
+    device.radio = row.radio;
+    return true;
+}
+
+// 带扫描的设备刷新：并发的刷新请求共享同一次扫描结果
+SingleFlight<vector<BluetoothDeviceInfo>> g_refreshFlight;
+// 界面触发的连接、断开、刷新在固定的工作线程中执行，排队的刷新请求合并为一次
+ActionExecutor g_actions(2, 16);
+const char REFRESH_ACTION[] = "refresh";
+const char RELOAD_ACTION[] = "reload";
+
+// 扫描并刷新设备列表（在工作线程中调用），只用于菜单中的“刷新设备列表”
+void RefreshDeviceList() {
+    vector<BluetoothDeviceInfo> devices = g_refreshFlight.Do([] { return GetPairedDevicesWithInquiry(true); });
+    UpdateDeviceList(devices);
+}
+
+// 不扫描、只枚举已配对设备刷新设备列表（在工作线程中调用）：手动连接/断开、修改监控列表后
+// 只需要读回连接状态与监控标记，不必占用数秒的主动扫描
+void ReloadDeviceList() {
+    UpdateDeviceList(GetPairedDevicesWithInquiry(false));
+}
+
+// 投递界面操作，队列已满时提示
+void PostAction(ActionExecutor::Task task, const string& coalesceKey = string()) {
+    if (!g_actions.Post(task, coalesceKey)) {
+        AddLog(L"操作过多，请稍后再试");
     }
 }
 
+// 输出界面操作执行器统计
+void LogActionStats() {
+    ActionExecutorStats stats = g_actions.Stats();
+    AddLog(L"[统计] 界面操作：执行 " + to_wstring(stats.executed) + L"，排队 " + to_wstring(stats.depth) +
+        L"（峰值 " + to_wstring(stats.maxDepth) + L"），合并 " + to_wstring(stats.coalesced) + L"，拒绝 " +
+        to_wstring(stats.rejected) + L"；设备扫描 " + to_wstring(g_refreshFlight.Calls()) + L" 次，共享扫描结果 " +
+        to_wstring(g_refreshFlight.Coalesced()) + L" 次");
+}
+
+// 异常的 what()（本地代码页）转成日志文本，为空（非 std::exception）时显示“未知异常”
+wstring ExceptionText(const string& what) {
+    if (what.empty()) return L"未知异常";
+    int length = MultiByteToWideChar(CP_ACP, 0, what.c_str(), (int)what.size(), NULL, 0);
+    if (length <= 0) return L"未知异常";
+    wstring text(length, L'\0');
+    MultiByteToWideChar(CP_ACP, 0, what.c_str(), (int)what.size(), &text[0], length);
+    return text;
+}
+
+// 监控循环因异常结束（在 g_monitor 的线程中调用）：记录日志，监控按已停止处理
+void OnMonitorFailure(const string& what) {
+    AddLog(L"监控循环异常退出: " + ExceptionText(what));
+}
+
+// 输出监控线程启停统计
+void LogSupervisorStats() {
+    SupervisorStats stats = g_monitor.Stats();
+    wstring failures;
+    if (stats.failures > 0) {
+        failures = L"，异常退出 " + to_wstring(stats.failures) + L" 次（最近: " + ExceptionText(stats.lastFailure) + L"）";
+    }
+    AddLog(L"[统计] 监控线程：运行 " + to_wstring(stats.runs) + L" 次，重启 " + to_wstring(stats.restarts) +
+        L" 次，重启耗时 平均 " + to_wstring(stats.AvgRestartUs() / 1000) + L" ms、最近 " +
+        to_wstring(stats.lastRestartUs / 1000) + L" ms、最大 " + to_wstring(stats.maxRestartUs / 1000) + L" ms" + failures);
+}
+
 // 显示设备右键菜单
 void ShowDeviceContextMenu(HWND hwnd) {
     int selectedIndex = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
     if (selectedIndex == -1) return;
     
-    if (selectedIndex >= (int)g_currentDevices.size()) return;
-    
-    const auto& device = g_currentDevices[selectedIndex];
-    bool isMonitored = !g_monitorDevices.empty() && g_monitorDevices.count(device.name) > 0;
+    BluetoothDeviceInfo device;
+    if (!GetListedDevice(selectedIndex, device)) return;
+    auto monitorDevices = g_monitorDevices.Load();
+    bool isMonitored = !monitorDevices->value.empty() && monitorDevices->value.count(device.name) > 0;
     
     POINT pt;
     GetCursorPos(&pt);
@@ -510,7 +525,7 @@ void ShowDeviceContextMenu(HWND hwnd) {
     
     AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
     
-    if (isMonitored && !g_monitorDevices.empty()) {
+    if (isMonitored && !monitorDevices->value.empty()) {
         AppendMenu(hMenu, MF_STRING, ID_DEVICE_REMOVE_MONITOR, L"从监控列表移除");
     } else {
         AppendMenu(hMenu, MF_STRING, ID_DEVICE_ADD_MONITOR, L"添加到监控列表");
@@ -527,19 +542,126 @@ void ShowDeviceContextMenu(HWND hwnd) {
     DestroyMenu(hMenu);
 }
 
-// 监控线程
-void MonitorThread() {
+// 配对列表中设备的出现、消失、改名与换适配器（连接/断开由监控核心按被监控设备记录）
+void LogDeviceChange(const DeviceChange& change) {
+    wstring suffix = *change.name + L" [" + BtAddrToString(change.address) + L"]";
+    switch (change.type) {
+    case DeviceChangeType::Appeared:
+        AddLog(L"[设备] 新配对: " + suffix);
+        break;
+    case DeviceChangeType::Vanished:
+        AddLog(L"[设备] 已取消配对: " + suffix);
+        break;
+    case DeviceChangeType::Renamed:
+        AddLog(L"[设备] 名称已更新: " + suffix);
+        break;
+    case DeviceChangeType::RadioChanged:
+        AddLog(L"[设备] 改由适配器 #" + to_wstring(change.radio) + L" 报告: " + suffix);
+        break;
+    default:
+        break;
+    }
+}
+
+// GUI 的监控回调：日志写入日志框，配对列表变化与状态变化刷新设备列表，停止/重启通过 stop 标记生效
+class GuiMonitorHost : public IMonitorHost, public IDeviceFeedSubscriber {
+public:
+    GuiMonitorHost(PresenceEngine& presence, const CancelToken& stop)
+        : presence_(presence), stop_(stop) {}
+
+    void Log(const wstring& line) override {
+        AddLog(line);
+    }
+
+    uint64_t NoteReaction(const PresenceEvent& ev) override {
+        return presence_.NoteReaction(ev);
+    }
+
+    // 事件源失效通常意味着适配器被移除，丢弃共享句柄以便重新打开
+    void OnEventSourceLost() override {
+        g_radios.Invalidate();
+    }
+
+    // 配对列表有变化时才刷新设备列表；已取消配对的设备不再保留服务缓存，启动后第一次枚举之外记录变化
+    void OnDeviceChanges(const vector<DeviceChange>& changes, const DeviceFeed& feed) override {
+        for (const auto& change : changes) {
+            if (change.type == DeviceChangeType::Vanished) g_serviceCache.Invalidate(change.address);
+            if (feed.Stats().applies > 1) LogDeviceChange(change);
+        }
+
+        const DeviceStore& devices = feed.Devices();
+        rows_.clear();
+        rows_.reserve(devices.Size());
+        for (size_t i = 0; i < devices.Size(); i++) {
+            BluetoothDeviceInfo info;
+            info.address = ToBluetoothAddress(devices.Address(i));
+            info.name = devices.Name(i);
+            info.connected = devices.Flag(i, DeviceFlag::Connected);
+            info.radio = devices.Radio(i);
+            rows_.push_back(info);
+        }
+        UpdateDeviceList(rows_);
+    }
+
+    // 本轮没有枚举：沿用上次变化流中的设备行，被监控设备的连接状态取自注册表（事件与重连结果只更新注册表）
+    void OnStateChanged() override {
+        {
+            lock_guard<mutex> lock(g_registryMutex);
+            for (auto& row : rows_) {
+                const DeviceRecord* record = g_deviceRegistry.Find(ToBtAddr(row.address));
+                if (record && record->monitored) row.connected = record->connected;
+            }
+        }
+        UpdateDeviceList(rows_);
+    }
+
+    void OnReport() override {
+        LogServiceCacheStats();
+        LogRadioStats();
+        LogConnectTimingStats();
+        LogLinkWaitStats();
+        LogActionStats();
+        LogSupervisorStats();
+    }
+
+    void OnArrivalsLearned() override {
+        SaveArrivalHistory();
+    }
+
+    bool StopRequested() override {
+        return stop_.IsCancelled();
+    }
+
+private:
+    PresenceEngine& presence_;
+    CancelToken stop_;
+    vector<BluetoothDeviceInfo> rows_;      // 设备列表的当前内容，只在监控线程中访问
+};
+
+// 监控列表为空时从配置文件读取（仅在 UI 线程调用，g_monitorDevices 只由 UI 线程发布）
+void LoadMonitorDevicesIfEmpty() {
+    if (g_monitorDevices.Load()->value.empty()) {
+        g_monitorDevices.Publish(LoadConfig(L"config.txt"));
+    }
+}
+
+// 监控循环（在 g_monitor 的线程中运行），stop 取消后尽快返回
+void MonitorThread(const CancelToken& stop) {
     AddLog(L"========================================");
     AddLog(L"蓝牙设备自动连接程序已启动");
     AddLog(L"========================================");
     
-    // 使用全局配置，如果为空则从文件加载
-    if (g_monitorDevices.empty()) {
-        g_monitorDevices = LoadConfig(L"config.txt");
-    }
-    set<wstring> monitorDevices = g_monitorDevices;
+    // 使用 UI 线程启动/重启前发布的监控列表；循环只读取，不写回（重启后的循环不会读到旧循环写回的列表）
+    auto monitorSnapshot = g_monitorDevices.Load();
+    const set<wstring>& monitorDevices = monitorSnapshot->value;
+    MonitorSettings settings = LoadSettings(L"settings.txt");
+    LoadServiceRanking();
+    LoadArrivalHistory();
+    g_linkWaiter.SetDeadlineMs(settings.linkDeadlineMs);
+    g_connectDeadlineMs = settings.connectDeadlineMs;
     
 vector<BluetoothDeviceInfo> pairedDevices = GetPairedDevicesWithInquiry(true);
+    if (stop.IsCancelled()) return;
     
     if (pairedDevices.empty()) {
         AddLog(L"未找到已配对的蓝牙设备");
@@ -549,116 +671,97 @@ vector<BluetoothDeviceInfo> pairedDevices = GetPairedDevicesWithInquiry(true);
 
     AddLog(L"找到 " + to_wstring(pairedDevices.size()) + L" 个已配对的设备");
     
-    vector<BluetoothDeviceInfo> devicesToMonitor;
+    // 全部已配对设备登记到注册表；注册表跨监控启停保留（手动断开阻止不会因重启监控而丢失）
+    unique_lock<mutex> registryLock(g_registryMutex);
+    for (auto& record : g_deviceRegistry) record.monitored = false;
+    size_t monitoredCount = 0;
     for (const auto& device : pairedDevices) {
         // 只监控配置文件中明确指定的设备（子串匹配）
         bool shouldMonitor = !monitorDevices.empty() && MatchAnySubstring(device.name, monitorDevices);
         
         wstring msg = L"  - " + device.name + L" [" + BluetoothAddressToString(device.address) + L"]";
         msg += device.connected ? L" (已连接)" : L" (未连接)";
+        DeviceRecord& record = g_deviceRegistry.Upsert(ToBtAddr(device.address));
+        record.name = device.name;
+        record.connected = device.connected;
+        record.radio = device.radio;
+        record.monitored = shouldMonitor;
         if (shouldMonitor) {
             msg += L" [监控中]";
-            devicesToMonitor.push_back(device);
+            monitoredCount++;
         }
         AddLog(msg);
     }
     
-    if (devicesToMonitor.empty()) {
+    if (monitoredCount == 0) {
+        registryLock.unlock();
         AddLog(L"没有需要监控的设备");
         AddLog(L"请右键点击设备列表中的设备，选择\"添加到监控列表\"");
-        UpdateDeviceList(pairedDevices, monitorDevices);
+        UpdateDeviceList(pairedDevices);
         return;
     }
     
-    UpdateDeviceList(pairedDevices, monitorDevices);
+    UpdateDeviceList(pairedDevices);
     
     AddLog(L"开始监听设备状态...");
-    
-    vector<bool> lastConnectedState(devicesToMonitor.size(), false);
-    for (size_t i = 0; i < devicesToMonitor.size(); i++) {
-        lastConnectedState[i] = devicesToMonitor[i].connected;
+
+    // 在场检测：优先由系统蓝牙事件唤醒，事件不可用时回退为 5 秒轮询；停止时直接唤醒等待
+    PresenceEngine presence;
+    WinPresenceSource winSource(&g_radios);
+    presence.AddSource(&winSource);
+    bool eventDriven = presence.Start();
+    if (eventDriven) {
+        AddLog(L"已启用蓝牙事件通知，设备上下线将被即时处理");
+    } else {
+        AddLog(L"蓝牙事件通知不可用，使用定时轮询");
     }
 
-    int checkCount = 0;
-    int scanCount = 0;
-    
-    while (g_bRunning) {
-        checkCount++;
-        
-        // 每 3 次检查做一次主动扫描
-        bool doInquiry = (checkCount % 3) == 0;
-        if (doInquiry) {
-            scanCount++;
-            AddLog(L"[" + to_wstring(checkCount) + L"] 执行主动扫描 #" + to_wstring(scanCount) + L"...");
-        }
-        
-        vector<BluetoothDeviceInfo> currentDevices = GetPairedDevicesWithInquiry(doInquiry);
-        UpdateDeviceList(currentDevices, monitorDevices);
-        
-        for (size_t i = 0; i < devicesToMonitor.size(); i++) {
-            if (!g_bRunning) break;
-            
-            const auto& pairedDevice = devicesToMonitor[i];
-            bool currentlyConnected = false;
-            bool deviceFound = false;
-            
-            for (const auto& current : currentDevices) {
-                if (memcmp(&current.address, &pairedDevice.address, sizeof(BLUETOOTH_ADDRESS)) == 0) {
-                    currentlyConnected = current.connected;
-                    deviceFound = true;
-                    break;
-                }
-            }
-            
-            if (!deviceFound) {
-                continue;
-            }
-            
-            if (currentlyConnected && !lastConnectedState[i]) {
-                AddLog(L"[" + to_wstring(checkCount) + L"] ✅ 设备已连接: " + pairedDevice.name);
-                lastConnectedState[i] = true;
-            }
-            else if (!currentlyConnected && lastConnectedState[i]) {
-                // 二次确认，避免误判
-                BLUETOOTH_DEVICE_INFO di = {0};
-                di.dwSize = sizeof(BLUETOOTH_DEVICE_INFO);
-                di.Address = pairedDevice.address;
-                DWORD rchk = BluetoothGetDeviceInfo(NULL, &di);
-                if (rchk == ERROR_SUCCESS && di.fConnected) {
-                    // 仍然连接，跳过
-                } else {
-                    AddLog(L"[" + to_wstring(checkCount) + L"] ❌ 设备已断开: " + pairedDevice.name);
-                    lastConnectedState[i] = false;
-                }
-            }
-            else if (!currentlyConnected && doInquiry) {
-                AddLog(L"[" + to_wstring(checkCount) + L"] 🔍 发现设备未连接，尝试连接: " + pairedDevice.name);
-                // 自动重连前检查：是否被手动断开阻止，以及是否处于冷却期
-                wstring mac = BluetoothAddressToString(pairedDevice.address);
-                if (g_blockAutoReconnect.count(mac) > 0) {
-                    AddLog(L"  ⏸ 用户手动断开，跳过自动重连: " + pairedDevice.name);
-                    continue;
-                }
-                auto now = chrono::steady_clock::now();
-                auto it = g_lastConnectAttempt.find(mac);
-                if (it != g_lastConnectAttempt.end()) {
-                    auto elapsed = chrono::duration_cast<chrono::milliseconds>(now - it->second).count();
-                    if (elapsed < CONNECT_COOLDOWN_MS) {
-                        AddLog(L"  ⏱ 冷却中，跳过本次重连: " + pairedDevice.name);
-                        continue;
-                    }
-                }
-                g_lastConnectAttempt[mac] = now;
-                if (ConnectDevice(pairedDevice.address, pairedDevice.name)) {
-                    lastConnectedState[i] = true;
-                }
-            }
-        }
-        
-        for (int i = 0; i < 10 && g_bRunning; i++) {
-            this_thread::sleep_for(chrono::milliseconds(500));
-        }
+    // 重连任务交给工作池并发执行，每个无线电限制同时进行的数量；
+    // 完成后唤醒监控循环取回结果
+    WinBluetoothBackend backend;
+    ReconnectPool reconnectPool(settings.reconnectWorkers, settings.reconnectPerRadio);
+    reconnectPool.SetCompletionNotifier([&presence]() { presence.Interrupt(); });
+
+    // 主动扫描在独立线程中进行，扫描期间断开检测与重连照常处理；完成后唤醒监控循环取回结果
+    InquiryWorker inquiry(backend);
+    inquiry.SetCompletionNotifier([&presence]() { presence.Interrupt(); });
+
+    // 监控核心：轮询、主动扫描和每台离线设备的重连探测都按调度器的截止时间触发；
+    // 只在访问注册表期间持有 g_registryMutex，枚举/扫描与刷新列表时释放
+    SteadyClock clock;
+    GuiMonitorHost host(presence, stop);
+    MonitorCore core(clock, g_deviceRegistry, backend, reconnectPool, host);
+    core.Feed().Subscribe(&host);
+    core.SetRegistryMutex(&g_registryMutex);
+    core.SetMetrics(&g_metrics);
+    core.SetInquiryStage(&inquiry);
+    core.SetInquiryBudget(settings.inquiryBudgetMsPerMin);
+    core.SetConnectDeadlineMs(settings.connectDeadlineMs);
+    core.SetCancelToken(stop);
+    core.SetArrivalPredictor(&g_arrivalPredictor, LocalDayOffsetMs(clock));
+    core.Start(eventDriven);
+    registryLock.unlock();
+
+    // 只在下一个截止时间、在场事件、后台任务完成、停止或 WakeMonitor 时醒来
+    CancelCallback wakeOnStop(stop, [&presence]() { presence.Interrupt(); });
+    {
+        lock_guard<mutex> lock(g_monitorPresenceMutex);
+        g_monitorPresence = &presence;
+    }
+    vector<PresenceEvent> events;
+    while (!stop.IsCancelled()) {
+        PresenceWake wake = presence.WaitFor(events, core.MsUntilNext());
+        if (wake == PresenceWake::Stopped || stop.IsCancelled()) break;
+        core.Step(events, presence.IsEventDriven());
+    }
+    {
+        lock_guard<mutex> lock(g_monitorPresenceMutex);
+        g_monitorPresence = nullptr;
     }
+
+    inquiry.Shutdown();
+    reconnectPool.Shutdown();
+    presence.Stop();
     
     AddLog(L"监控已停止");
 }
@@ -697,10 +800,13 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
     case WM_CREATE:
     {
+        // 监控线程在 CreateWindowEx 返回前就会启动并向主窗口投递消息
+        g_hwndMain = hwnd;
+        
         // 创建设备列表
         g_hwndDeviceList = CreateWindowEx(
             0, WC_LISTVIEW, L"",
-            WS_CHILD | WS_VISIBLE | WS_BORDER | LVS_REPORT | LVS_SINGLESEL,
+            WS_CHILD | WS_VISIBLE | WS_BORDER | LVS_REPORT | LVS_SINGLESEL | LVS_OWNERDATA | LVS_SHOWSELALWAYS,
             10, 10, 760, 200,
             hwnd, (HMENU)ID_DEVICE_LIST, g_hInst, NULL
         );
@@ -727,14 +833,19 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         
         ListView_SetExtendedListViewStyle(g_hwndDeviceList, LVS_EX_FULLROWSELECT | LVS_EX_GRIDLINES);
         
-        // 创建日志编辑框
+        // 创建日志框：虚拟列表，只绘制可见行
         g_hwndLog = CreateWindowEx(
-            WS_EX_CLIENTEDGE, L"EDIT", L"",
-            WS_CHILD | WS_VISIBLE | WS_VSCROLL | ES_MULTILINE | ES_AUTOVSCROLL | ES_READONLY,
+            WS_EX_CLIENTEDGE, WC_LISTVIEW, L"",
+            WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_OWNERDATA | LVS_NOCOLUMNHEADER,
             10, 250, 760, 280,
-            hwnd, (HMENU)ID_LOG_EDIT, g_hInst, NULL
+            hwnd, (HMENU)ID_LOG_LIST, g_hInst, NULL
         );
         
+        lvc.pszText = (LPWSTR)L"日志";
+        lvc.cx = 735;
+        ListView_InsertColumn(g_hwndLog, 0, &lvc);
+        ListView_SetExtendedListViewStyle(g_hwndLog, LVS_EX_FULLROWSELECT | LVS_EX_DOUBLEBUFFER);
+        
         // 创建按钮
         CreateWindow(
             L"BUTTON", L"开始监控",
@@ -757,6 +868,16 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             hwnd, (HMENU)ID_BTN_CLEAR, g_hInst, NULL
         );
         
+        CreateWindow(
+            L"BUTTON", L"运行统计",
+            WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+            340, 540, 100, 30,
+            hwnd, (HMENU)ID_BTN_METRICS, g_hInst, NULL
+        );
+        
+        // 定时把日志缓冲区刷新到日志框
+        SetTimer(hwnd, ID_TIMER_LOG, LOG_DRAIN_MS, NULL);
+        
         // 创建托盘图标
         CreateTrayIcon(hwnd);
         
@@ -770,8 +891,8 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         testFile.close();
         
         // 自动开始监控
-        g_bRunning = true;
-        g_pMonitorThread = new thread(MonitorThread);
+        LoadMonitorDevicesIfEmpty();
+        g_monitor.Start();
         
         break;
     }
@@ -779,36 +900,29 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     case WM_COMMAND:
         switch (LOWORD(wParam)) {
         case ID_BTN_START:
-            if (!g_bRunning) {
-                g_bRunning = true;
-                g_pMonitorThread = new thread(MonitorThread);
+            if (!g_monitor.IsRunning()) {
+                LoadMonitorDevicesIfEmpty();
+                g_monitor.Start();
                 AddLog(L"监控已启动");
             }
             break;
             
         case ID_BTN_STOP:
-            if (g_bRunning) {
-                g_bRunning = false;
+            // 只取消当前循环，循环结束时记录"监控已停止"
+            if (g_monitor.IsRunning()) {
+                g_monitor.Stop();
                 AddLog(L"正在停止监控...");
-                
-                // 异步等待线程结束
-                if (g_pMonitorThread) {
-                    thread cleanup_thread([](thread* pThread) {
-                        if (pThread && pThread->joinable()) {
-                            pThread->join();
-                            delete pThread;
-                        }
-                    }, g_pMonitorThread);
-                    cleanup_thread.detach();
-                    g_pMonitorThread = nullptr;
-                }
-                
-                AddLog(L"监控已停止");
             }
             break;
             
         case ID_BTN_CLEAR:
-            SetWindowText(g_hwndLog, L"");
+            ClearLogView();
+            break;
+            
+        case ID_BTN_METRICS:
+            DumpMetrics();
+            LogActionStats();
+            LogSupervisorStats();
             break;
             
         case ID_TRAY_SHOW:
@@ -827,17 +941,16 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         case ID_DEVICE_CONNECT:
         {
             int selectedIndex = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
-            if (selectedIndex != -1 && selectedIndex < (int)g_currentDevices.size()) {
-                const auto& device = g_currentDevices[selectedIndex];
-                thread([device]() {
+            BluetoothDeviceInfo device;
+            if (GetListedDevice(selectedIndex, device)) {
+                PostAction([device]() {
                     // 手动连接前，取消自动重连阻止
-                    wstring mac = BluetoothAddressToString(device.address);
-                    g_blockAutoReconnect.erase(mac);
-                    ConnectDevice(device.address, device.name);
-                    Sleep(1000);
-vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
-                    UpdateDeviceList(devices, g_monitorDevices);
-                }).detach();
+                    SetAutoReconnectBlocked(device.address, false);
+                    // ConnectDevice 已等到链路建立（或超时），直接刷新
+                    OperationContext op(g_linkClock, g_appCancel.Token(), g_connectDeadlineMs);
+                    ConnectDevice(device.address, device.name, device.radio, op);
+                    ReloadDeviceList();
+                });
             }
             break;
         }
@@ -845,14 +958,14 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
         case ID_DEVICE_DISCONNECT:
         {
             int selectedIndex = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
-            if (selectedIndex != -1 && selectedIndex < (int)g_currentDevices.size()) {
-                const auto& device = g_currentDevices[selectedIndex];
-                thread([device]() {
-                    DisconnectDevice(device.address, device.name);
-                    Sleep(1000);
-vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
-                    UpdateDeviceList(devices, g_monitorDevices);
-                }).detach();
+            BluetoothDeviceInfo device;
+            if (GetListedDevice(selectedIndex, device)) {
+                PostAction([device]() {
+                    OperationContext op(g_linkClock, g_appCancel.Token(), g_connectDeadlineMs);
+                    DisconnectDevice(device.address, device.name, device.radio, op);
+                    op.Wait(1000);
+                    ReloadDeviceList();
+                });
             }
             break;
         }
@@ -860,8 +973,8 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
         case ID_DEVICE_COPY_NAME:
         {
             int selectedIndex = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
-            if (selectedIndex != -1 && selectedIndex < (int)g_currentDevices.size()) {
-                const auto& device = g_currentDevices[selectedIndex];
+            BluetoothDeviceInfo device;
+            if (GetListedDevice(selectedIndex, device)) {
                 if (OpenClipboard(hwnd)) {
                     EmptyClipboard();
                     size_t size = (device.name.length() + 1) * sizeof(wchar_t);
@@ -881,8 +994,8 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
         case ID_DEVICE_COPY_MAC:
         {
             int selectedIndex = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
-            if (selectedIndex != -1 && selectedIndex < (int)g_currentDevices.size()) {
-                const auto& device = g_currentDevices[selectedIndex];
+            BluetoothDeviceInfo device;
+            if (GetListedDevice(selectedIndex, device)) {
                 wstring macAddr = BluetoothAddressToString(device.address);
                 if (OpenClipboard(hwnd)) {
                     EmptyClipboard();
@@ -903,54 +1016,33 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
         case ID_DEVICE_REFRESH:
         {
             AddLog(L"正在刷新设备列表...");
-vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
-            UpdateDeviceList(devices, g_monitorDevices);
-            AddLog(L"设备列表已刷新");
+            PostAction([]() {
+                RefreshDeviceList();
+                AddLog(L"设备列表已刷新");
+            }, REFRESH_ACTION);
             break;
         }
         
         case ID_DEVICE_ADD_MONITOR:
         {
             int selectedIndex = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
-            if (selectedIndex != -1 && selectedIndex < (int)g_currentDevices.size()) {
-                const auto& device = g_currentDevices[selectedIndex];
+            BluetoothDeviceInfo device;
+            if (GetListedDevice(selectedIndex, device)) {
                 
                 // 重新加载配置
-                g_monitorDevices = LoadConfig(L"config.txt");
-                g_monitorDevices.insert(device.name);
+                set<wstring> monitorDevices = LoadConfig(L"config.txt");
+                monitorDevices.insert(device.name);
+                g_monitorDevices.Publish(monitorDevices);
                 
-                if (SaveConfig(L"config.txt", g_monitorDevices)) {
+                if (SaveConfig(L"config.txt", monitorDevices)) {
                     AddLog(L"已添加到监控列表: " + device.name);
                     
-                    // 重启监控线程以应用更改
-                    if (g_bRunning && g_pMonitorThread) {
-                        g_bRunning = false;
-                        AddLog(L"正在重启监控...");
-                        
-                        thread* oldThread = g_pMonitorThread;
-                        g_pMonitorThread = nullptr;
-                        
-                        // 异步清理旧线程
-                        thread([oldThread, hwnd]() {
-                            if (oldThread && oldThread->joinable()) {
-                                oldThread->join();
-                            }
-                            delete oldThread;
-                            
-                            // 启动新线程
-                            Sleep(500);
-                            g_bRunning = true;
-                            g_pMonitorThread = new thread(MonitorThread);
-                        }).detach();
-                    } else if (!g_bRunning) {
-                        // 如果监控未运行，启动它
-                        g_bRunning = true;
-                        g_pMonitorThread = new thread(MonitorThread);
-                    }
+                    // 重新启动监控循环以应用更改（当前循环返回后立即启动；未运行时直接启动）
+                    if (g_monitor.IsRunning()) AddLog(L"正在重启监控...");
+                    g_monitor.Restart();
                     
                     // 更新显示
-vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
-                    UpdateDeviceList(devices, g_monitorDevices);
+                    PostAction(ReloadDeviceList, RELOAD_ACTION);
                 } else {
                     AddLog(L"添加失败: 无法保存配置文件");
                 }
@@ -961,43 +1053,30 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
         case ID_DEVICE_REMOVE_MONITOR:
         {
             int selectedIndex = ListView_GetNextItem(g_hwndDeviceList, -1, LVNI_SELECTED);
-            if (selectedIndex != -1 && selectedIndex < (int)g_currentDevices.size()) {
-                const auto& device = g_currentDevices[selectedIndex];
+            BluetoothDeviceInfo device;
+            if (GetListedDevice(selectedIndex, device)) {
                 
                 // 重新加载配置
-                g_monitorDevices = LoadConfig(L"config.txt");
-                g_monitorDevices.erase(device.name);
+                set<wstring> monitorDevices = LoadConfig(L"config.txt");
+                monitorDevices.erase(device.name);
+                g_monitorDevices.Publish(monitorDevices);
                 
-                if (SaveConfig(L"config.txt", g_monitorDevices)) {
+                if (SaveConfig(L"config.txt", monitorDevices)) {
                     AddLog(L"已从监控列表移除: " + device.name);
                     
-                    // 重启监控线程以应用更改
-                    if (g_bRunning && g_pMonitorThread) {
-                        g_bRunning = false;
-                        AddLog(L"正在重启监控...");
-                        
-                        thread* oldThread = g_pMonitorThread;
-                        g_pMonitorThread = nullptr;
-                        
-                        // 异步清理旧线程
-                        thread([oldThread, hwnd]() {
-                            if (oldThread && oldThread->joinable()) {
-                                oldThread->join();
-                            }
-                            delete oldThread;
-                            
-                            // 启动新线程（如果还有设备需要监控）
-                            Sleep(500);
-                            if (!g_monitorDevices.empty()) {
-                                g_bRunning = true;
-                                g_pMonitorThread = new thread(MonitorThread);
-                            }
-                        }).detach();
+                    // 正在监控时重新启动监控循环以应用更改，已没有要监控的设备时停止
+                    if (g_monitor.IsRunning()) {
+                        if (g_monitorDevices.Load()->value.empty()) {
+                            AddLog(L"正在停止监控...");
+                            g_monitor.Stop();
+                        } else {
+                            AddLog(L"正在重启监控...");
+                            g_monitor.Restart();
+                        }
                     }
                     
                     // 更新显示
-vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
-                    UpdateDeviceList(devices, g_monitorDevices);
+                    PostAction(ReloadDeviceList, RELOAD_ACTION);
                 } else {
                     AddLog(L"移除失败: 无法保存配置文件");
                 }
@@ -1012,6 +1091,10 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
         LPNMHDR pnmhdr = (LPNMHDR)lParam;
         if (pnmhdr->idFrom == ID_DEVICE_LIST && pnmhdr->code == NM_RCLICK) {
             ShowDeviceContextMenu(hwnd);
+        } else if (pnmhdr->idFrom == ID_DEVICE_LIST && pnmhdr->code == LVN_GETDISPINFO) {
+            GetDeviceDispInfo((NMLVDISPINFO*)lParam);
+        } else if (pnmhdr->idFrom == ID_LOG_LIST && pnmhdr->code == LVN_GETDISPINFO) {
+            GetLogDispInfo((NMLVDISPINFO*)lParam);
         }
         break;
     }
@@ -1026,6 +1109,16 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
         }
         break;
     
+    case WM_DEVICES_CHANGED:
+        ApplyDeviceListChanges();
+        break;
+    
+    case WM_TIMER:
+        if (wParam == ID_TIMER_LOG) {
+            DrainLog();
+        }
+        break;
+    
     case WM_SIZE:
         if (wParam == SIZE_MINIMIZED) {
             ShowWindow(hwnd, SW_HIDE);
@@ -1034,8 +1127,9 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
     
     case WM_CLOSE:
         if (MessageBox(hwnd, L"确定要退出程序吗？", L"确认", MB_YESNO | MB_ICONQUESTION) == IDYES) {
-            // 停止监控
-            g_bRunning = false;
+            // 停止监控，进行中的重连与手动连接/断开在下一次 API 调用前结束
+            g_monitor.Stop();
+            g_appCancel.Cancel();
             
             // 删除托盘图标
             Shell_NotifyIcon(NIM_DELETE, &g_nid);
@@ -1046,24 +1140,15 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
         break;
     
     case WM_DESTROY:
-        // 确保监控已停止
-        g_bRunning = false;
+        // 确保监控已停止（消息循环结束后再等待监控循环返回）
+        g_monitor.Stop();
+        g_appCancel.Cancel();
+        KillTimer(hwnd, ID_TIMER_LOG);
         
-        // 异步清理线程，不阻塞UI
-        if (g_pMonitorThread) {
-            thread* pThreadToClean = g_pMonitorThread;
-            g_pMonitorThread = nullptr;
-            
-            // 创建一个清理线程
-            thread([pThreadToClean]() {
-                if (pThreadToClean) {
-                    if (pThreadToClean->joinable()) {
-                        pThreadToClean->join();
-                    }
-                    delete pThreadToClean;
-                }
-            }).detach();
-        }
+        // 日志框中剩余的行写入磁盘日志；日志框随窗口销毁，之后的日志在 WinMain 中直接写入磁盘日志
+        DrainLog();
+        ClearLogView();
+        g_hwndLog = nullptr;
         
         PostQuitMessage(0);
         break;
@@ -1077,6 +1162,7 @@ vector<BluetoothDeviceInfo> devices = GetPairedDevicesWithInquiry(true);
 // 主函数
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow) {
     g_hInst = hInstance;
+    SetWinBluetoothLog(AddLog);
     
     // 初始化通用控件
     INITCOMMONCONTROLSEX icex = {};
@@ -1117,5 +1203,12 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow) {
         DispatchMessage(&msg);
     }
     
+    // 等待监控循环返回（WM_CLOSE/WM_DESTROY 已取消）与进行中的界面操作结束，之后再销毁全局对象
+    g_monitor.Shutdown();
+    g_actions.Shutdown();
+    
+    // 它们最后写入的日志（例如“监控已停止”）全部取出写入磁盘日志
+    DrainLog(SIZE_MAX);
+    ClearLogView();
     return (int)msg.wParam;
 }
@@ -0,0 +1,50 @@
+#pragma once
+
+// 跨平台基础类型：不依赖 Windows 头文件，供监控核心与模拟/基准程序共用
+
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <string>
+
+// 48 位蓝牙地址打包为整数（与 BLUETOOTH_ADDRESS::ullLong 的布局一致）
+typedef uint64_t BtAddr;
+
+const BtAddr BT_ADDR_MASK = 0x0000FFFFFFFFFFFFull;
+
+// 将打包地址格式化为 "AA:BB:CC:DD:EE:FF"
+inline std::wstring BtAddrToString(BtAddr addr) {
+    wchar_t buffer[18];
+    swprintf(buffer, 18, L"%02X:%02X:%02X:%02X:%02X:%02X",
+        (unsigned)((addr >> 40) & 0xFF), (unsigned)((addr >> 32) & 0xFF),
+        (unsigned)((addr >> 24) & 0xFF), (unsigned)((addr >> 16) & 0xFF),
+        (unsigned)((addr >> 8) & 0xFF), (unsigned)(addr & 0xFF));
+    return std::wstring(buffer);
+}
+
+// "AA:BB:CC:DD:EE:FF"
+inline bool ParseBtAddr(const std::wstring& text, BtAddr& out) {
+    unsigned b[6];
+    if (swscanf(text.c_str(), L"%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+        return false;
+    }
+    out = 0;
+    for (int i = 0; i < 6; i++) out = (out << 8) | (b[i] & 0xFF);
+    return true;
+}
+
+// 128 位服务 UUID，内存布局与 Windows GUID 一致
+struct BtUuid {
+    uint32_t data1;
+    uint16_t data2;
+    uint16_t data3;
+    uint8_t data4[8];
+};
+
+inline bool operator==(const BtUuid& a, const BtUuid& b) {
+    return std::memcmp(&a, &b, sizeof(BtUuid)) == 0;
+}
+
+inline bool operator!=(const BtUuid& a, const BtUuid& b) {
+    return !(a == b);
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+// 取消与截止时间：连接/断开等耗时操作接收 OperationContext，在每次蓝牙 API 调用之间 Check，
+// 需要等待时调用 Wait —— 在取消标记的条件变量上等待，取消后立即醒来，而不是 Sleep 到底。
+// CancelSource 由停止方持有（GUI 的停止按钮、退出），Token 交给操作；Reset 换成新的标记，
+// 之前发出的 Token 保持已取消。CancelCallback 在取消时唤醒标记以外的等待（例如 PresenceEngine::Interrupt）。
+// 截止时间来自 IClock，VirtualClock 上的等待只推进时间。线程安全。
+
+#include "Clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class OperationStatus : uint8_t {
+    Ok,
+    Cancelled,
+    TimedOut,
+};
+
+inline const wchar_t* OperationStatusName(OperationStatus status) {
+    switch (status) {
+    case OperationStatus::Cancelled: return L"已取消";
+    case OperationStatus::TimedOut: return L"超过截止时间";
+    default: return L"正常";
+    }
+}
+
+class CancelToken {
+public:
+    // 默认构造的标记永远不会被取消
+    CancelToken() = default;
+
+    bool IsCancelled() const { return state_ && state_->cancelled.load(std::memory_order_acquire); }
+
+    // 等待 ms 毫秒，期间被取消时立即返回；返回是否已取消
+    bool WaitFor(int64_t ms) const {
+        if (!state_) {
+            if (ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->cv.wait_for(lock, std::chrono::milliseconds(std::max<int64_t>(ms, 0)),
+            [this] { return state_->cancelled.load(std::memory_order_acquire); });
+        return state_->cancelled.load(std::memory_order_acquire);
+    }
+
+private:
+    friend class CancelSource;
+    friend class CancelCallback;
+
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::pair<uint64_t, std::function<void()>>> callbacks;
+        uint64_t nextCallback = 0;
+    };
+
+    explicit CancelToken(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<State> state_;
+};
+
+class CancelSource {
+public:
+    CancelSource() : state_(std::make_shared<CancelToken::State>()) {}
+
+    CancelSource(const CancelSource&) = delete;
+    CancelSource& operator=(const CancelSource&) = delete;
+
+    CancelToken Token() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return CancelToken(state_);
+    }
+
+    // 取消当前标记并唤醒所有等待中的操作
+    void Cancel() {
+        std::shared_ptr<CancelToken::State> state;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            state = state_;
+        }
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->cancelled.exchange(true, std::memory_order_acq_rel)) return;
+            for (auto& callback : state->callbacks) callback.second();
+        }
+        state->cv.notify_all();
+    }
+
+    bool IsCancelled() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_->cancelled.load(std::memory_order_acquire);
+    }
+
+    // 换成新的未取消标记（重新开始监控时），已发出的 Token 不受影响
+    void Reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_ = std::make_shared<CancelToken::State>();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<CancelToken::State> state_;
+};
+
+// 标记取消时调用 callback（在调用 Cancel 的线程中，持有标记的锁，不能再操作同一标记）；
+// 构造时已取消则立即调用。析构后不再调用，析构会等待正在进行的调用结束
+class CancelCallback {
+public:
+    CancelCallback(const CancelToken& token, std::function<void()> callback) : state_(token.state_) {
+        if (!state_) return;
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->cancelled.load(std::memory_order_acquire)) {
+            callback();
+            return;
+        }
+        id_ = ++state_->nextCallback;
+        state_->callbacks.emplace_back(id_, std::move(callback));
+    }
+
+    ~CancelCallback() {
+        if (!state_ || id_ == 0) return;
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        auto& callbacks = state_->callbacks;
+        for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+            if (it->first == id_) {
+                callbacks.erase(it);
+                break;
+            }
+        }
+    }
+
+    CancelCallback(const CancelCallback&) = delete;
+    CancelCallback& operator=(const CancelCallback&) = delete;
+
+private:
+    std::shared_ptr<CancelToken::State> state_;
+    uint64_t id_ = 0;
+};
+
+// 一次操作的取消标记与截止时间；子步骤用 Child 取更短的截止时间，取消标记相同
+class OperationContext {
+public:
+    OperationContext(IClock& clock, CancelToken token, int64_t timeoutMs)
+        : clock_(clock), token_(std::move(token)), deadlineMs_(clock.NowMs() + timeoutMs) {}
+
+    OperationContext Child(int64_t timeoutMs) const {
+        OperationContext child(clock_, token_, 0);
+        child.deadlineMs_ = std::min(deadlineMs_, clock_.NowMs() + timeoutMs);
+        return child;
+    }
+
+    // 取消优先于超时
+    OperationStatus Check() const {
+        if (token_.IsCancelled()) return OperationStatus::Cancelled;
+        if (clock_.NowMs() >= deadlineMs_) return OperationStatus::TimedOut;
+        return OperationStatus::Ok;
+    }
+
+    bool Ok() const { return Check() == OperationStatus::Ok; }
+
+    int64_t RemainingMs() const { return std::max<int64_t>(deadlineMs_ - clock_.NowMs(), 0); }
+    int64_t DeadlineMs() const { return deadlineMs_; }
+    IClock& Clock() const { return clock_; }
+    const CancelToken& Token() const { return token_; }
+
+    // 等待 ms 毫秒（不超过截止时间），取消时立即返回；返回等待后的状态
+    OperationStatus Wait(int64_t ms) {
+        ms = std::min(ms, RemainingMs());
+        if (clock_.IsVirtual()) clock_.SleepMs(ms);
+        else token_.WaitFor(ms);
+        return Check();
+    }
+
+private:
+    IClock& clock_;
+    CancelToken token_;
+    int64_t deadlineMs_;
+};
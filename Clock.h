@@ -0,0 +1,54 @@
+#pragma once
+
+// 时钟抽象：调度器只通过 IClock 读取时间，真实运行用 SteadyClock，
+// 模拟/基准使用可手动推进的 VirtualClock，使调度结果可确定地复现。
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+class IClock {
+public:
+    virtual ~IClock() {}
+    // 单调递增的毫秒时间
+    virtual int64_t NowMs() = 0;
+    virtual void SleepMs(int64_t ms) = 0;
+    // 时间只由 SleepMs/Advance 推进（可取消的等待在虚拟时钟上不阻塞）
+    virtual bool IsVirtual() const { return false; }
+};
+
+class SteadyClock : public IClock {
+public:
+    int64_t NowMs() override {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void SleepMs(int64_t ms) override {
+        if (ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+};
+
+// 虚拟时钟：时间只在 Advance/SleepMs 时前进
+class VirtualClock : public IClock {
+public:
+    explicit VirtualClock(int64_t startMs = 0) : now_(startMs) {}
+
+    int64_t NowMs() override { return now_.load(); }
+
+    void SleepMs(int64_t ms) override {
+        if (ms > 0) now_ += ms;
+    }
+
+    bool IsVirtual() const override { return true; }
+
+    void Advance(int64_t ms) {
+        if (ms > 0) now_ += ms;
+    }
+
+    void Set(int64_t ms) { now_ = ms; }
+
+private:
+    std::atomic<int64_t> now_;
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+// 设备列表差量：按地址比较上一次与本次的设备快照，只产生插入、更新、删除操作。
+// 行顺序稳定：已有设备保持原位置，新设备追加到末尾，删除的行之后的行依次前移。
+// GUI 用它驱动虚拟（owner-data）列表，只重绘变化的行；本身不加锁。
+
+#include "BtTypes.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct DeviceRow {
+    BtAddr address = 0;
+    std::wstring name;
+    bool connected = false;
+    bool monitored = false;
+    int radio = 0;      // 所属适配器
+};
+
+enum class DeviceDiffOp : uint8_t {
+    Insert,     // 在 index 处追加一行（index 等于插入前的行数）
+    Update,     // 第 index 行内容变化
+    Remove,     // 删除第 index 行，其后的行前移
+};
+
+struct DeviceDiffEntry {
+    DeviceDiffOp op;
+    size_t index;
+};
+
+class DeviceTable {
+public:
+    size_t Count() const { return rows_.size(); }
+    const DeviceRow& Row(size_t index) const { return rows_[index]; }
+    const std::vector<DeviceRow>& Rows() const { return rows_; }
+
+    // 地址所在的行，不存在时返回 -1
+    int IndexOf(BtAddr address) const {
+        auto it = index_.find(address & BT_ADDR_MASK);
+        return it == index_.end() ? -1 : (int)it->second;
+    }
+
+    // 用新快照更新表，按可依次执行的顺序把操作追加到 ops：
+    // 先按下标从大到小删除，再更新（删除后的下标），最后追加新设备。返回本次追加的操作数。
+    // 快照中重复的地址只取第一次出现。
+    size_t Apply(const std::vector<DeviceRow>& snapshot, std::vector<DeviceDiffEntry>& ops) {
+        size_t before = ops.size();
+        seen_.assign(rows_.size(), 0);
+        changed_.assign(rows_.size(), 0);
+        added_.clear();
+
+        for (size_t i = 0; i < snapshot.size(); i++) {
+            BtAddr address = snapshot[i].address & BT_ADDR_MASK;
+            auto it = index_.find(address);
+            if (it == index_.end()) {
+                index_.emplace(address, SIZE_MAX);      // 占位，防止快照中重复的新地址被追加两次
+                added_.push_back(i);
+                continue;
+            }
+            if (it->second == SIZE_MAX) continue;
+            size_t row = it->second;
+            if (seen_[row]) continue;
+            seen_[row] = 1;
+            DeviceRow& current = rows_[row];
+            if (current.name != snapshot[i].name || current.connected != snapshot[i].connected ||
+                current.monitored != snapshot[i].monitored || current.radio != snapshot[i].radio) {
+                current.name = snapshot[i].name;
+                current.connected = snapshot[i].connected;
+                current.monitored = snapshot[i].monitored;
+                current.radio = snapshot[i].radio;
+                changed_[row] = 1;
+            }
+        }
+
+        // 删除：从后往前记录，执行时下标不受前面删除的影响
+        bool removed = false;
+        for (size_t row = rows_.size(); row-- > 0;) {
+            if (seen_[row]) continue;
+            ops.push_back({ DeviceDiffOp::Remove, row });
+            index_.erase(rows_[row].address);
+            removed = true;
+        }
+        if (removed) {
+            size_t out = 0;
+            for (size_t row = 0; row < rows_.size(); row++) {
+                if (!seen_[row]) continue;
+                if (out != row) {
+                    rows_[out] = std::move(rows_[row]);
+                    changed_[out] = changed_[row];
+                    index_[rows_[out].address] = out;
+                }
+                out++;
+            }
+            rows_.resize(out);
+        }
+
+        for (size_t row = 0; row < rows_.size(); row++) {
+            if (changed_[row]) ops.push_back({ DeviceDiffOp::Update, row });
+        }
+
+        for (size_t i : added_) {
+            DeviceRow row = snapshot[i];
+            row.address &= BT_ADDR_MASK;
+            index_[row.address] = rows_.size();
+            ops.push_back({ DeviceDiffOp::Insert, rows_.size() });
+            rows_.push_back(std::move(row));
+        }
+
+        return ops.size() - before;
+    }
+
+private:
+    std::vector<DeviceRow> rows_;
+    std::unordered_map<BtAddr, size_t> index_;     // 地址 → 行
+    std::vector<uint8_t> seen_;                     // 本次快照中出现过的行
+    std::vector<uint8_t> changed_;
+    std::vector<size_t> added_;                     // 新设备在快照中的下标
+};
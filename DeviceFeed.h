@@ -0,0 +1,181 @@
+#pragma once
+
+// 设备变化流：保留上一次枚举的已配对设备快照，每次枚举只与之比较，按地址产生带类型的变化
+// （出现、消失、连接、断开、改名、换适配器）并通知订阅者，使用方不再各自比较整张列表。
+// 快照保存在 DeviceStore 中（地址连续存放、标志为位集），按枚举顺序预期位置、不对时向量化比较地址。
+// 没有任何变化时不分配内存：比较直接读取本次快照，内部缓冲区逐次复用，名称只在改名时复制。
+// 空快照视为枚举失败（适配器暂时不可用），不产生"消失"。只在监控线程中使用，本身不加锁。
+
+#include "BtTypes.h"
+#include "DeviceStore.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct PairedDevice {
+    BtAddr address = 0;
+    std::wstring name;
+    bool connected = false;
+    int radio = 0;      // 所属本地适配器
+};
+
+enum class DeviceChangeType : uint8_t {
+    Appeared,       // 新出现在配对列表中（包括启动后的第一次枚举）
+    Vanished,       // 从配对列表中消失（取消配对）
+    Connected,
+    Disconnected,
+    Renamed,
+    RadioChanged,   // 改由另一个本地适配器报告
+};
+
+struct DeviceChange {
+    DeviceChangeType type;
+    BtAddr address;
+    bool connected;                 // 变化后的状态（消失时为消失前的状态）
+    int radio;
+    const std::wstring* name;       // 仅在回调期间有效
+};
+
+class DeviceFeed;
+
+class IDeviceFeedSubscriber {
+public:
+    virtual ~IDeviceFeedSubscriber() {}
+    // 一次枚举产生的全部变化，只在有变化时调用；feed 为变化后的快照
+    virtual void OnDeviceChanges(const std::vector<DeviceChange>& changes, const DeviceFeed& feed) = 0;
+};
+
+struct DeviceFeedStats {
+    uint64_t applies = 0;       // 应用的枚举结果
+    uint64_t idle = 0;          // 其中没有任何变化的
+    uint64_t changes = 0;       // 产生的变化
+    uint64_t emptySkipped = 0;  // 视为枚举失败而忽略的空快照
+};
+
+class DeviceFeed {
+public:
+    DeviceFeed() = default;
+    DeviceFeed(const DeviceFeed&) = delete;
+    DeviceFeed& operator=(const DeviceFeed&) = delete;
+
+    // 订阅者需比 feed 存活更久；应在开始应用枚举结果前注册
+    void Subscribe(IDeviceFeedSubscriber* subscriber) { subscribers_.push_back(subscriber); }
+
+    // 用本次枚举结果更新快照，有变化时通知订阅者。返回变化数，变化本身可随后通过 Changes() 读取。
+    // 快照中重复的地址只取第一次出现。
+    size_t Apply(const std::vector<PairedDevice>& snapshot) {
+        stats_.applies++;
+        changes_.clear();
+        if (snapshot.empty() && store_.Size() > 0) {
+            stats_.emptySkipped++;
+            stats_.idle++;
+            return 0;
+        }
+
+        seen_.Reset(store_.Size());
+        vanished_.clear();
+        size_t seenCount = 0;
+        size_t hint = 0;    // 枚举顺序通常与上一次相同：预期位置为上一台设备的下一个
+        for (const auto& current : snapshot) {
+            BtAddr address = current.address & BT_ADDR_MASK;
+            int found = store_.Find(address, hint);
+            if (found < 0) {
+                size_t slot = store_.Add(address, current.name, current.connected, current.radio);
+                seen_.Resize(slot + 1);
+                seen_.Set(slot, true);
+                seenCount++;
+                pending_.push_back({ DeviceChangeType::Appeared, slot });
+                hint = slot + 1;
+                continue;
+            }
+            size_t slot = (size_t)found;
+            hint = slot + 1;
+            if (seen_.Get(slot)) continue;
+            seen_.Set(slot, true);
+            seenCount++;
+            if (store_.Flag(slot, DeviceFlag::Connected) != current.connected || store_.Flag(slot, DeviceFlag::Stale)) {
+                store_.SetFlag(slot, DeviceFlag::Connected, current.connected);
+                store_.SetFlag(slot, DeviceFlag::Stale, false);
+                pending_.push_back({ current.connected ? DeviceChangeType::Connected : DeviceChangeType::Disconnected, slot });
+            }
+            if (store_.Name(slot) != current.name) {
+                store_.SetName(slot, current.name);
+                pending_.push_back({ DeviceChangeType::Renamed, slot });
+            }
+            if (store_.Radio(slot) != current.radio) {
+                store_.SetRadio(slot, current.radio);
+                pending_.push_back({ DeviceChangeType::RadioChanged, slot });
+            }
+        }
+        if (seenCount < store_.Size()) RemoveUnseen();
+
+        if (pending_.empty() && vanished_.empty()) {
+            stats_.idle++;
+            return 0;
+        }
+
+        // 快照不再增删后再取名称指针
+        for (const auto& change : pending_) {
+            changes_.push_back({ change.type, store_.Address(change.slot), store_.Flag(change.slot, DeviceFlag::Connected),
+                store_.Radio(change.slot), &store_.Name(change.slot) });
+        }
+        for (const auto& device : vanished_) {
+            changes_.push_back({ DeviceChangeType::Vanished, device.address, device.connected, device.radio,
+                &store_.NameAt(device.nameHandle) });
+        }
+        pending_.clear();
+        stats_.changes += changes_.size();
+        for (IDeviceFeedSubscriber* subscriber : subscribers_) subscriber->OnDeviceChanges(changes_, *this);
+        return changes_.size();
+    }
+
+    // 下一次 Apply 重新报告该设备的连接状态（即使没有变化），用于使用方的状态被其他来源改变之后
+    void Invalidate(BtAddr address) {
+        int slot = store_.Find(address);
+        if (slot >= 0) store_.SetFlag((size_t)slot, DeviceFlag::Stale, true);
+    }
+
+    // 最近一次 Apply 产生的变化，下一次 Apply 前有效
+    const std::vector<DeviceChange>& Changes() const { return changes_; }
+
+    // 当前快照：已有设备保持首次出现的顺序
+    const DeviceStore& Devices() const { return store_; }
+
+    // 设备在快照中的位置，不存在时返回 -1
+    int Find(BtAddr address) const { return store_.Find(address); }
+
+    const DeviceFeedStats& Stats() const { return stats_; }
+
+private:
+    struct PendingChange {
+        DeviceChangeType type;
+        size_t slot;
+    };
+
+    struct VanishedDevice {
+        BtAddr address;
+        bool connected;
+        int radio;
+        uint32_t nameHandle;
+    };
+
+    // 移除本次没有出现的设备，其余设备保持相对顺序；只在有设备消失时调用
+    void RemoveUnseen() {
+        for (size_t i = 0; i < store_.Size(); i++) {
+            if (seen_.Get(i)) continue;
+            vanished_.push_back({ store_.Address(i), store_.Flag(i, DeviceFlag::Connected), store_.Radio(i), store_.NameHandle(i) });
+        }
+        store_.Compact(seen_, newSlots_);
+        for (auto& change : pending_) change.slot = (size_t)newSlots_[change.slot];
+    }
+
+    std::vector<IDeviceFeedSubscriber*> subscribers_;
+    DeviceStore store_;
+    Bitset seen_;
+    std::vector<PendingChange> pending_;
+    std::vector<VanishedDevice> vanished_;
+    std::vector<int> newSlots_;
+    std::vector<DeviceChange> changes_;
+    DeviceFeedStats stats_;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+// 设备注册表：以 48 位地址（BtAddr）为键的开放寻址哈希表，每台设备的全部状态
+// （连接状态、手动断开阻止、重连探测/冷却、统计）集中在一条 DeviceRecord 中。
+// 记录连续存放便于遍历；删除时用末尾记录填补空位。非线程安全，由调用方加锁。
+
+#include "BtTypes.h"
+#include "TimerWheel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct DeviceRecord {
+    BtAddr address = 0;
+    std::wstring name;
+    bool monitored = false;             // 是否在监控列表中
+    bool connected = false;             // 监控循环最后确认的连接状态
+    bool blockAutoReconnect = false;    // 用户手动断开后阻止自动重连，直到手动连接
+    int radio = 0;                      // 所属本地适配器（RadioManager 下标），重连按适配器限制并发
+
+    // 重连探测（由 MonitorScheduler 维护）
+    TimerWheel::Handle probeTimer = TimerWheel::INVALID_TIMER;
+    int probeFailures = 0;
+    int64_t lastAttemptMs = 0;
+    bool attempted = false;
+    int64_t disconnectedAtMs = -1;      // 最近一次观察到断开的时间，重新连接后清除
+
+    // 统计
+    uint32_t connects = 0;              // 观察到的连接次数
+    uint32_t disconnects = 0;           // 观察到的断开次数
+    uint32_t reconnectAttempts = 0;
+    uint32_t reconnectFailures = 0;
+};
+
+class DeviceRegistry {
+public:
+    explicit DeviceRegistry(size_t expected = 16) {
+        size_t capacity = 16;
+        while (capacity < expected * 2) capacity *= 2;
+        slots_.assign(capacity, EMPTY_SLOT);
+        records_.reserve(expected);
+    }
+
+    // 查找记录，不存在返回 nullptr；指针在下一次 Upsert/Remove 之前有效
+    DeviceRecord* Find(BtAddr address) {
+        int32_t index = slots_[Locate(address & BT_ADDR_MASK)];
+        return index == EMPTY_SLOT ? nullptr : &records_[index];
+    }
+
+    const DeviceRecord* Find(BtAddr address) const {
+        return const_cast<DeviceRegistry*>(this)->Find(address);
+    }
+
+    // 查找或插入
+    DeviceRecord& Upsert(BtAddr address) {
+        address &= BT_ADDR_MASK;
+        size_t slot = Locate(address);
+        if (slots_[slot] != EMPTY_SLOT) return records_[slots_[slot]];
+
+        if ((records_.size() + 1) * 2 > slots_.size()) {
+            Rehash(slots_.size() * 2);
+            slot = Locate(address);
+        }
+        slots_[slot] = (int32_t)records_.size();
+        records_.push_back(DeviceRecord());
+        records_.back().address = address;
+        return records_.back();
+    }
+
+    bool Remove(BtAddr address) {
+        address &= BT_ADDR_MASK;
+        size_t slot = Locate(address);
+        int32_t index = slots_[slot];
+        if (index == EMPTY_SLOT) return false;
+
+        // 线性探测的回移删除：把后续同簇元素前移，保证查找不会提前遇到空槽
+        size_t mask = slots_.size() - 1;
+        size_t hole = slot;
+        size_t next = (hole + 1) & mask;
+        while (slots_[next] != EMPTY_SLOT) {
+            size_t home = Home(records_[slots_[next]].address);
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots_[hole] = slots_[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        slots_[hole] = EMPTY_SLOT;
+
+        // 用末尾记录填补空位
+        int32_t last = (int32_t)records_.size() - 1;
+        if (index != last) {
+            records_[index] = std::move(records_[last]);
+            slots_[Locate(records_[index].address)] = index;
+        }
+        records_.pop_back();
+        return true;
+    }
+
+    void Clear() {
+        records_.clear();
+        slots_.assign(slots_.size(), EMPTY_SLOT);
+    }
+
+    size_t Size() const { return records_.size(); }
+
+    std::vector<DeviceRecord>::iterator begin() { return records_.begin(); }
+    std::vector<DeviceRecord>::iterator end() { return records_.end(); }
+    std::vector<DeviceRecord>::const_iterator begin() const { return records_.begin(); }
+    std::vector<DeviceRecord>::const_iterator end() const { return records_.end(); }
+
+private:
+    static constexpr int32_t EMPTY_SLOT = -1;
+
+    // splitmix64 末段混合，地址低位多为厂商内序号，需要打散
+    static uint64_t Hash(BtAddr address) {
+        uint64_t x = address;
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    size_t Home(BtAddr address) const {
+        return (size_t)(Hash(address) & (slots_.size() - 1));
+    }
+
+    // 返回地址所在的槽，或应插入的空槽
+    size_t Locate(BtAddr address) const {
+        size_t mask = slots_.size() - 1;
+        size_t slot = Home(address);
+        while (slots_[slot] != EMPTY_SLOT && records_[slots_[slot]].address != address) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void Rehash(size_t capacity) {
+        slots_.assign(capacity, EMPTY_SLOT);
+        for (size_t i = 0; i < records_.size(); i++) {
+            slots_[Locate(records_[i].address)] = (int32_t)i;
+        }
+    }
+
+    std::vector<int32_t> slots_;
+    std::vector<DeviceRecord> records_;
+};
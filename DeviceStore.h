@@ -0,0 +1,254 @@
+#pragma once
+
+// 设备存储（结构数组）：地址按 BtAddr 连续存放，连接等标志各为一个位集，名称为名称池中的句柄。
+// 按地址查找先看调用方给的预期位置（枚举顺序通常与上一次相同），不对时整段向量化比较：
+// AVX2 每次比较 4 个地址，SSE2（x64 必有）每次 2 个，其他平台逐个比较；AVX2 在运行时检测 CPU 后才使用。
+// 删除设备时其余设备保持相对顺序；释放的名称在下一次添加前仍然可读。本身不加锁。
+
+#include "BtTypes.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BT_ADDRESS_MATCH_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BT_TARGET_AVX2
+#else
+#define BT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+enum class AddressMatchPath : uint8_t {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+namespace AddressMatch {
+
+inline const char* PathName(AddressMatchPath path) {
+    switch (path) {
+    case AddressMatchPath::Avx2: return "AVX2";
+    case AddressMatchPath::Sse2: return "SSE2";
+    default: return "Scalar";
+    }
+}
+
+// 比较结果掩码中最低的置位（mask 非 0）
+inline int LowestLane(int mask) {
+    int lane = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        lane++;
+    }
+    return lane;
+}
+
+inline int FindScalar(const uint64_t* addresses, size_t count, uint64_t key) {
+    for (size_t i = 0; i < count; i++) {
+        if (addresses[i] == key) return (int)i;
+    }
+    return -1;
+}
+
+#ifdef BT_ADDRESS_MATCH_X64
+// SSE2 没有 64 位相等比较：按 32 位比较后与高低半部交换后的结果相与
+inline int FindSse2(const uint64_t* addresses, size_t count, uint64_t key) {
+    const __m128i needle = _mm_set1_epi64x((long long)key);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i a = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(addresses + i)), needle);
+        __m128i b = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(addresses + i + 2)), needle);
+        a = _mm_and_si128(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+        b = _mm_and_si128(b, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 3, 0, 1)));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(a)) | (_mm_movemask_pd(_mm_castsi128_pd(b)) << 2);
+        if (mask) return (int)i + LowestLane(mask);
+    }
+    int tail = FindScalar(addresses + i, count - i, key);
+    return tail < 0 ? -1 : (int)i + tail;
+}
+
+BT_TARGET_AVX2 inline int FindAvx2(const uint64_t* addresses, size_t count, uint64_t key) {
+    const __m256i needle = _mm256_set1_epi64x((long long)key);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(addresses + i)), needle);
+        __m256i b = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(addresses + i + 4)), needle);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(a)) | (_mm256_movemask_pd(_mm256_castsi256_pd(b)) << 4);
+        if (mask) return (int)i + LowestLane(mask);
+    }
+    int tail = FindScalar(addresses + i, count - i, key);
+    return tail < 0 ? -1 : (int)i + tail;
+}
+
+inline bool CpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;    // 系统需保存 YMM 寄存器
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+// 本机可用的最快路径（首次调用时检测）
+inline AddressMatchPath DetectedPath() {
+#ifdef BT_ADDRESS_MATCH_X64
+    static const AddressMatchPath path = CpuHasAvx2() ? AddressMatchPath::Avx2 : AddressMatchPath::Sse2;
+    return path;
+#else
+    return AddressMatchPath::Scalar;
+#endif
+}
+
+// 按指定路径查找（本机不支持的路径退回可用的路径），找不到时返回 -1
+inline int FindWith(AddressMatchPath path, const uint64_t* addresses, size_t count, uint64_t key) {
+#ifdef BT_ADDRESS_MATCH_X64
+    if (path == AddressMatchPath::Avx2 && DetectedPath() == AddressMatchPath::Avx2) return FindAvx2(addresses, count, key);
+    if (path != AddressMatchPath::Scalar) return FindSse2(addresses, count, key);
+#else
+    (void)path;
+#endif
+    return FindScalar(addresses, count, key);
+}
+
+inline int Find(const uint64_t* addresses, size_t count, uint64_t key) {
+    return FindWith(DetectedPath(), addresses, count, key);
+}
+
+}   // namespace AddressMatch
+
+// 每个设备一位的标志集合
+class Bitset {
+public:
+    size_t Size() const { return size_; }
+
+    // 改变位数，新增的位为 0
+    void Resize(size_t size) {
+        for (size_t i = size; i < size_; i++) Set(i, false);    // 缩小时清除多出的位，之后再增大时仍为 0
+        words_.resize((size + 63) / 64, 0);
+        size_ = size;
+    }
+
+    // 全部清零并改为 size 位（容量足够时不分配）
+    void Reset(size_t size) {
+        words_.assign((size + 63) / 64, 0);
+        size_ = size;
+    }
+
+    bool Get(size_t index) const { return (words_[index / 64] >> (index % 64)) & 1; }
+
+    void Set(size_t index, bool value) {
+        uint64_t bit = 1ull << (index % 64);
+        if (value) words_[index / 64] |= bit;
+        else words_[index / 64] &= ~bit;
+    }
+
+    size_t Count() const {
+        size_t count = 0;
+        for (uint64_t word : words_) {
+            for (; word; word &= word - 1) count++;
+        }
+        return count;
+    }
+
+private:
+    std::vector<uint64_t> words_;
+    size_t size_ = 0;
+};
+
+enum class DeviceFlag : uint8_t {
+    Connected,
+    Stale,          // 使用方要求下一次比较时重新报告（DeviceFeed::Invalidate）
+    Count,
+};
+
+class DeviceStore {
+public:
+    size_t Size() const { return addresses_.size(); }
+    const uint64_t* Addresses() const { return addresses_.data(); }
+
+    BtAddr Address(size_t slot) const { return addresses_[slot]; }
+    int Radio(size_t slot) const { return radios_[slot]; }
+    const std::wstring& Name(size_t slot) const { return names_[nameHandles_[slot]]; }
+    uint32_t NameHandle(size_t slot) const { return nameHandles_[slot]; }
+    // 按句柄读取名称，已删除设备的名称在下一次 Add 前仍有效
+    const std::wstring& NameAt(uint32_t handle) const { return names_[handle]; }
+
+    bool Flag(size_t slot, DeviceFlag flag) const { return flags_[(int)flag].Get(slot); }
+    void SetFlag(size_t slot, DeviceFlag flag, bool value) { flags_[(int)flag].Set(slot, value); }
+
+    void SetRadio(size_t slot, int radio) { radios_[slot] = radio; }
+    void SetName(size_t slot, const std::wstring& name) { names_[nameHandles_[slot]] = name; }
+
+    // 地址所在位置，不存在时返回 -1；hint 为预期位置，命中时只比较一次
+    int Find(BtAddr address, size_t hint = 0) const {
+        address &= BT_ADDR_MASK;
+        if (hint < addresses_.size() && addresses_[hint] == address) return (int)hint;
+        return AddressMatch::Find(addresses_.data(), addresses_.size(), address);
+    }
+
+    // 追加设备（调用方保证地址不存在），返回位置
+    size_t Add(BtAddr address, const std::wstring& name, bool connected, int radio) {
+        size_t slot = addresses_.size();
+        uint32_t handle;
+        if (!freeNames_.empty()) {
+            handle = freeNames_.back();
+            freeNames_.pop_back();
+            names_[handle] = name;
+        } else {
+            handle = (uint32_t)names_.size();
+            names_.push_back(name);
+        }
+        addresses_.push_back(address & BT_ADDR_MASK);
+        radios_.push_back(radio);
+        nameHandles_.push_back(handle);
+        for (auto& flag : flags_) flag.Resize(slot + 1);
+        SetFlag(slot, DeviceFlag::Connected, connected);
+        return slot;
+    }
+
+    // 只保留 keep 中置位的设备（其余设备保持相对顺序），newSlots 写入每个原位置的新位置（删除的为 -1）；
+    // 删除设备的名称句柄放回空闲列表
+    void Compact(const Bitset& keep, std::vector<int>& newSlots) {
+        size_t count = addresses_.size();
+        newSlots.assign(count, -1);
+        size_t out = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!keep.Get(i)) {
+                freeNames_.push_back(nameHandles_[i]);
+                continue;
+            }
+            if (out != i) {
+                addresses_[out] = addresses_[i];
+                radios_[out] = radios_[i];
+                nameHandles_[out] = nameHandles_[i];
+                for (auto& flag : flags_) flag.Set(out, flag.Get(i));
+            }
+            newSlots[i] = (int)out++;
+        }
+        addresses_.resize(out);
+        radios_.resize(out);
+        nameHandles_.resize(out);
+        for (auto& flag : flags_) flag.Resize(out);
+    }
+
+private:
+    std::vector<uint64_t> addresses_;
+    std::vector<int> radios_;
+    std::vector<uint32_t> nameHandles_;
+    std::vector<std::wstring> names_;
+    std::vector<uint32_t> freeNames_;
+    Bitset flags_[(int)DeviceFlag::Count];
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+// 主动扫描规划：扫描到期时先判断是否值得扫描，并限制每分钟的扫描占用时间（空口时间）。
+// - 只有存在被监控、未连接、未被手动断开阻止且不在冷却期的设备时才扫描；全部在线时扫描找不到任何东西
+// - 以本次扫描预计结束时刻为终点的一分钟内，已有扫描时长（含进行中的扫描）加上本次预计时长超过预算时跳过
+// - 预计时长取上一次实测值，还没有实测时按 cTimeoutMultiplier = 2 的 2560 ms 估计
+// 只在监控线程中使用，本身不加锁；时间来自 IClock，可在虚拟时钟下验证。
+
+#include "Clock.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class InquiryDecision {
+    Scan,           // 发起扫描
+    NothingToFind,  // 没有需要发现的设备
+    OverBudget,     // 超出每分钟扫描预算
+};
+
+struct InquiryPlannerStats {
+    uint64_t scans = 0;             // 发起的扫描
+    uint64_t skippedIdle = 0;       // 没有需要发现的设备而跳过
+    uint64_t skippedBudget = 0;     // 超出预算而跳过
+    int64_t airtimeMs = 0;          // 已完成扫描的累计时长
+    int64_t windowMs = 0;           // 最近一分钟内的扫描时长
+    int64_t uptimeMs = 0;           // 统计起点至今
+
+    // 每小时的扫描秒数
+    double SecondsPerHour() const {
+        return uptimeMs > 0 ? airtimeMs * 3600.0 / uptimeMs : 0.0;
+    }
+};
+
+class InquiryPlanner {
+public:
+    static constexpr int DEFAULT_BUDGET_MS = 12000;     // 每分钟扫描预算（默认 15 秒一次、每次 2.56 秒时约 10 秒）
+    static constexpr int WINDOW_MS = 60000;
+    static constexpr int DEFAULT_SCAN_MS = 2560;
+
+    explicit InquiryPlanner(IClock& clock, int budgetMsPerMinute = DEFAULT_BUDGET_MS)
+        : clock_(clock), budgetMs_(budgetMsPerMinute), sinceMs_(clock.NowMs()) {
+        recent_.reserve(8);     // 15 秒间隔时一分钟内最多 5 次扫描
+    }
+
+    // 0 表示不再主动扫描（只做不带扫描的枚举）
+    void SetBudgetMsPerMinute(int budgetMs) { budgetMs_ = budgetMs > 0 ? budgetMs : 0; }
+    int BudgetMsPerMinute() const { return budgetMs_; }
+
+    // 扫描到期时调用：hasTarget 为是否存在需要发现的设备。返回 Scan 时调用方应随后调用 OnScanStarted
+    InquiryDecision Decide(bool hasTarget) {
+        if (!hasTarget) {
+            stats_.skippedIdle++;
+            return InquiryDecision::NothingToFind;
+        }
+        int64_t estimate = EstimatedScanMs();
+        if (AirtimeSinceMs(clock_.NowMs() + estimate - WINDOW_MS) + estimate > budgetMs_) {
+            stats_.skippedBudget++;
+            return InquiryDecision::OverBudget;
+        }
+        return InquiryDecision::Scan;
+    }
+
+    void OnScanStarted() {
+        stats_.scans++;
+        scanStartMs_ = clock_.NowMs();
+    }
+
+    // 扫描完成（同步扫描返回或异步扫描结果取回）
+    void OnScanFinished() {
+        if (scanStartMs_ < 0) return;
+        int64_t now = clock_.NowMs();
+        int64_t duration = now - scanStartMs_;
+        Expire(now);
+        recent_.push_back({ scanStartMs_, now });
+        stats_.airtimeMs += duration;
+        lastScanMs_ = duration;
+        scanStartMs_ = -1;
+    }
+
+    InquiryPlannerStats Stats() {
+        InquiryPlannerStats s = stats_;
+        s.windowMs = AirtimeSinceMs(clock_.NowMs() - WINDOW_MS);
+        s.uptimeMs = clock_.NowMs() - sinceMs_;
+        return s;
+    }
+
+private:
+    struct Span {
+        int64_t startMs;
+        int64_t endMs;
+    };
+
+    // 丢弃一分钟以前结束的记录（最近一分钟只有几条记录，从头部删除的开销可以忽略，且不像 deque 那样周期性地分配新块）
+    void Expire(int64_t now) {
+        size_t expired = 0;
+        while (expired < recent_.size() && recent_[expired].endMs <= now - WINDOW_MS) expired++;
+        if (expired > 0) recent_.erase(recent_.begin(), recent_.begin() + expired);
+    }
+
+    // windowStart 至今的扫描时长，进行中的扫描计到当前时刻
+    int64_t AirtimeSinceMs(int64_t windowStart) {
+        int64_t now = clock_.NowMs();
+        Expire(now);
+        int64_t total = 0;
+        for (const auto& span : recent_) {
+            if (span.endMs <= windowStart) continue;
+            total += span.endMs - (span.startMs > windowStart ? span.startMs : windowStart);
+        }
+        if (scanStartMs_ >= 0) total += now - (scanStartMs_ > windowStart ? scanStartMs_ : windowStart);
+        return total;
+    }
+
+    int64_t EstimatedScanMs() const {
+        return lastScanMs_ > 0 ? lastScanMs_ : DEFAULT_SCAN_MS;
+    }
+
+    IClock& clock_;
+    int budgetMs_;
+    int64_t sinceMs_;
+    int64_t scanStartMs_ = -1;
+    int64_t lastScanMs_ = 0;
+    std::vector<Span> recent_;
+    InquiryPlannerStats stats_;
+};
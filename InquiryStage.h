@@ -0,0 +1,96 @@
+#pragma once
+
+// 主动扫描阶段：带扫描的设备枚举（约 2.5 秒）在独立线程中执行，
+// 监控循环只负责发起并在之后的 Step 中取回结果，期间不带扫描的枚举、事件处理与重连照常进行。
+// InquiryWorker 用于两个 Windows 程序；基准程序使用按虚拟时间完成的 SimInquiryStage（SimBluetooth.h）。
+
+#include "MonitorCore.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class InquiryWorker : public IInquiryStage {
+public:
+    explicit InquiryWorker(IBluetoothBackend& backend)
+        : backend_(backend), thread_(&InquiryWorker::WorkerLoop, this) {}
+
+    ~InquiryWorker() {
+        Shutdown();
+    }
+
+    InquiryWorker(const InquiryWorker&) = delete;
+    InquiryWorker& operator=(const InquiryWorker&) = delete;
+
+    // 扫描完成时回调（在扫描线程中调用，可用于唤醒监控循环）
+    void SetCompletionNotifier(std::function<void()> notifier) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notifier_ = notifier;
+    }
+
+    bool Begin() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || requested_ || running_) return false;
+        requested_ = true;
+        cv_.notify_one();
+        return true;
+    }
+
+    bool TakeResult(std::vector<PairedDevice>& out) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ready_) return false;
+        out.swap(result_);
+        ready_ = false;
+        return true;
+    }
+
+    // 停止并等待进行中的扫描结束
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return;
+            stopping_ = true;
+            cv_.notify_all();
+        }
+        if (thread_.joinable()) thread_.join();
+    }
+
+private:
+    void WorkerLoop() {
+        std::vector<PairedDevice> scratch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || requested_; });
+                if (stopping_) return;
+                requested_ = false;
+                running_ = true;
+            }
+
+            backend_.EnumeratePaired(true, scratch);
+
+            std::function<void()> notifier;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                result_.swap(scratch);
+                ready_ = true;
+                running_ = false;
+                notifier = notifier_;
+            }
+            if (notifier) notifier();
+        }
+    }
+
+    IBluetoothBackend& backend_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::function<void()> notifier_;
+    std::vector<PairedDevice> result_;
+    bool requested_ = false;
+    bool running_ = false;
+    bool ready_ = false;
+    bool stopping_ = false;
+    std::thread thread_;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+// 链路建立等待：启用服务后按递增间隔轮询连接状态，链路一建立立即返回，超过截止时间判定失败。
+// 按设备类别（蓝牙 Class of Device 的主类别）记录观测到的建链耗时，
+// 样本足够后截止时间自动调整为 p95 × tuneFactor（限制在 [minDeadlineMs, deadlineMs] 内）。
+// 传入 OperationContext 时在其条件变量上等待，取消或到达操作的截止时间立即结束（不计入样本与超时）。
+// 时间来自 IClock，可在 VirtualClock 上确定性地运行。线程安全。
+
+#include "Cancellation.h"
+#include "Clock.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+struct LinkWaitOptions {
+    int deadlineMs = 3000;          // 截止时间上限（未学习时使用）
+    int minDeadlineMs = 800;        // 自动调整的下限
+    int firstPollMs = 50;           // 第一次轮询间隔，之后翻倍
+    int maxPollMs = 250;            // 轮询间隔上限
+    int tuneMinSamples = 8;         // 开始自动调整所需的样本数
+    double tuneFactor = 1.5;        // 截止时间 = p95 × tuneFactor
+    size_t maxSamples = 128;        // 每个类别保留的最近样本数
+};
+
+struct LinkWaitResult {
+    bool linked = false;
+    int64_t elapsedMs = 0;          // 从开始等待到链路建立（或超时）的时间
+    int polls = 0;
+    int deadlineMs = 0;             // 本次使用的截止时间
+    OperationStatus status = OperationStatus::Ok;   // 因操作取消或到达其截止时间而提前结束
+};
+
+struct LinkClassStats {
+    uint32_t deviceClass = 0;
+    uint64_t linked = 0;
+    uint64_t timeouts = 0;
+    int64_t p50Ms = 0;
+    int64_t p95Ms = 0;
+    int64_t maxMs = 0;
+    int deadlineMs = 0;             // 当前截止时间
+};
+
+// 蓝牙 Class of Device 的主设备类别（第 8~12 位）
+inline uint32_t MajorDeviceClass(uint32_t classOfDevice) {
+    return (classOfDevice >> 8) & 0x1F;
+}
+
+inline const wchar_t* MajorDeviceClassName(uint32_t major) {
+    switch (major) {
+    case 0x01: return L"计算机";
+    case 0x02: return L"电话";
+    case 0x03: return L"网络";
+    case 0x04: return L"音频/视频";
+    case 0x05: return L"外设";
+    case 0x06: return L"成像";
+    case 0x07: return L"穿戴";
+    case 0x08: return L"玩具";
+    case 0x09: return L"健康";
+    default: return L"其他";
+    }
+}
+
+class LinkWaiter {
+public:
+    explicit LinkWaiter(IClock& clock, const LinkWaitOptions& options = LinkWaitOptions())
+        : clock_(clock), options_(options) {}
+
+    // 修改截止时间上限（settings.txt 的 link_deadline_ms）
+    void SetDeadlineMs(int deadlineMs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        options_.deadlineMs = deadlineMs;
+        if (options_.minDeadlineMs > deadlineMs) options_.minDeadlineMs = deadlineMs;
+    }
+
+    // 当前类别使用的截止时间
+    int DeadlineMs(uint32_t deviceClass) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return DeadlineLocked(classes_[deviceClass]);
+    }
+
+    // 在截止时间内按递增间隔调用 isLinked，返回 true 时立即结束；op 不为空时改为可取消的等待
+    template <class IsLinked>
+    LinkWaitResult Wait(uint32_t deviceClass, IsLinked isLinked, OperationContext* op = nullptr) {
+        LinkWaitResult result;
+        int pollMs;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            result.deadlineMs = DeadlineLocked(classes_[deviceClass]);
+            pollMs = options_.firstPollMs;
+        }
+
+        int64_t start = clock_.NowMs();
+        int64_t deadline = start + result.deadlineMs;
+        while (true) {
+            int64_t now = clock_.NowMs();
+            int64_t sleepMs = std::min<int64_t>(pollMs, deadline - now);
+            if (op) {
+                result.status = op->Wait(sleepMs);
+                if (result.status != OperationStatus::Ok) break;
+            } else if (sleepMs > 0) {
+                clock_.SleepMs(sleepMs);
+            }
+            result.polls++;
+            if (isLinked()) {
+                result.linked = true;
+                break;
+            }
+            if (clock_.NowMs() >= deadline) break;
+            pollMs = std::min(pollMs * 2, options_.maxPollMs);
+        }
+        result.elapsedMs = clock_.NowMs() - start;
+        if (result.status != OperationStatus::Ok) return result;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ClassState& state = classes_[deviceClass];
+        if (result.linked) {
+            state.linked++;
+            state.samples.push_back(result.elapsedMs);
+            if (state.samples.size() > options_.maxSamples) state.samples.erase(state.samples.begin());
+        } else {
+            state.timeouts++;
+        }
+        return result;
+    }
+
+    std::vector<LinkClassStats> Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<LinkClassStats> all;
+        for (auto& entry : classes_) {
+            const ClassState& state = entry.second;
+            if (state.linked == 0 && state.timeouts == 0) continue;
+            LinkClassStats s;
+            s.deviceClass = entry.first;
+            s.linked = state.linked;
+            s.timeouts = state.timeouts;
+            s.p50Ms = Percentile(state.samples, 50);
+            s.p95Ms = Percentile(state.samples, 95);
+            s.maxMs = Percentile(state.samples, 100);
+            s.deadlineMs = DeadlineLocked(entry.second);
+            all.push_back(s);
+        }
+        return all;
+    }
+
+private:
+    struct ClassState {
+        std::vector<int64_t> samples;   // 最近的建链耗时（毫秒），按时间顺序
+        uint64_t linked = 0;
+        uint64_t timeouts = 0;
+    };
+
+    static int64_t Percentile(std::vector<int64_t> samples, double p) {
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        size_t idx = (size_t)(p / 100.0 * (samples.size() - 1) + 0.5);
+        return samples[std::min(idx, samples.size() - 1)];
+    }
+
+    int DeadlineLocked(const ClassState& state) const {
+        if ((int)state.samples.size() < options_.tuneMinSamples) return options_.deadlineMs;
+        int tuned = (int)(Percentile(state.samples, 95) * options_.tuneFactor);
+        return std::max(options_.minDeadlineMs, std::min(tuned, options_.deadlineMs));
+    }
+
+    IClock& clock_;
+    LinkWaitOptions options_;
+    std::mutex mutex_;
+    std::map<uint32_t, ClassState> classes_;
+};
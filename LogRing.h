@@ -0,0 +1,106 @@
+#pragma once
+
+// 日志环形缓冲区：多生产者、单消费者、定长无锁队列（Vyukov 有界队列）。
+// 工作线程 Push 只做一次 CAS 加一次字符拷贝，不分配内存、不等待 UI；
+// UI 线程在定时器里 Drain 批量取出。队列满时丢弃新记录并计数，超长记录截断到 SLOT_CHARS。
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+struct LogRingStats {
+    uint64_t pushed = 0;        // 成功写入的记录
+    uint64_t dropped = 0;       // 队列满而丢弃的记录
+    uint64_t truncated = 0;     // 超过槽位长度而截断的记录
+};
+
+class LogRing {
+public:
+    static constexpr size_t SLOT_CHARS = 256;   // 每条记录最多保留的字符数
+
+    // capacity 向上取整到 2 的幂，槽位在构造时一次分配
+    explicit LogRing(size_t capacity = 4096) {
+        capacity_ = 2;
+        while (capacity_ < capacity) capacity_ *= 2;
+        mask_ = capacity_ - 1;
+        slots_.reset(new Slot[capacity_]);
+        for (size_t i = 0; i < capacity_; i++) slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    size_t Capacity() const { return capacity_; }
+
+    // 任意线程调用；队列满时返回 false
+    bool Push(const wchar_t* text, size_t length) {
+        size_t pos = enqueue_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+
+        if (length > SLOT_CHARS) {
+            length = SLOT_CHARS;
+            truncated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        memcpy(slot->text, text, length * sizeof(wchar_t));
+        slot->length = (uint32_t)length;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool Push(const std::wstring& text) { return Push(text.data(), text.size()); }
+
+    // 仅由消费者线程调用：按写入顺序取出至多 maxRecords 条，对每条调用 fn(text, length)，返回取出条数
+    template <class Fn>
+    size_t Drain(Fn fn, size_t maxRecords = SIZE_MAX) {
+        size_t count = 0;
+        while (count < maxRecords) {
+            Slot& slot = slots_[dequeue_ & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeue_ + 1) break;
+            fn((const wchar_t*)slot.text, (size_t)slot.length);
+            slot.sequence.store(dequeue_ + capacity_, std::memory_order_release);
+            dequeue_++;
+            count++;
+        }
+        return count;
+    }
+
+    LogRingStats Stats() const {
+        LogRingStats s;
+        s.pushed = pushed_.load(std::memory_order_relaxed);
+        s.dropped = dropped_.load(std::memory_order_relaxed);
+        s.truncated = truncated_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{ 0 };
+        uint32_t length = 0;
+        wchar_t text[SLOT_CHARS];
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enqueue_{ 0 };
+    alignas(64) size_t dequeue_ = 0;
+    alignas(64) std::atomic<uint64_t> pushed_{ 0 };
+    std::atomic<uint64_t> dropped_{ 0 };
+    std::atomic<uint64_t> truncated_{ 0 };
+};
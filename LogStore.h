@@ -0,0 +1,99 @@
+#pragma once
+
+// 日志视图的定长存储：记录环（偏移、长度、序号）加一块循环使用的字符区。
+// 记录数或字符区用满时淘汰最旧的记录，并交给调用方写入磁盘日志；
+// 内存在构造时一次分配，运行多久都不再增长。日志框只按行号读取可见的几行。非线程安全（GUI 仅在 UI 线程使用）。
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct LogStoreStats {
+    uint64_t appended = 0;      // 累计写入的行
+    uint64_t spilled = 0;       // 被淘汰（已交给磁盘日志）的行
+    uint64_t truncated = 0;     // 超过单行上限被截断的行
+};
+
+class LogStore {
+public:
+    // maxLines：保留的行数上限；arenaChars：字符区大小；单行最多 arenaChars / 8 个字符
+    explicit LogStore(size_t maxLines = 10000, size_t arenaChars = 1 << 20)
+        : records_(std::max<size_t>(maxLines, 1)), arena_(std::max<size_t>(arenaChars, 64)),
+          maxLineChars_(arena_.size() / 8) {}
+
+    size_t Count() const { return count_; }
+    size_t Capacity() const { return records_.size(); }
+    size_t ArenaChars() const { return arena_.size(); }
+    const LogStoreStats& Stats() const { return stats_; }
+
+    // 第 index 行（0 为保留的最旧一行），返回指向字符区的指针，不以 0 结尾
+    const wchar_t* Line(size_t index, size_t* length) const {
+        const Record& record = records_[(first_ + index) % records_.size()];
+        *length = record.length;
+        return arena_.data() + record.offset;
+    }
+
+    // 追加一行；为腾出空间而淘汰的旧行按从旧到新的顺序交给 spill(text, length)
+    template <class Spill>
+    void Append(const wchar_t* text, size_t length, Spill spill) {
+        if (length > maxLineChars_) {
+            length = maxLineChars_;
+            stats_.truncated++;
+        }
+
+        // 尾部放不下时整体回绕到开头，尾部剩余空间连同其中的旧行一起放弃
+        size_t start = writePos_;
+        bool wrap = start + length > arena_.size();
+        if (wrap) start = 0;
+        while (count_ > 0) {
+            const Record& oldest = records_[first_];
+            bool inTheWay = wrap ? (oldest.offset >= writePos_ || oldest.offset < start + length)
+                                 : (oldest.offset >= start && oldest.offset < start + length);
+            if (!inTheWay && count_ < records_.size()) break;
+            EvictOldest(spill);
+        }
+
+        if (length > 0) memcpy(arena_.data() + start, text, length * sizeof(wchar_t));
+        Record& record = records_[(first_ + count_) % records_.size()];
+        record.offset = (uint32_t)start;
+        record.length = (uint32_t)length;
+        count_++;
+        writePos_ = start + length;
+        stats_.appended++;
+    }
+
+    // 清空，保留的行按从旧到新的顺序交给 spill
+    template <class Spill>
+    void Clear(Spill spill) {
+        while (count_ > 0) EvictOldest(spill);
+        writePos_ = 0;
+    }
+
+private:
+    struct Record {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    template <class Spill>
+    void EvictOldest(Spill& spill) {
+        const Record& oldest = records_[first_];
+        spill((const wchar_t*)(arena_.data() + oldest.offset), (size_t)oldest.length);
+        first_ = (first_ + 1) % records_.size();
+        count_--;
+        stats_.spilled++;
+        if (count_ == 0) {
+            first_ = 0;
+            writePos_ = 0;
+        }
+    }
+
+    std::vector<Record> records_;
+    std::vector<wchar_t> arena_;
+    size_t maxLineChars_;
+    size_t first_ = 0;
+    size_t count_ = 0;
+    size_t writePos_ = 0;
+    LogStoreStats stats_;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+// 运行指标：HDR 风格的对数-线性延迟直方图（记录无锁，约 3% 相对误差），
+// 以及按设备、按 Win32 错误码统计的连接成功/失败次数。
+// g_metrics 汇总扫描、枚举、服务切换、断开→重连与监控循环单次处理的耗时，可随时输出（控制台 Ctrl+Break，GUI“运行统计”按钮）。
+
+#include "BtTypes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sumUs = 0;
+    uint64_t maxUs = 0;
+    std::vector<uint64_t> buckets;
+
+    uint64_t MeanUs() const { return count ? sumUs / count : 0; }
+
+    // 第 p 百分位（p 取 0~100），返回所在桶的上界（不超过观测到的最大值）
+    uint64_t PercentileUs(double p) const;
+};
+
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;                          // 每个数量级 32 个子桶
+    static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+    static constexpr uint64_t MAX_VALUE_US = (1ull << 36) - 1;  // 约 19 小时，超出截断
+    static constexpr size_t BUCKET_COUNT = (36 - SUB_BITS + 1) * SUB_COUNT;
+
+    LatencyHistogram() : buckets_(BUCKET_COUNT) {}
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void Record(uint64_t us) {
+        if (us > MAX_VALUE_US) us = MAX_VALUE_US;
+        buckets_[BucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(us, std::memory_order_relaxed);
+        uint64_t prev = max_.load(std::memory_order_relaxed);
+        while (us > prev && !max_.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    void RecordMs(uint64_t ms) { Record(ms * 1000); }
+
+    HistogramSnapshot Snapshot() const {
+        HistogramSnapshot s;
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sumUs = sum_.load(std::memory_order_relaxed);
+        s.maxUs = max_.load(std::memory_order_relaxed);
+        s.buckets.resize(BUCKET_COUNT);
+        for (size_t i = 0; i < BUCKET_COUNT; i++) s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // 0~63 精确，其后每翻一倍分 32 个子桶
+    static size_t BucketOf(uint64_t value) {
+        if (value < 2 * SUB_COUNT) return (size_t)value;
+        int shift = HighestBit(value) - SUB_BITS;
+        return (size_t)((shift + 1) * SUB_COUNT + ((value >> shift) - SUB_COUNT));
+    }
+
+    // 最高置位的位置（value > 0），二分查找，不依赖编译器内建函数
+    static int HighestBit(uint64_t value) {
+        int bit = 0;
+        for (int step = 32; step > 0; step /= 2) {
+            if (value >> step) {
+                value >>= step;
+                bit += step;
+            }
+        }
+        return bit;
+    }
+
+    static uint64_t BucketUpperBound(size_t bucket) {
+        if (bucket < 2 * SUB_COUNT) return bucket;
+        uint64_t shift = bucket / SUB_COUNT - 1;
+        uint64_t sub = bucket % SUB_COUNT + SUB_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+
+private:
+    std::vector<std::atomic<uint64_t>> buckets_;
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> sum_{ 0 };
+    std::atomic<uint64_t> max_{ 0 };
+};
+
+inline uint64_t HistogramSnapshot::PercentileUs(double p) const {
+    if (count == 0) return 0;
+    uint64_t rank = (uint64_t)(p / 100.0 * count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(LatencyHistogram::BucketUpperBound(i), maxUs);
+    }
+    return maxUs;
+}
+
+// 每台设备的连接结果：成功次数与按错误码分类的失败次数
+struct ConnectOutcome {
+    std::wstring name;
+    uint64_t successes = 0;
+    std::map<uint32_t, uint64_t> failures;     // Win32 错误码 → 次数
+};
+
+class Metrics {
+public:
+    LatencyHistogram inquiry;           // 带主动扫描的设备枚举
+    LatencyHistogram enumeration;       // 不扫描的已配对设备枚举
+    LatencyHistogram serviceToggle;     // 单个服务禁用→启用
+    LatencyHistogram reconnect;         // 观察到断开 → 再次连接
+    LatencyHistogram tick;              // 监控循环单次处理（MonitorCore::Step）
+
+    void RecordConnectSuccess(BtAddr address, const std::wstring& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ConnectOutcome& outcome = outcomes_[address & BT_ADDR_MASK];
+        outcome.name = name;
+        outcome.successes++;
+    }
+
+    void RecordConnectFailure(BtAddr address, const std::wstring& name, uint32_t errorCode) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ConnectOutcome& outcome = outcomes_[address & BT_ADDR_MASK];
+        outcome.name = name;
+        outcome.failures[errorCode]++;
+    }
+
+    std::map<BtAddr, ConnectOutcome> Outcomes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return outcomes_;
+    }
+
+    // 输出全部指标，每行一条
+    void Dump(std::wostream& out) {
+        DumpHistogram(out, L"主动扫描", inquiry);
+        DumpHistogram(out, L"设备枚举", enumeration);
+        DumpHistogram(out, L"服务切换", serviceToggle);
+        DumpHistogram(out, L"断开→重连", reconnect);
+        DumpHistogram(out, L"监控循环单次处理", tick);
+
+        for (const auto& entry : Outcomes()) {
+            const ConnectOutcome& outcome = entry.second;
+            out << L"[指标] " << outcome.name << L" [" << BtAddrToString(entry.first) << L"]：成功 " << outcome.successes;
+            for (const auto& failure : outcome.failures) {
+                out << L"，错误 " << failure.first << L" × " << failure.second;
+            }
+            out << L"\n";
+        }
+    }
+
+private:
+    static void DumpHistogram(std::wostream& out, const wchar_t* label, const LatencyHistogram& histogram) {
+        HistogramSnapshot s = histogram.Snapshot();
+        out << L"[指标] " << label << L"：" << s.count << L" 次";
+        if (s.count > 0) {
+            out << L"，平均 " << FormatMs(s.MeanUs()) << L"，p50 " << FormatMs(s.PercentileUs(50))
+                << L"，p90 " << FormatMs(s.PercentileUs(90)) << L"，p99 " << FormatMs(s.PercentileUs(99))
+                << L"，最大 " << FormatMs(s.maxUs);
+        }
+        out << L"\n";
+    }
+
+    static std::wstring FormatMs(uint64_t us) {
+        std::wstring text = std::to_wstring(us / 1000);
+        if (us < 10000) text += L"." + std::to_wstring(us / 100 % 10);
+        return text + L" ms";
+    }
+
+    std::mutex mutex_;
+    std::map<BtAddr, ConnectOutcome> outcomes_;
+};
@@ -0,0 +1,584 @@
+#pragma once
+
+// 监控核心：控制台与 GUI 共用的监控循环逻辑（处理重连结果、在场事件、轮询/扫描结果与到期的探测）。
+// 平台相关的部分通过接口注入：
+// - IBluetoothBackend：枚举已配对设备、确认连接状态、发起连接（Windows 实现在各 .cpp 中，模拟实现在 SimBluetooth.h）
+// - IReconnectExecutor：重连的执行方式（ReconnectPool 工作线程，或按虚拟时间完成的模拟执行器）
+// - IMonitorHost：日志、统计输出、设备列表刷新等界面相关的回调
+// - IInquiryStage（可选）：主动扫描在独立阶段中异步执行（InquiryStage.h）；不设置时在 Step 中同步扫描
+// 主动扫描到期时由 InquiryPlanner 决定是否真的扫描（有需要发现的设备、未超出每分钟预算）。
+// 重连任务带取消标记（SetCancelToken，停止监控时取消）与截止时间（SetConnectDeadlineMs），由后端在每次 API 调用之间检查。
+// 设置 ArrivalPredictor 后从连接状态变化学习到达时段：离线设备都预计不会很快到达时改用稀疏扫描间隔。
+// 枚举/扫描结果先交给 DeviceFeed，只按其产生的变化更新注册表；界面等通过 Feed().Subscribe 订阅同一组变化。
+// 被监控设备都已连接（或被手动断开）时调度器进入空闲：不安排主动扫描、兜底轮询拉长，每小时的唤醒次数随统计输出。
+// 调用方负责等待（PresenceEngine::WaitFor 或虚拟时钟），每次唤醒调用一次 Step。
+
+#include "ArrivalPredictor.h"
+#include "BtTypes.h"
+#include "Cancellation.h"
+#include "Clock.h"
+#include "DeviceFeed.h"
+#include "DeviceRegistry.h"
+#include "InquiryPlanner.h"
+#include "Metrics.h"
+#include "MonitorScheduler.h"
+#include "PresenceEngine.h"
+#include "ReconnectPool.h"
+
+#include <cstdint>
+#include <cwchar>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class IBluetoothBackend {
+public:
+    virtual ~IBluetoothBackend() {}
+    // 枚举全部适配器上的已配对设备并记下所属适配器；inquiry 为 true 时先主动扫描（可能耗时数秒）
+    virtual void EnumeratePaired(bool inquiry, std::vector<PairedDevice>& out) = 0;
+    // 直接查询设备当前是否已连接，用于二次确认断开（不持有注册表锁时调用）
+    virtual bool IsConnected(BtAddr address) = 0;
+    // 通过所属适配器连接设备（在重连执行器中调用，可能阻塞数秒）；op 被取消或超过截止时间时尽快返回 false
+    virtual bool Connect(BtAddr address, int radio, const std::wstring& name, OperationContext& op) = 0;
+};
+
+// 异步的主动扫描阶段：Begin 发起一次带扫描的枚举，完成后由 TakeResult 取回
+class IInquiryStage {
+public:
+    virtual ~IInquiryStage() {}
+    // 发起扫描；上一次仍在进行时返回 false
+    virtual bool Begin() = 0;
+    // 取出已完成的扫描结果，没有时返回 false
+    virtual bool TakeResult(std::vector<PairedDevice>& out) = 0;
+};
+
+class IMonitorHost {
+public:
+    virtual ~IMonitorHost() {}
+    virtual void Log(const std::wstring& line) { (void)line; }
+    // 开始处理某个在场事件，返回检测→处理延迟（微秒）
+    virtual uint64_t NoteReaction(const PresenceEvent& ev) { (void)ev; return 0; }
+    // 事件源失效（通常意味着适配器被移除）
+    virtual void OnEventSourceLost() {}
+    // 重连结果或事件改变了设备状态且本轮没有轮询（不持有注册表锁）
+    virtual void OnStateChanged() {}
+    // 定期统计输出（不持有注册表锁）
+    virtual void OnReport() {}
+    // 记录了新的到达，可持久化到达记录（不持有注册表锁）
+    virtual void OnArrivalsLearned() {}
+    virtual bool StopRequested() { return false; }
+};
+
+struct MonitorCoreStats {
+    uint64_t steps = 0;             // 监控循环的唤醒次数
+    uint64_t emptySteps = 0;        // 其中没有事件、结果或到期工作的
+    uint64_t polls = 0;
+    uint64_t inquiries = 0;
+    uint64_t inquiriesSkipped = 0;  // 到期时上一次扫描仍在进行
+    uint64_t inquiriesPlannedOut = 0;   // 到期时规划判断无需扫描或超出预算
+    uint64_t events = 0;
+    uint64_t reconnectsSubmitted = 0;
+    uint64_t reconnectsSucceeded = 0;
+    uint64_t reconnectsFailed = 0;
+    uint64_t connectsObserved = 0;
+    uint64_t disconnectsObserved = 0;
+};
+
+class MonitorCore {
+public:
+    // 构造与 Start 期间调用方需保证注册表不被并发修改（GUI 持有注册表锁）
+    MonitorCore(IClock& clock, DeviceRegistry& registry, IBluetoothBackend& backend, IReconnectExecutor& reconnects,
+        IMonitorHost& host, const SchedulerOptions& options = SchedulerOptions())
+        : clock_(clock), registry_(registry), backend_(backend), reconnects_(reconnects), host_(host),
+          scheduler_(clock, registry, options), planner_(clock), startMs_(clock.NowMs()) {
+        line_.reserve(256);     // 与 GUI 日志环的槽位长度相同，统计行也不必扩容
+    }
+
+    MonitorCore(const MonitorCore&) = delete;
+    MonitorCore& operator=(const MonitorCore&) = delete;
+
+    // 注册表与其他线程共享时传入其互斥量，Step 只在访问注册表期间持有
+    void SetRegistryMutex(std::mutex* mutex) { registryMutex_ = mutex; }
+
+    // 断开→重连耗时记录到 metrics->reconnect，每次 Step 的耗时记录到 metrics->tick
+    void SetMetrics(Metrics* metrics) { metrics_ = metrics; }
+
+    // 主动扫描改为在 stage 中异步执行
+    void SetInquiryStage(IInquiryStage* stage) { inquiryStage_ = stage; }
+
+    // 每分钟主动扫描的时长预算（毫秒），0 表示不再主动扫描
+    void SetInquiryBudget(int msPerMinute) { planner_.SetBudgetMsPerMinute(msPerMinute); }
+
+    // 之后提交的重连使用的取消标记；停止监控时取消，进行中的重连在下一次 API 调用前结束
+    void SetCancelToken(CancelToken token) { cancel_ = token; }
+
+    // 每次重连从开始执行起的截止时间（毫秒）
+    void SetConnectDeadlineMs(int64_t ms) { connectDeadlineMs_ = ms; }
+
+    // 学习并使用到达时段；一天中的时刻取 (clock.NowMs() + dayOffsetMs) 对一天取模（调用方换算到本地时间）
+    void SetArrivalPredictor(ArrivalPredictor* predictor, int64_t dayOffsetMs) {
+        arrivals_ = predictor;
+        dayOffsetMs_ = dayOffsetMs;
+    }
+
+    // 安排轮询/扫描，并为所有离线的被监控设备安排探测
+    void Start(bool eventDriven) {
+        scheduler_.Start(eventDriven);
+        for (const auto& record : registry_) {
+            if (record.monitored && !record.connected) scheduler_.OnDeviceLost(record.address);
+        }
+        UpdateIdle();
+        reportStartMs_ = clock_.NowMs();
+    }
+
+    // 距离下一项调度工作的毫秒数，没有任何计划时返回 -1
+    int64_t MsUntilNext() { return scheduler_.MsUntilNext(); }
+
+    // 启动以来平均每小时的唤醒次数
+    double WakeupsPerHour() const {
+        int64_t elapsed = clock_.NowMs() - startMs_;
+        return elapsed > 0 ? stats_.steps * 3600000.0 / elapsed : 0.0;
+    }
+
+    // 处理一次唤醒：events 为本次收到的在场事件，sourceAlive 为事件源当前是否可用
+    void Step(const std::vector<PresenceEvent>& events, bool sourceAlive) {
+        int64_t stepStart = clock_.NowMs();
+        stats_.steps++;
+        if (!sourceAlive && scheduler_.IsEventDriven()) host_.OnEventSourceLost();
+        scheduler_.SetEventDriven(sourceAlive);
+
+        RegistryLock lock(registryMutex_);
+        bool stateChanged = false;
+
+        // 取回已完成的重连结果
+        size_t drained = reconnects_.DrainResults(results_);
+        if (drained > 0) {
+            for (const auto& result : results_) {
+                DeviceRecord* record = FindMonitored(result.address);
+                if (!record) continue;
+                LogLine(L"  ", record->name, result.connected ? L" 重连成功" : L" 重连失败",
+                    L"（排队 ", result.queueDelayMs, L" ms，耗时 ", result.runMs, L" ms）");
+                if (result.connected) {
+                    stats_.reconnectsSucceeded++;
+                    if (!record->connected) MarkConnected(*record);
+                    stateChanged = true;
+                } else {
+                    stats_.reconnectsFailed++;
+                    if (!record->connected) scheduler_.OnAttemptFailed(result.address);
+                }
+            }
+        }
+
+        // 事件驱动：只处理被监控设备的状态变化
+        checks_.clear();
+        for (const auto& ev : events) {
+            if (host_.StopRequested()) break;
+            stats_.events++;
+            DeviceRecord* record = FindMonitored(ev.address);
+            if (!record) continue;
+
+            switch (ev.type) {
+            case PresenceEventType::Connected:
+                if (!record->connected) {
+                    host_.NoteReaction(ev);
+                    LogLine(L"[事件] ✅ 设备已连接: ", record->name);
+                    MarkConnected(*record);
+                    stateChanged = true;
+                }
+                break;
+            case PresenceEventType::Disconnected:
+            case PresenceEventType::Departed:
+                if (record->connected) checks_.push_back(DisconnectCheck{ record->address, &ev, false });
+                break;
+            case PresenceEventType::Arrived:
+                if (!record->connected && !reconnects_.IsPending(ev.address)) {
+                    uint64_t us = host_.NoteReaction(ev);
+                    LogLine(L"[事件] 🔍 设备进入范围（", us / 1000, L" ms），尝试连接: ", record->name);
+                    TryReconnect(*record);
+                }
+                break;
+            }
+        }
+        if (!checks_.empty()) {
+            ConfirmDisconnects(lock);
+            for (const auto& check : checks_) {
+                DeviceRecord* record = FindMonitored(check.address);
+                if (!record || !record->connected || check.stillConnected) continue;
+                host_.NoteReaction(*check.event);
+                LogLine(L"[事件] ❌ 设备已断开: ", record->name);
+                MarkDisconnected(*record);
+                stateChanged = true;
+            }
+        }
+
+        // 到期的调度工作
+        bool doPoll = false;
+        bool doInquiry = false;
+        bool doReport = false;
+        scheduler_.Collect(dueWork_);
+        for (const auto& work : dueWork_) {
+            if (work.kind == ScheduledWork::Poll) doPoll = true;
+            else if (work.kind == ScheduledWork::Inquiry) doInquiry = true;
+            else if (work.kind == ScheduledWork::Report) doReport = true;
+        }
+        if (doInquiry) {
+            InquiryDemand demand = MeasureInquiryDemand();
+            scheduler_.SetInquiryDense(demand.dense);
+            if (planner_.Decide(demand.target) != InquiryDecision::Scan) {
+                stats_.inquiriesPlannedOut++;
+                doInquiry = false;
+            }
+        }
+        lock.Unlock();
+
+        if (doReport) {
+            LogWakeStats();
+            LogInquiryStats();
+            host_.OnReport();
+        }
+        if (host_.StopRequested()) return;
+
+        // 异步扫描：到期时只发起，完成的结果先于本轮枚举应用（枚举结果更新）
+        if (inquiryStage_) {
+            if (doInquiry) BeginInquiry();
+            doInquiry = false;
+            if (inquiryStage_->TakeResult(inquiryResult_)) {
+                drained++;
+                planner_.OnScanFinished();
+                ApplyPaired(inquiryResult_, lock);
+                stateChanged = false;
+            }
+        }
+
+        // 枚举/扫描可能耗时数秒，期间不持有注册表锁
+        if (doPoll || doInquiry) {
+            Poll(doInquiry, lock);
+            stateChanged = false;
+        }
+
+        // 离线设备的探测到期：检查手动断开阻止与冷却期后提交重连
+        lock.Lock();
+        for (const auto& work : dueWork_) {
+            if (host_.StopRequested()) break;
+            if (work.kind != ScheduledWork::Probe) continue;
+            DeviceRecord* record = FindMonitored(work.address);
+            if (!record || record->connected || reconnects_.IsPending(work.address)) continue;
+            LogLine(L"[", checkCount_, L"] 🔍 发现设备未连接，尝试连接: ", record->name);
+            TryReconnect(*record);
+        }
+        // 空闲时每次唤醒都重新判断（很少发生），其他时候只在连接状态变化或轮询后判断
+        if (idleDirty_ || doPoll || scheduler_.IsIdle()) UpdateIdle();
+        lock.Unlock();
+
+        if (events.empty() && dueWork_.empty() && drained == 0) stats_.emptySteps++;
+
+        if (stateChanged) host_.OnStateChanged();
+        if (arrivalsLearned_) {
+            arrivalsLearned_ = false;
+            host_.OnArrivalsLearned();
+        }
+        if (metrics_) metrics_->tick.RecordMs((uint64_t)(clock_.NowMs() - stepStart));
+    }
+
+    MonitorScheduler& Scheduler() { return scheduler_; }
+
+    // 已配对设备的变化流；订阅者在调用 Step 的线程中、不持有注册表锁时收到通知，应在 Start 前注册
+    DeviceFeed& Feed() { return feed_; }
+
+    // 只能在调用 Step 的线程中使用
+    InquiryPlanner& Planner() { return planner_; }
+
+    const MonitorCoreStats& Stats() const { return stats_; }
+
+private:
+    // 可选的注册表锁：没有互斥量时为空操作
+    class RegistryLock {
+    public:
+        explicit RegistryLock(std::mutex* mutex) : mutex_(mutex) { Lock(); }
+        ~RegistryLock() { Unlock(); }
+        void Lock() {
+            if (mutex_ && !locked_) mutex_->lock();
+            locked_ = true;
+        }
+        void Unlock() {
+            if (mutex_ && locked_) mutex_->unlock();
+            locked_ = false;
+        }
+    private:
+        std::mutex* mutex_;
+        bool locked_ = false;
+    };
+
+    // 日志行在复用的缓冲区中拼接后交给 host_，稳态下不分配内存；各部分为字符串或整数
+    template <typename... Parts>
+    void LogLine(const Parts&... parts) {
+        line_.clear();
+        (AppendLogPart(parts), ...);
+        host_.Log(line_);
+    }
+
+    void AppendLogPart(const wchar_t* text) { line_ += text; }
+    void AppendLogPart(const std::wstring& text) { line_ += text; }
+
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    void AppendLogPart(T value) {
+        wchar_t digits[24];
+        if (std::is_signed<T>::value) swprintf(digits, 24, L"%lld", (long long)value);
+        else swprintf(digits, 24, L"%llu", (unsigned long long)value);
+        line_ += digits;
+    }
+
+    // 只返回被监控设备的记录；指针仅在持有注册表锁期间有效
+    DeviceRecord* FindMonitored(BtAddr address) {
+        DeviceRecord* record = registry_.Find(address);
+        return record && record->monitored ? record : nullptr;
+    }
+
+    void MarkConnected(DeviceRecord& record) {
+        record.connected = true;
+        record.connects++;
+        stats_.connectsObserved++;
+        if (arrivals_) {
+            // 启动时就离线的设备按启动以来的时长计算离线时间
+            int64_t now = clock_.NowMs();
+            int64_t absence = now - (record.disconnectedAtMs >= 0 ? record.disconnectedAtMs : startMs_);
+            if (arrivals_->RecordArrival(record.address, now + dayOffsetMs_, absence)) arrivalsLearned_ = true;
+        }
+        if (record.disconnectedAtMs >= 0) {
+            if (metrics_) metrics_->reconnect.RecordMs((uint64_t)(clock_.NowMs() - record.disconnectedAtMs));
+            record.disconnectedAtMs = -1;
+        }
+        scheduler_.OnDeviceConnected(record.address);
+        idleDirty_ = true;
+        ReconcileFeed(record);
+    }
+
+    void MarkDisconnected(DeviceRecord& record) {
+        record.connected = false;
+        record.disconnects++;
+        stats_.disconnectsObserved++;
+        record.disconnectedAtMs = clock_.NowMs();
+        scheduler_.OnDeviceLost(record.address);
+        idleDirty_ = true;
+        ReconcileFeed(record);
+    }
+
+    // 事件或重连结果改变了注册表状态而变化流中的状态不同时，让下一次枚举重新报告该设备，
+    // 否则枚举结果与上一次相同就不会产生变化，注册表与实际状态的差异得不到纠正
+    void ReconcileFeed(const DeviceRecord& record) {
+        int slot = feed_.Find(record.address);
+        if (slot >= 0 && feed_.Devices().Flag((size_t)slot, DeviceFlag::Connected) != record.connected) {
+            feed_.Invalidate(record.address);
+        }
+    }
+
+    // 对 checks_ 中的设备二次确认是否仍连接。查询实际连接状态可能较慢，期间不持有注册表锁；
+    // 返回时已重新加锁，调用方须重新查找记录（期间记录可能已被其他线程修改）
+    void ConfirmDisconnects(RegistryLock& lock) {
+        lock.Unlock();
+        for (auto& check : checks_) check.stillConnected = backend_.IsConnected(check.address);
+        lock.Lock();
+    }
+
+    // 用户手动断开的设备不自动重连；冷却期内跳过
+    bool TryReconnect(DeviceRecord& record) {
+        if (record.blockAutoReconnect) {
+            LogLine(L"  ⏸ 用户手动断开，跳过自动重连: ", record.name);
+            scheduler_.CancelProbe(record.address);
+            return false;
+        }
+        if (scheduler_.InCooldown(record.address)) {
+            LogLine(L"  ⏱ 冷却中，跳过本次重连: ", record.name);
+            return false;
+        }
+        scheduler_.OnAttemptStarted(record.address);
+        IBluetoothBackend& backend = backend_;
+        IClock& clock = clock_;
+        CancelToken cancel = cancel_;
+        int64_t deadlineMs = connectDeadlineMs_;
+        BtAddr address = record.address;
+        int radio = record.radio;
+        std::wstring name = record.name;
+        bool submitted = reconnects_.Submit(address, radio, [&backend, &clock, cancel, deadlineMs, address, radio, name]() {
+            OperationContext op(clock, cancel, deadlineMs);
+            return backend.Connect(address, radio, name, op);
+        });
+        if (submitted) stats_.reconnectsSubmitted++;
+        return submitted;
+    }
+
+    struct InquiryDemand {
+        bool target = false;    // 存在不在冷却期、没有进行中重连的离线设备，值得扫描
+        bool dense = true;      // 没有到达预测，或有离线设备尚无规律/预计即将到达
+    };
+
+    // 只考虑被监控、未连接且未被手动断开阻止的设备（需持有注册表锁）
+    InquiryDemand MeasureInquiryDemand() {
+        InquiryDemand demand;
+        bool offline = false;
+        bool expected = false;
+        int64_t msOfDay = clock_.NowMs() + dayOffsetMs_;
+        for (const auto& record : registry_) {
+            if (!record.monitored || record.connected || record.blockAutoReconnect) continue;
+            offline = true;
+            if (!expected && arrivals_ && arrivals_->Outlook(record.address, msOfDay) != ArrivalOutlook::Unlikely) {
+                expected = true;
+            }
+            if (!demand.target && !scheduler_.InCooldown(record.address) && !reconnects_.IsPending(record.address)) {
+                demand.target = true;
+            }
+            if (demand.target && (expected || !arrivals_)) break;
+        }
+        demand.dense = !arrivals_ || !offline || expected;
+        return demand;
+    }
+
+    // 没有需要重连的被监控设备时调度器进入空闲（需持有注册表锁）
+    void UpdateIdle() {
+        idleDirty_ = false;
+        bool idle = true;
+        for (const auto& record : registry_) {
+            if (record.monitored && !record.connected && !record.blockAutoReconnect) {
+                idle = false;
+                break;
+            }
+        }
+        scheduler_.SetIdle(idle);
+    }
+
+    // 距上一次统计输出的唤醒次数，换算为每小时
+    void LogWakeStats() {
+        int64_t now = clock_.NowMs();
+        int64_t elapsed = now - reportStartMs_;
+        uint64_t steps = stats_.steps - reportSteps_;
+        uint64_t empty = stats_.emptySteps - reportEmptySteps_;
+        LogLine(L"[统计] 监控循环唤醒：最近 ", elapsed / 60000, L" 分钟 ", steps, L" 次（约 ",
+            elapsed > 0 ? (uint64_t)(steps * 3600000 / (uint64_t)elapsed) : 0, L" 次/小时），其中无事可做 ", empty,
+            L" 次；", scheduler_.IsIdle() ? L"当前空闲" : L"当前有离线设备");
+        reportStartMs_ = now;
+        reportSteps_ = stats_.steps;
+        reportEmptySteps_ = stats_.emptySteps;
+    }
+
+    void LogInquiryStats() {
+        InquiryPlannerStats s = planner_.Stats();
+        LogLine(L"[统计] 主动扫描：", s.scans, L" 次，共 ", s.airtimeMs / 1000, L" 秒（约 ", (uint64_t)s.SecondsPerHour(),
+            L" 秒/小时），无需扫描跳过 ", s.skippedIdle, L" 次，超出预算跳过 ", s.skippedBudget,
+            L" 次（预算 ", planner_.BudgetMsPerMinute(), L" ms/分钟）");
+        if (!arrivals_) return;
+        ArrivalPredictorStats a = arrivals_->Stats();
+        LogLine(L"[统计] 到达预测：记录 ", a.devices, L" 台设备（已有规律 ", a.learned, L" 台），本次运行到达 ", a.arrivals,
+            L" 次，其中已有规律 ", a.predicted, L" 次、落在预计时段 ", a.hits, L" 次；当前扫描间隔 ",
+            scheduler_.InquiryIntervalMs() / 1000, L" 秒");
+    }
+
+    void BeginInquiry() {
+        if (!inquiryStage_->Begin()) {
+            stats_.inquiriesSkipped++;
+            return;
+        }
+        planner_.OnScanStarted();
+        scanCount_++;
+        stats_.inquiries++;
+        LogLine(L"[", checkCount_, L"] 执行主动扫描 #", scanCount_, L"...");
+    }
+
+    // 枚举已配对设备并更新注册表
+    void Poll(bool inquiry, RegistryLock& lock) {
+        checkCount_++;
+        stats_.polls++;
+        if (inquiry) {
+            scanCount_++;
+            stats_.inquiries++;
+            LogLine(L"[", checkCount_, L"] 执行主动扫描 #", scanCount_, L"...");
+        }
+
+        if (inquiry) planner_.OnScanStarted();
+        backend_.EnumeratePaired(inquiry, paired_);
+        if (inquiry) planner_.OnScanFinished();
+        ApplyPaired(paired_, lock);
+    }
+
+    // 枚举/扫描结果交给变化流（先通知订阅者），再只按变化更新注册表（结果中没有的设备保持原状态）
+    void ApplyPaired(const std::vector<PairedDevice>& paired, RegistryLock& lock) {
+        feed_.Apply(paired);
+        lock.Lock();
+        checks_.clear();
+        for (const auto& change : feed_.Changes()) {
+            if (host_.StopRequested()) break;
+            if (change.type == DeviceChangeType::Vanished) continue;
+            DeviceRecord* record = FindMonitored(change.address);
+            if (!record) continue;
+            record->radio = change.radio;
+            if (change.type == DeviceChangeType::Renamed) record->name = *change.name;
+
+            if (change.connected && !record->connected) {
+                LogLine(L"[", checkCount_, L"] ✅ 设备已连接: ", record->name);
+                MarkConnected(*record);
+            } else if (!change.connected && record->connected) {
+                checks_.push_back(DisconnectCheck{ record->address, nullptr, false });
+            }
+        }
+        // 二次确认，避免误判（列表状态可能短暂不同步）；仍连接时下次枚举再确认
+        if (!checks_.empty()) {
+            ConfirmDisconnects(lock);
+            for (const auto& check : checks_) {
+                DeviceRecord* record = FindMonitored(check.address);
+                if (!record || !record->connected) continue;
+                if (check.stillConnected) {
+                    feed_.Invalidate(record->address);
+                    continue;
+                }
+                LogLine(L"[", checkCount_, L"] ❌ 设备已断开: ", record->name);
+                MarkDisconnected(*record);
+            }
+        }
+
+        // 手动断开的阻止被解除后重新安排探测（不依赖变化，逐台检查但不分配内存）
+        for (const auto& record : registry_) {
+            if (!record.monitored || record.connected || record.blockAutoReconnect) continue;
+            if (!reconnects_.IsPending(record.address)) scheduler_.EnsureProbe(record.address);
+        }
+        lock.Unlock();
+    }
+
+    IClock& clock_;
+    DeviceRegistry& registry_;
+    IBluetoothBackend& backend_;
+    IReconnectExecutor& reconnects_;
+    IMonitorHost& host_;
+    MonitorScheduler scheduler_;
+    InquiryPlanner planner_;
+    ArrivalPredictor* arrivals_ = nullptr;
+    int64_t dayOffsetMs_ = 0;
+    int64_t startMs_;
+    bool arrivalsLearned_ = false;
+    bool idleDirty_ = true;         // 连接状态变化后需重新判断是否空闲
+    int64_t reportStartMs_ = 0;     // 唤醒统计的当前周期
+    uint64_t reportSteps_ = 0;
+    uint64_t reportEmptySteps_ = 0;
+    std::mutex* registryMutex_ = nullptr;
+    Metrics* metrics_ = nullptr;
+    CancelToken cancel_;
+    int64_t connectDeadlineMs_ = 20000;     // 与 settings.txt 的 connect_deadline_ms 默认值相同
+
+    MonitorCoreStats stats_;
+    int checkCount_ = 0;
+    int scanCount_ = 0;     // 主动扫描次数
+    std::wstring line_;     // LogLine 的缓冲区
+    std::vector<ReconnectResult> results_;
+    std::vector<DueWork> dueWork_;
+
+    // 待二次确认断开的设备；event 为触发确认的在场事件，由枚举结果触发时为空
+    struct DisconnectCheck {
+        BtAddr address;
+        const PresenceEvent* event;
+        bool stillConnected;
+    };
+    std::vector<DisconnectCheck> checks_;
+    DeviceFeed feed_;
+    std::vector<PairedDevice> paired_;
+    IInquiryStage* inquiryStage_ = nullptr;
+    std::vector<PairedDevice> inquiryResult_;
+};
@@ -0,0 +1,255 @@
+#pragma once
+
+// 监控调度器：基于时间轮统一管理全局轮询、主动扫描以及每台设备的重连探测时间。
+// - 刚断开的设备很快探测一次，之后按冷却时间指数退避，长期离线的设备探测间隔逐步拉长
+// - 每台设备只有一个定时器，增删改均为 O(1)，不再每个周期遍历全部设备
+// - 空闲（被监控设备都已连接）时不安排主动扫描，事件源正常时兜底轮询拉长到 idlePollMs，监控循环几乎不被唤醒
+// - 时间来自 IClock，配合 VirtualClock 可以确定性地验证调度结果
+// 每台设备的探测状态保存在 DeviceRegistry 的记录中，未登记的设备会被忽略。
+
+#include "BtTypes.h"
+#include "Clock.h"
+#include "DeviceRegistry.h"
+#include "TimerWheel.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class ScheduledWork {
+    Poll = 0,       // 枚举已配对设备（不扫描）
+    Inquiry = 1,    // 主动扫描
+    Probe = 2,      // 对某台离线设备发起重连
+    Report = 3      // 定期输出统计
+};
+
+struct DueWork {
+    ScheduledWork kind;
+    BtAddr address;     // 仅 Probe 有效
+};
+
+struct SchedulerOptions {
+    int fallbackPollMs = 5000;      // 没有事件源时的轮询间隔
+    int eventPollMs = 15000;        // 事件源正常时的兜底轮询间隔
+    int idlePollMs = 600000;        // 事件源正常且空闲时的兜底轮询间隔（事件源只在覆盖全部适配器时报告正常）
+    int inquiryMs = 15000;          // 主动扫描间隔（原先每 3 次 5 秒轮询扫描一次）
+    int sparseInquiryMs = 60000;    // 离线设备都预计不会很快到达时的主动扫描间隔
+    int firstProbeMs = 1000;        // 设备刚断开后第一次探测的延迟
+    int cooldownMs = 8000;          // 同一设备两次连接尝试的最小间隔
+    int maxProbeMs = 60000;         // 探测退避的上限
+    int reportMs = 3600000;         // 统计输出间隔
+    int tickMs = 100;               // 时间轮精度
+};
+
+class MonitorScheduler {
+public:
+    // 注册表中遗留的探测状态属于之前的时间轮，构造时清除
+    MonitorScheduler(IClock& clock, DeviceRegistry& registry, const SchedulerOptions& options = SchedulerOptions())
+        : clock_(clock), registry_(registry), options_(options), wheel_(clock.NowMs(), options.tickMs) {
+        for (auto& record : registry_) {
+            record.probeTimer = TimerWheel::INVALID_TIMER;
+            record.probeFailures = 0;
+            record.attempted = false;
+        }
+    }
+
+    const SchedulerOptions& Options() const { return options_; }
+
+    // 安排第一次轮询、主动扫描与统计输出
+    void Start(bool eventDriven) {
+        eventDriven_ = eventDriven;
+        int64_t now = clock_.NowMs();
+        pollTimer_ = wheel_.Reschedule(pollTimer_, now + PollIntervalMs(), 0, (int)ScheduledWork::Poll);
+        if (!idle_) inquiryTimer_ = wheel_.Reschedule(inquiryTimer_, now + InquiryIntervalMs(), 0, (int)ScheduledWork::Inquiry);
+        if (options_.reportMs > 0) {
+            reportTimer_ = wheel_.Reschedule(reportTimer_, now + options_.reportMs, 0, (int)ScheduledWork::Report);
+        }
+    }
+
+    // 事件源可用性变化：失效时把下一次轮询提前到回退间隔内
+    void SetEventDriven(bool eventDriven) {
+        if (eventDriven == eventDriven_) return;
+        eventDriven_ = eventDriven;
+        RearmPoll(false);
+    }
+
+    bool IsEventDriven() const { return eventDriven_; }
+
+    // 空闲：没有需要重连的设备。进入时取消主动扫描、按新间隔推迟轮询；
+    // 离开时重新安排扫描，轮询不晚于正常间隔。没有事件源时轮询是发现断开的唯一途径，间隔不变
+    void SetIdle(bool idle) {
+        if (idle == idle_) return;
+        idle_ = idle;
+        if (idle) {
+            wheel_.Cancel(inquiryTimer_);
+            inquiryTimer_ = TimerWheel::INVALID_TIMER;
+        } else {
+            inquiryTimer_ = wheel_.Reschedule(inquiryTimer_, clock_.NowMs() + InquiryIntervalMs(), 0, (int)ScheduledWork::Inquiry);
+        }
+        RearmPoll(idle);
+    }
+
+    bool IsIdle() const { return idle_; }
+
+    int PollIntervalMs() const {
+        if (!eventDriven_) return options_.fallbackPollMs;
+        return idle_ ? options_.idlePollMs : options_.eventPollMs;
+    }
+
+    // 主动扫描改为密集（inquiryMs）或稀疏（sparseInquiryMs）间隔，下一次扫描按新间隔重新安排
+    // （转为密集时不推迟已经更近的扫描）
+    void SetInquiryDense(bool dense) {
+        if (dense == inquiryDense_) return;
+        inquiryDense_ = dense;
+        if (idle_) return;
+        int64_t next = clock_.NowMs() + InquiryIntervalMs();
+        int64_t current = wheel_.DeadlineOf(inquiryTimer_);
+        if (!dense || current < 0 || next < current) {
+            inquiryTimer_ = wheel_.Reschedule(inquiryTimer_, next, 0, (int)ScheduledWork::Inquiry);
+        }
+    }
+
+    bool IsInquiryDense() const { return inquiryDense_; }
+
+    int InquiryIntervalMs() const {
+        return inquiryDense_ ? options_.inquiryMs : options_.sparseInquiryMs;
+    }
+
+    // 设备离线（启动时未连接或刚断开）：重置退避，尽快探测
+    void OnDeviceLost(BtAddr address) {
+        DeviceRecord* d = registry_.Find(address);
+        if (!d) return;
+        d->probeFailures = 0;
+        ArmProbe(*d, options_.firstProbeMs);
+    }
+
+    // 设备已连接：取消探测
+    void OnDeviceConnected(BtAddr address) {
+        DeviceRecord* d = registry_.Find(address);
+        if (!d) return;
+        wheel_.Cancel(d->probeTimer);
+        d->probeTimer = TimerWheel::INVALID_TIMER;
+        d->probeFailures = 0;
+    }
+
+    // 发起了一次连接尝试（探测或事件触发）；结果出来之前不再探测
+    void OnAttemptStarted(BtAddr address) {
+        DeviceRecord* d = registry_.Find(address);
+        if (!d) return;
+        d->lastAttemptMs = clock_.NowMs();
+        d->attempted = true;
+        d->reconnectAttempts++;
+        wheel_.Cancel(d->probeTimer);
+        d->probeTimer = TimerWheel::INVALID_TIMER;
+    }
+
+    // 连接尝试失败：按指数退避安排下一次探测
+    void OnAttemptFailed(BtAddr address) {
+        DeviceRecord* d = registry_.Find(address);
+        if (!d) return;
+        d->probeFailures++;
+        d->reconnectFailures++;
+        ArmProbe(*d, BackoffMs(d->probeFailures));
+    }
+
+    // 没有探测计划时补一个（例如手动断开解除后），已有计划则保持不变
+    void EnsureProbe(BtAddr address) {
+        DeviceRecord* d = registry_.Find(address);
+        if (!d || wheel_.IsActive(d->probeTimer)) return;
+        ArmProbe(*d, 0);
+    }
+
+    // 不再探测该设备（例如被用户手动断开）
+    void CancelProbe(BtAddr address) {
+        DeviceRecord* d = registry_.Find(address);
+        if (!d) return;
+        wheel_.Cancel(d->probeTimer);
+        d->probeTimer = TimerWheel::INVALID_TIMER;
+    }
+
+    bool InCooldown(BtAddr address) {
+        return CooldownRemainingMs(address) > 0;
+    }
+
+    int64_t CooldownRemainingMs(BtAddr address) {
+        const DeviceRecord* d = registry_.Find(address);
+        if (!d || !d->attempted) return 0;
+        int64_t remaining = d->lastAttemptMs + options_.cooldownMs - clock_.NowMs();
+        return remaining > 0 ? remaining : 0;
+    }
+
+    // 下一次探测时间，没有计划返回 -1
+    int64_t ProbeDeadlineMs(BtAddr address) {
+        const DeviceRecord* d = registry_.Find(address);
+        return d ? wheel_.DeadlineOf(d->probeTimer) : -1;
+    }
+
+    // 收集到期的工作；轮询、主动扫描与统计输出会自动安排下一次
+    size_t Collect(std::vector<DueWork>& out) {
+        out.clear();
+        fired_.clear();
+        int64_t now = clock_.NowMs();
+        wheel_.Advance(now, fired_);
+
+        for (const auto& f : fired_) {
+            ScheduledWork kind = (ScheduledWork)f.kind;
+            if (kind == ScheduledWork::Poll) {
+                pollTimer_ = wheel_.Add(now + PollIntervalMs(), 0, (int)ScheduledWork::Poll);
+            } else if (kind == ScheduledWork::Inquiry) {
+                inquiryTimer_ = wheel_.Add(now + InquiryIntervalMs(), 0, (int)ScheduledWork::Inquiry);
+            } else if (kind == ScheduledWork::Report) {
+                reportTimer_ = wheel_.Add(now + options_.reportMs, 0, (int)ScheduledWork::Report);
+            } else {
+                DeviceRecord* d = registry_.Find(f.key);
+                if (d && d->probeTimer == f.handle) d->probeTimer = TimerWheel::INVALID_TIMER;
+            }
+            out.push_back(DueWork{ kind, (BtAddr)f.key });
+        }
+        return out.size();
+    }
+
+    // 距离下一项工作的毫秒数，没有任何计划时返回 -1
+    int64_t MsUntilNext() {
+        int64_t next = wheel_.NextDeadlineMs();
+        if (next < 0) return -1;
+        int64_t remaining = next - clock_.NowMs();
+        return remaining > 0 ? remaining : 0;
+    }
+
+    size_t PendingTimers() const { return wheel_.Size(); }
+
+private:
+    // 按当前间隔重新安排下一次轮询；later 为 false 时只提前、不推迟
+    void RearmPoll(bool later) {
+        int64_t next = clock_.NowMs() + PollIntervalMs();
+        int64_t current = wheel_.DeadlineOf(pollTimer_);
+        if (later || current < 0 || next < current) {
+            pollTimer_ = wheel_.Reschedule(pollTimer_, next, 0, (int)ScheduledWork::Poll);
+        }
+    }
+
+    int64_t BackoffMs(int failures) const {
+        int64_t delay = options_.cooldownMs;
+        for (int i = 1; i < failures && delay < options_.maxProbeMs; i++) delay *= 2;
+        return delay < options_.maxProbeMs ? delay : options_.maxProbeMs;
+    }
+
+    // 在 delayMs 后探测，但不早于冷却期结束
+    void ArmProbe(DeviceRecord& d, int64_t delayMs) {
+        int64_t now = clock_.NowMs();
+        int64_t at = now + delayMs;
+        if (d.attempted && d.lastAttemptMs + options_.cooldownMs > at) at = d.lastAttemptMs + options_.cooldownMs;
+        d.probeTimer = wheel_.Reschedule(d.probeTimer, at, d.address, (int)ScheduledWork::Probe);
+    }
+
+    IClock& clock_;
+    DeviceRegistry& registry_;
+    SchedulerOptions options_;
+    TimerWheel wheel_;
+    TimerWheel::Handle pollTimer_ = TimerWheel::INVALID_TIMER;
+    TimerWheel::Handle inquiryTimer_ = TimerWheel::INVALID_TIMER;
+    TimerWheel::Handle reportTimer_ = TimerWheel::INVALID_TIMER;
+    bool eventDriven_ = false;
+    bool inquiryDense_ = true;
+    bool idle_ = false;
+    std::vector<TimerWheel::Fired> fired_;
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+// 监控线程监督：一个常驻线程依次运行监控循环，任何时刻最多只有一个循环在运行。
+// Start/Stop/Restart 只修改期望状态并取消当前循环的标记，立即返回，不阻塞 UI 线程，也不另起清理线程；
+// 当前循环返回后由同一线程决定是否立即运行下一个（重启、修改监控列表后重新加载）。
+// 循环收到 CancelToken，应在其取消后尽快返回（C++17 没有 std::jthread/std::stop_token，用 Cancellation.h 代替）。
+// 重启耗时为从请求到新循环开始运行的时间。线程在第一次 Start 时创建，Shutdown/析构时取消并 join。线程安全。
+// 循环抛出的异常不会结束监督线程：按循环自行返回处理，计入 failures，并把 what() 交给 onFailure（在监督线程中调用）。
+
+#include "Cancellation.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+struct SupervisorStats {
+    uint64_t runs = 0;              // 运行过的循环
+    uint64_t restarts = 0;          // 其中接着上一个循环运行的（Restart，或停止过程中再次 Start）
+    int64_t lastRestartUs = 0;
+    int64_t maxRestartUs = 0;
+    int64_t totalRestartUs = 0;
+    bool active = false;            // 当前有循环在运行
+    uint64_t failures = 0;          // 因异常结束的循环
+    std::string lastFailure;        // 最近一次异常的 what()，非 std::exception 时为空
+
+    int64_t AvgRestartUs() const { return restarts ? totalRestartUs / (int64_t)restarts : 0; }
+};
+
+class MonitorSupervisor {
+public:
+    typedef std::function<void(const CancelToken&)> Loop;
+    typedef std::function<void(const std::string& what)> FailureHandler;
+
+    explicit MonitorSupervisor(Loop loop, FailureHandler onFailure = nullptr)
+        : loop_(std::move(loop)), onFailure_(std::move(onFailure)) {}
+
+    ~MonitorSupervisor() {
+        Shutdown();
+    }
+
+    MonitorSupervisor(const MonitorSupervisor&) = delete;
+    MonitorSupervisor& operator=(const MonitorSupervisor&) = delete;
+
+    // 开始运行；已在运行时不做任何事，正在停止时等当前循环返回后再运行
+    void Start() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (shutdown_ || wanted_) return;
+        wanted_ = true;
+        if (active_) MarkRerunLocked();
+        if (!thread_.joinable()) thread_ = std::thread(&MonitorSupervisor::ThreadLoop, this);
+        cv_.notify_all();
+    }
+
+    // 取消当前循环，之后不再运行
+    void Stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wanted_ = false;
+        rerun_ = false;
+        cancel_.Cancel();
+    }
+
+    // 取消当前循环，返回后立即运行新的循环；没有循环在运行时等同于 Start
+    void Restart() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (shutdown_) return;
+            if (active_) {
+                wanted_ = true;
+                MarkRerunLocked();
+                cancel_.Cancel();
+                return;
+            }
+        }
+        Start();
+    }
+
+    // 是否处于运行状态（包括重启过程中）；循环自行返回后为 false
+    bool IsRunning() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return wanted_;
+    }
+
+    // 取消当前循环并等待监督线程结束，之后不能再启动
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+            wanted_ = false;
+            rerun_ = false;
+            cancel_.Cancel();
+            cv_.notify_all();
+        }
+        if (thread_.joinable()) thread_.join();
+    }
+
+    SupervisorStats Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SupervisorStats s = stats_;
+        s.active = active_;
+        return s;
+    }
+
+private:
+    void MarkRerunLocked() {
+        if (rerun_) return;     // 同一次重启的多个请求按第一个计时
+        rerun_ = true;
+        requestedAt_ = std::chrono::steady_clock::now();
+    }
+
+    void ThreadLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this] { return shutdown_ || wanted_; });
+            if (shutdown_) return;
+
+            cancel_.Reset();
+            CancelToken token = cancel_.Token();
+            active_ = true;
+            stats_.runs++;
+            if (rerun_) {
+                rerun_ = false;
+                int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - requestedAt_).count();
+                stats_.restarts++;
+                stats_.lastRestartUs = us;
+                stats_.totalRestartUs += us;
+                if (us > stats_.maxRestartUs) stats_.maxRestartUs = us;
+            }
+            lock.unlock();
+
+            bool failed = true;
+            std::string what;
+            try {
+                loop_(token);
+                failed = false;
+            } catch (const std::exception& e) {
+                what = e.what();
+            } catch (...) {
+            }
+            if (failed && onFailure_) onFailure_(what);
+
+            lock.lock();
+            if (failed) {
+                stats_.failures++;
+                stats_.lastFailure = what;
+            }
+            active_ = false;
+            if (!rerun_) wanted_ = false;   // 循环自行返回或已停止
+        }
+    }
+
+    Loop loop_;
+    FailureHandler onFailure_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    CancelSource cancel_;
+    bool wanted_ = false;       // 期望有循环在运行
+    bool active_ = false;       // 循环正在运行
+    bool rerun_ = false;        // 当前循环返回后立即再运行
+    bool shutdown_ = false;
+    std::chrono::steady_clock::time_point requestedAt_;
+    SupervisorStats stats_;
+};
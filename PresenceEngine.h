@@ -0,0 +1,215 @@
+#pragma once
+
+// 设备在场检测引擎：由可插拔事件源推送连接/断开/进入范围通知，
+// 监控循环在毫秒级内被唤醒处理。轮询/扫描的节奏由 MonitorScheduler 决定，
+// 引擎只负责在事件到达或调度截止时间到期时唤醒监控循环。
+
+#include "BtTypes.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+enum class PresenceEventType {
+    Arrived,        // 设备进入范围（可连接）
+    Departed,       // 设备离开范围
+    Connected,      // 链路已建立
+    Disconnected    // 链路已断开
+};
+
+struct PresenceEvent {
+    PresenceEventType type;
+    BtAddr address;
+    std::chrono::steady_clock::time_point observedAt;   // 事件源观测到的时间，用于统计检测→处理延迟
+};
+
+// 事件接收方（由引擎实现，事件源在任意线程回调）
+class IPresenceSink {
+public:
+    virtual ~IPresenceSink() {}
+    virtual void OnPresenceEvent(const PresenceEvent& ev) = 0;
+    // 事件源可用性变化（例如适配器被移除、通知注册失效）
+    virtual void OnSourceState(bool alive) = 0;
+};
+
+// 可插拔事件源：Windows 设备通知、模拟事件源等
+class IPresenceSource {
+public:
+    virtual ~IPresenceSource() {}
+    virtual const wchar_t* Name() const = 0;
+    // 成功开始投递事件时返回 true；之后的可用性变化通过 IPresenceSink::OnSourceState 通知
+    virtual bool Start(IPresenceSink* sink) = 0;
+    virtual void Stop() = 0;
+};
+
+struct PresenceOptions {
+    int waitSliceMs = 0;            // WaitFor 的最长阻塞时间（0 表示不限），便于调用方检查自己的退出标志
+};
+
+enum class PresenceWake {
+    Events,     // 收到事件
+    Timeout,    // 等待时间到期（调度的工作可能已到期）
+    Interrupted,// 被 Interrupt 唤醒（例如后台任务完成、事件源可用性变化）
+    Stopped     // 引擎已停止
+};
+
+struct PresenceStats {
+    uint64_t eventsReceived = 0;
+    uint64_t reactions = 0;
+    uint64_t totalReactionUs = 0;
+    uint64_t maxReactionUs = 0;
+    bool eventDriven = false;
+};
+
+class PresenceEngine : public IPresenceSink {
+public:
+    explicit PresenceEngine(const PresenceOptions& options = PresenceOptions())
+        : options_(options) {}
+
+    ~PresenceEngine() {
+        Stop();
+    }
+
+    PresenceEngine(const PresenceEngine&) = delete;
+    PresenceEngine& operator=(const PresenceEngine&) = delete;
+
+    // 事件源由调用方持有，需在引擎 Stop 之后才能销毁
+    void AddSource(IPresenceSource* source) {
+        sources_.push_back(source);
+    }
+
+    // 启动所有事件源；返回是否至少有一个事件源可用（否则工作在轮询模式）
+    bool Start() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = false;
+            interrupted_ = false;
+            liveSources_ = 0;
+            queue_.clear();
+        }
+        int live = 0;
+        for (auto* source : sources_) {
+            if (source->Start(this)) live++;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        liveSources_ += live;
+        started_ = true;
+        return liveSources_ > 0;
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!started_) return;
+            started_ = false;
+        }
+        for (auto* source : sources_) source->Stop();
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        liveSources_ = 0;
+        cv_.notify_all();
+    }
+
+    // 阻塞等待最多 timeoutMs（负数表示不限，同时受 waitSliceMs 限制）：有事件立即返回 Events
+    PresenceWake WaitFor(std::vector<PresenceEvent>& events, int64_t timeoutMs) {
+        events.clear();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        auto deadline = std::chrono::steady_clock::time_point::max();
+        if (timeoutMs >= 0) deadline = now + std::chrono::milliseconds(timeoutMs);
+        if (options_.waitSliceMs > 0) {
+            auto sliceEnd = now + std::chrono::milliseconds(options_.waitSliceMs);
+            if (sliceEnd < deadline) deadline = sliceEnd;
+        }
+
+        while (true) {
+            if (stopping_) return PresenceWake::Stopped;
+
+            if (!queue_.empty()) {
+                events.assign(queue_.begin(), queue_.end());
+                queue_.clear();
+                interrupted_ = false;
+                return PresenceWake::Events;
+            }
+
+            if (interrupted_) {
+                interrupted_ = false;
+                return PresenceWake::Interrupted;
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline) return PresenceWake::Timeout;
+
+            if (deadline == std::chrono::steady_clock::time_point::max()) cv_.wait(lock);
+            else cv_.wait_until(lock, deadline);
+        }
+    }
+
+    // 唤醒正在 WaitFor 的线程（或让下一次 WaitFor 立即返回），不产生事件
+    void Interrupt() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        interrupted_ = true;
+        cv_.notify_one();
+    }
+
+    // 监控循环开始处理某个事件（例如发起连接）时调用，返回检测→处理延迟（微秒）
+    uint64_t NoteReaction(const PresenceEvent& ev) {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - ev.observedAt).count();
+        uint64_t us = latency > 0 ? (uint64_t)latency : 0;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.reactions++;
+        stats_.totalReactionUs += us;
+        if (us > stats_.maxReactionUs) stats_.maxReactionUs = us;
+        return us;
+    }
+
+    bool IsEventDriven() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return liveSources_ > 0;
+    }
+
+    PresenceStats Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PresenceStats s = stats_;
+        s.eventDriven = liveSources_ > 0;
+        return s;
+    }
+
+    void OnPresenceEvent(const PresenceEvent& ev) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        queue_.push_back(ev);
+        stats_.eventsReceived++;
+        cv_.notify_one();
+    }
+
+    void OnSourceState(bool alive) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (alive) {
+            liveSources_++;
+        } else if (liveSources_ > 0) {
+            liveSources_--;
+        }
+        // 唤醒监控循环，由调度器按新的模式调整轮询间隔
+        interrupted_ = true;
+        cv_.notify_one();
+    }
+
+private:
+    PresenceOptions options_;
+    std::vector<IPresenceSource*> sources_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<PresenceEvent> queue_;
+    PresenceStats stats_;
+    int liveSources_ = 0;
+    bool started_ = false;
+    bool stopping_ = false;
+    bool interrupted_ = false;
+};
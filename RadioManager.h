@@ -0,0 +1,151 @@
+#pragma once
+
+// 无线电句柄管理：每个本地适配器只打开一次句柄，在各线程间共享；
+// 只有在调用方报告句柄出错或适配器被移除后才重新打开。
+// 各适配器互不影响：某个适配器的句柄出错只替换该适配器的句柄，其他适配器的句柄继续使用。
+// 句柄以 RadioLease 形式借出（引用计数），重新打开时旧句柄在最后一个借用者释放后才关闭。
+// 打开/关闭通过 IRadioBackend 完成，Windows 使用 WinRadioBackend，基准与测试使用模拟实现。
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+typedef void* RadioHandle;
+
+class IRadioBackend {
+public:
+    virtual ~IRadioBackend() {}
+    // 打开全部本地适配器，返回句柄（按系统枚举顺序）；没有适配器时返回空
+    virtual std::vector<RadioHandle> OpenRadios() = 0;
+    virtual void CloseRadio(RadioHandle handle) = 0;
+};
+
+struct RadioStats {
+    uint64_t acquires = 0;      // 借用次数
+    uint64_t reuses = 0;        // 直接复用已打开句柄的次数
+    uint64_t opens = 0;         // 枚举并打开适配器的次数
+    uint64_t reopens = 0;       // 出错/移除后重新打开的次数
+    uint64_t failures = 0;      // 调用方报告的句柄错误
+    size_t radios = 0;          // 当前打开的适配器数
+    std::vector<uint64_t> radioFailures;    // 按适配器下标的句柄错误
+};
+
+// 借用的适配器句柄；持有期间句柄保持有效
+class RadioLease {
+public:
+    RadioLease() {}
+
+    RadioHandle Get() const { return slot_ ? slot_->handle : nullptr; }
+    int Index() const { return index_; }
+    explicit operator bool() const { return slot_ != nullptr; }
+
+private:
+    friend class RadioManager;
+
+    struct Slot {
+        Slot(IRadioBackend& backend, RadioHandle h) : backend(backend), handle(h) {}
+        ~Slot() { backend.CloseRadio(handle); }
+        IRadioBackend& backend;
+        RadioHandle handle;
+    };
+
+    RadioLease(std::shared_ptr<Slot> slot, int index) : slot_(std::move(slot)), index_(index) {}
+
+    std::shared_ptr<Slot> slot_;
+    int index_ = -1;
+};
+
+class RadioManager {
+public:
+    explicit RadioManager(IRadioBackend& backend) : backend_(backend) {}
+
+    RadioManager(const RadioManager&) = delete;
+    RadioManager& operator=(const RadioManager&) = delete;
+
+    // 借用第 index 个适配器；尚未打开或已失效时先打开。不存在时返回空 RadioLease
+    RadioLease Acquire(int index = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.acquires++;
+        if (slots_.empty()) {
+            OpenLocked();
+        } else if (index >= 0 && index < (int)slots_.size() && !slots_[index]) {
+            RepairLocked();
+        } else {
+            stats_.reuses++;
+        }
+        if (index < 0 || index >= (int)slots_.size() || !slots_[index]) return RadioLease();
+        return RadioLease(slots_[index], index);
+    }
+
+    // 调用方使用句柄时遇到句柄/适配器错误：丢弃该适配器的句柄，下一次借用它时重新打开。
+    // 若句柄已被其他线程替换则忽略，避免同一次故障触发多次重新打开
+    void ReportFailure(const RadioLease& lease) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.failures++;
+        if (lease.index_ < 0 || lease.index_ >= (int)slots_.size()) return;
+        if ((size_t)lease.index_ >= stats_.radioFailures.size()) stats_.radioFailures.resize(lease.index_ + 1, 0);
+        stats_.radioFailures[lease.index_]++;
+        if (slots_[lease.index_] != lease.slot_) return;
+        slots_[lease.index_].reset();
+    }
+
+    // 适配器被移除或插入：丢弃全部句柄
+    void Invalidate() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        DropLocked();
+    }
+
+    size_t RadioCount() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slots_.empty()) OpenLocked();
+        return slots_.size();
+    }
+
+    RadioStats Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        RadioStats s = stats_;
+        s.radios = slots_.size();
+        return s;
+    }
+
+private:
+    void OpenLocked() {
+        std::vector<RadioHandle> handles = backend_.OpenRadios();
+        stats_.opens++;
+        if (dropped_) stats_.reopens++;
+        dropped_ = false;
+        for (RadioHandle h : handles) slots_.push_back(std::make_shared<RadioLease::Slot>(backend_, h));
+    }
+
+    // 重新打开全部适配器，只替换已丢弃的句柄，其余新句柄随即关闭；适配器数量变化时整体替换
+    void RepairLocked() {
+        std::vector<RadioHandle> handles = backend_.OpenRadios();
+        stats_.opens++;
+        stats_.reopens++;
+        if (handles.size() != slots_.size()) {
+            slots_.clear();
+            for (RadioHandle h : handles) slots_.push_back(std::make_shared<RadioLease::Slot>(backend_, h));
+            return;
+        }
+        for (size_t i = 0; i < handles.size(); i++) {
+            if (!slots_[i]) {
+                slots_[i] = std::make_shared<RadioLease::Slot>(backend_, handles[i]);
+            } else {
+                backend_.CloseRadio(handles[i]);
+            }
+        }
+    }
+
+    void DropLocked() {
+        if (slots_.empty()) return;
+        slots_.clear();
+        dropped_ = true;
+    }
+
+    IRadioBackend& backend_;
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<RadioLease::Slot>> slots_;
+    RadioStats stats_;
+    bool dropped_ = false;
+};
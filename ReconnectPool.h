@@ -0,0 +1,227 @@
+#pragma once
+
+// 重连工作池：监控循环把重连任务投递到固定数量的工作线程，
+// 每个无线电（适配器）有独立的并发上限，同一设备不会重复排队。
+// 完成结果由监控线程通过 DrainResults 取回，设备状态仍只在监控线程中修改。
+
+#include "BtTypes.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct ReconnectResult {
+    BtAddr address;
+    int radio;
+    bool connected;
+    int64_t queueDelayMs;   // 从提交到开始执行的等待时间
+    int64_t runMs;          // 执行耗时
+};
+
+struct ReconnectDeviceStats {
+    uint64_t attempts = 0;
+    uint64_t successes = 0;
+    int64_t lastQueueDelayMs = 0;
+    int64_t maxQueueDelayMs = 0;
+    int64_t totalQueueDelayMs = 0;
+};
+
+// 重连执行器：监控核心只通过该接口提交重连并取回结果。
+// ReconnectPool 在工作线程中执行；基准程序使用按虚拟时间完成的模拟实现
+class IReconnectExecutor {
+public:
+    typedef std::function<bool()> Task;
+
+    virtual ~IReconnectExecutor() {}
+    // 提交重连任务；同一设备已在排队或执行中时返回 false
+    virtual bool Submit(BtAddr address, int radio, Task task) = 0;
+    virtual bool IsPending(BtAddr address) = 0;
+    // 取出已完成的结果，返回取出的数量
+    virtual size_t DrainResults(std::vector<ReconnectResult>& out) = 0;
+};
+
+class ReconnectPool : public IReconnectExecutor {
+public:
+
+    ReconnectPool(int workerCount, int perRadioLimit)
+        : perRadioLimit_(perRadioLimit > 0 ? perRadioLimit : 1) {
+        if (workerCount < 1) workerCount = 1;
+        for (int i = 0; i < workerCount; i++) {
+            workers_.emplace_back(&ReconnectPool::WorkerLoop, this);
+        }
+    }
+
+    ~ReconnectPool() {
+        Shutdown();
+    }
+
+    ReconnectPool(const ReconnectPool&) = delete;
+    ReconnectPool& operator=(const ReconnectPool&) = delete;
+
+    // 单独设置某个无线电的并发上限
+    void SetRadioLimit(int radio, int limit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        radioLimits_[radio] = limit > 0 ? limit : 1;
+        cv_.notify_all();
+    }
+
+    // 有结果完成时回调（在工作线程中调用，可用于唤醒监控循环）
+    void SetCompletionNotifier(std::function<void()> notifier) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notifier_ = notifier;
+    }
+
+    bool Submit(BtAddr address, int radio, Task task) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || pending_.count(address) > 0) return false;
+        Job job;
+        job.address = address;
+        job.radio = radio;
+        job.task = task;
+        job.submittedAt = std::chrono::steady_clock::now();
+        queue_.push_back(job);
+        pending_.insert(address);
+        cv_.notify_all();
+        return true;
+    }
+
+    bool IsPending(BtAddr address) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_.count(address) > 0;
+    }
+
+    size_t DrainResults(std::vector<ReconnectResult>& out) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.assign(results_.begin(), results_.end());
+        results_.clear();
+        return out.size();
+    }
+
+    // 等待所有排队与执行中的任务结束
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleCv_.wait(lock, [this] { return pending_.empty(); });
+    }
+
+    // 丢弃尚未开始的任务，等待执行中的任务结束
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return;
+            stopping_ = true;
+            for (const auto& job : queue_) pending_.erase(job.address);
+            queue_.clear();
+            cv_.notify_all();
+        }
+        for (auto& t : workers_) {
+            if (t.joinable()) t.join();
+        }
+        idleCv_.notify_all();
+    }
+
+    size_t QueueDepth() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    ReconnectDeviceStats DeviceStats(BtAddr address) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = stats_.find(address);
+        return it != stats_.end() ? it->second : ReconnectDeviceStats();
+    }
+
+private:
+    struct Job {
+        BtAddr address;
+        int radio;
+        Task task;
+        std::chrono::steady_clock::time_point submittedAt;
+    };
+
+    int RadioLimitLocked(int radio) const {
+        auto it = radioLimits_.find(radio);
+        return it != radioLimits_.end() ? it->second : perRadioLimit_;
+    }
+
+    // 找到第一个所属无线电还有空闲并发额度的任务
+    bool TakeRunnableLocked(Job& out) {
+        for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+            if (running_[it->radio] < RadioLimitLocked(it->radio)) {
+                out = *it;
+                queue_.erase(it);
+                running_[out.radio]++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return stopping_ || TakeRunnableLocked(job); });
+                if (!job.task) return;  // stopping_ 且没有取到任务
+            }
+
+            auto startedAt = std::chrono::steady_clock::now();
+            bool connected = false;
+            try {
+                connected = job.task();
+            } catch (...) {
+                connected = false;
+            }
+            auto finishedAt = std::chrono::steady_clock::now();
+
+            ReconnectResult result;
+            result.address = job.address;
+            result.radio = job.radio;
+            result.connected = connected;
+            result.queueDelayMs = std::chrono::duration_cast<std::chrono::milliseconds>(startedAt - job.submittedAt).count();
+            result.runMs = std::chrono::duration_cast<std::chrono::milliseconds>(finishedAt - startedAt).count();
+
+            std::function<void()> notifier;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                running_[job.radio]--;
+                pending_.erase(job.address);
+                results_.push_back(result);
+
+                ReconnectDeviceStats& s = stats_[job.address];
+                s.attempts++;
+                if (connected) s.successes++;
+                s.lastQueueDelayMs = result.queueDelayMs;
+                s.totalQueueDelayMs += result.queueDelayMs;
+                if (result.queueDelayMs > s.maxQueueDelayMs) s.maxQueueDelayMs = result.queueDelayMs;
+
+                notifier = notifier_;
+                cv_.notify_all();
+                if (pending_.empty()) idleCv_.notify_all();
+            }
+            if (notifier) notifier();
+        }
+    }
+
+    int perRadioLimit_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idleCv_;
+    std::deque<Job> queue_;
+    std::unordered_set<BtAddr> pending_;
+    std::unordered_map<int, int> running_;
+    std::unordered_map<int, int> radioLimits_;
+    std::deque<ReconnectResult> results_;
+    std::unordered_map<BtAddr, ReconnectDeviceStats> stats_;
+    std::function<void()> notifier_;
+    bool stopping_ = false;
+};
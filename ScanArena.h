@@ -0,0 +1,124 @@
+#pragma once
+
+// 枚举暂存区：一次枚举/扫描的原始设备记录与名称字符都放在复用的缓冲区中，Reset 只清空不释放，
+// 稳态下（设备与名称不变）整条枚举路径不分配内存。地址一直保持为 BtAddr 整数，显示时才格式化。
+// - ScanArena：按适配器追加原始记录（名称直接取 BLUETOOTH_DEVICE_INFO::szName），合并同一设备后写入 PairedDevice 列表
+// - NameTable：名称驻留，每台设备的名称只保存一份；写入列表时与驻留的名称比较，只在首次出现或改名时复制
+// ScanArena 不加锁，同时进行的枚举（轮询与异步扫描）各用一份；NameTable 线程安全。
+
+#include "BtTypes.h"
+#include "DeviceFeed.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cwchar>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ScanRecord {
+    BtAddr address = 0;
+    uint32_t nameOffset = 0;    // 名称在字符区中的位置
+    uint32_t nameLength = 0;
+    bool connected = false;
+    int radio = 0;
+};
+
+struct NameTableStats {
+    size_t devices = 0;         // 驻留了名称的设备
+    uint64_t interned = 0;      // 复制名称的次数（首次出现与改名）
+};
+
+class NameTable {
+public:
+    // 驻留该设备的名称（与 name 不同时先更新），并在锁内复制到 out；out 已与驻留的名称相同时不复制
+    void Intern(BtAddr address, const wchar_t* name, size_t length, std::wstring& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::wstring& stored = names_[address & BT_ADDR_MASK];
+        if (stored.size() != length || stored.compare(0, length, name, length) != 0) {
+            stored.assign(name, length);
+            interned_++;
+        }
+        if (out != stored) out = stored;
+    }
+
+    NameTableStats Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NameTableStats s;
+        s.devices = names_.size();
+        s.interned = interned_;
+        return s;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<BtAddr, std::wstring> names_;
+    uint64_t interned_ = 0;
+};
+
+class ScanArena {
+public:
+    void Reset() {
+        records_.clear();
+        chars_.clear();
+    }
+
+    // 追加一条原始记录；name 为以 0 结尾的字符串，只复制到字符区
+    void Add(BtAddr address, const wchar_t* name, bool connected, int radio) {
+        ScanRecord record;
+        record.address = address & BT_ADDR_MASK;
+        record.nameOffset = (uint32_t)chars_.size();
+        record.nameLength = (uint32_t)wcslen(name);
+        record.connected = connected;
+        record.radio = radio;
+        chars_.insert(chars_.end(), name, name + record.nameLength);
+        records_.push_back(record);
+    }
+
+    // 追加另一个暂存区（例如另一个适配器的枚举结果）的全部记录
+    void Append(const ScanArena& other) {
+        uint32_t base = (uint32_t)chars_.size();
+        chars_.insert(chars_.end(), other.chars_.begin(), other.chars_.end());
+        for (ScanRecord record : other.records_) {
+            record.nameOffset += base;
+            records_.push_back(record);
+        }
+    }
+
+    // 按地址排序并合并同一设备的多条记录（与多个适配器配对时取已连接的，其次取下标小的适配器）
+    void Merge() {
+        std::sort(records_.begin(), records_.end(), [](const ScanRecord& a, const ScanRecord& b) {
+            if (a.address != b.address) return a.address < b.address;
+            if (a.connected != b.connected) return a.connected;
+            return a.radio < b.radio;
+        });
+        records_.erase(std::unique(records_.begin(), records_.end(), [](const ScanRecord& a, const ScanRecord& b) {
+            return a.address == b.address;
+        }), records_.end());
+    }
+
+    // 写入 out：复用 out 中已有元素，名称经 names 驻留，只在地址或名称不同时复制
+    void CopyTo(std::vector<PairedDevice>& out, NameTable& names) const {
+        out.resize(records_.size());
+        for (size_t i = 0; i < records_.size(); i++) {
+            const ScanRecord& record = records_[i];
+            PairedDevice& device = out[i];
+            names.Intern(record.address, Name(record), record.nameLength, device.name);
+            device.address = record.address;
+            device.connected = record.connected;
+            device.radio = record.radio;
+        }
+    }
+
+    size_t Size() const { return records_.size(); }
+    const ScanRecord& Record(size_t index) const { return records_[index]; }
+    const std::vector<ScanRecord>& Records() const { return records_; }
+
+    // 记录的名称（不以 0 结尾，长度为 nameLength）；下一次 Add/Append 前有效
+    const wchar_t* Name(const ScanRecord& record) const { return chars_.data() + record.nameOffset; }
+
+private:
+    std::vector<ScanRecord> records_;
+    std::vector<wchar_t> chars_;
+};
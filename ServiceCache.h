@@ -0,0 +1,93 @@
+#pragma once
+
+// 已安装服务缓存：已配对设备的服务列表几乎不变，首次使用时枚举一次，
+// 之后连接/断开直接复用，省去每次 OpenFirstRadio + BluetoothEnumerateInstalledServices。
+// 设备从配对列表中消失（取消配对）或缓存的服务被系统报告不存在时失效。线程安全。
+
+#include "BtTypes.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct ServiceCacheStats {
+    uint64_t hits = 0;          // 命中（省去一次枚举）
+    uint64_t misses = 0;        // 未命中（需要枚举）
+    uint64_t invalidations = 0;
+    size_t entries = 0;
+    int64_t uptimeMs = 0;       // 统计起点至今
+
+    // 每小时节省的枚举次数
+    double HitsPerHour() const {
+        return uptimeMs > 0 ? hits * 3600000.0 / uptimeMs : 0.0;
+    }
+};
+
+class ServiceCache {
+public:
+    ServiceCache() : since_(std::chrono::steady_clock::now()) {}
+
+    // 查找缓存，命中时写入 services 并返回 true
+    bool Lookup(BtAddr address, std::vector<BtUuid>& services) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(address & BT_ADDR_MASK);
+        if (it == entries_.end()) {
+            misses_++;
+            return false;
+        }
+        hits_++;
+        services = it->second;
+        return true;
+    }
+
+    // 保存枚举结果；空列表（枚举失败或设备无服务）不缓存，下次重新枚举
+    void Store(BtAddr address, const std::vector<BtUuid>& services) {
+        if (services.empty()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[address & BT_ADDR_MASK] = services;
+    }
+
+    void Invalidate(BtAddr address) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.erase(address & BT_ADDR_MASK) > 0) invalidations_++;
+    }
+
+    // 系统报告 service 不存在：只有它取自缓存命中的列表时才说明缓存已过期，返回是否丢弃了缓存。
+    // 列表中没有任何目标服务时（键盘、鼠标等非音频设备）连接按全量尝试，这些服务本就不在列表中
+    bool OnServiceMissing(BtAddr address, const BtUuid& service, bool listFromCache) {
+        if (!listFromCache) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(address & BT_ADDR_MASK);
+        if (it == entries_.end()) return false;
+        bool listed = false;
+        for (const auto& uuid : it->second) {
+            if (uuid == service) listed = true;
+        }
+        if (!listed) return false;
+        entries_.erase(it);
+        invalidations_++;
+        return true;
+    }
+
+    ServiceCacheStats Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ServiceCacheStats s;
+        s.hits = hits_;
+        s.misses = misses_;
+        s.invalidations = invalidations_;
+        s.entries = entries_.size();
+        s.uptimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - since_).count();
+        return s;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<BtAddr, std::vector<BtUuid>> entries_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t invalidations_ = 0;
+    std::chrono::steady_clock::time_point since_;
+};
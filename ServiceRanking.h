@@ -0,0 +1,160 @@
+#pragma once
+
+// 服务切换顺序学习：记录每台设备由哪个服务成功建立了连接，下次优先切换该服务。
+// 排序规则：最近一次成功的服务在前，其次按成功次数，其余保持调用方给出的默认顺序。
+// 排名持久化到 service_ranking.txt，每行 "地址 服务UUID 成功次数"，最近成功的服务写在前面。
+// 同时统计学习前后的连接耗时。线程安全。
+
+#include "BtTypes.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cwchar>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ConnectTimingStats {
+    uint64_t unlearnedConnects = 0;     // 使用默认顺序成功连接的次数
+    uint64_t unlearnedTotalMs = 0;
+    uint64_t learnedConnects = 0;       // 使用学习到的顺序成功连接的次数
+    uint64_t learnedTotalMs = 0;
+
+    uint64_t UnlearnedAvgMs() const { return unlearnedConnects ? unlearnedTotalMs / unlearnedConnects : 0; }
+    uint64_t LearnedAvgMs() const { return learnedConnects ? learnedTotalMs / learnedConnects : 0; }
+};
+
+// "0000110b-0000-1000-8000-00805f9b34fb"
+inline std::wstring BtUuidToString(const BtUuid& u) {
+    wchar_t buffer[40];
+    swprintf(buffer, 40, L"%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+        (unsigned)u.data1, (unsigned)u.data2, (unsigned)u.data3,
+        u.data4[0], u.data4[1], u.data4[2], u.data4[3], u.data4[4], u.data4[5], u.data4[6], u.data4[7]);
+    return std::wstring(buffer);
+}
+
+inline bool ParseBtUuid(const std::wstring& text, BtUuid& out) {
+    unsigned d1, d2, d3, b[8];
+    if (swscanf(text.c_str(), L"%8x-%4x-%4x-%2x%2x-%2x%2x%2x%2x%2x%2x",
+            &d1, &d2, &d3, &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7]) != 11) {
+        return false;
+    }
+    out.data1 = d1;
+    out.data2 = (uint16_t)d2;
+    out.data3 = (uint16_t)d3;
+    for (int i = 0; i < 8; i++) out.data4[i] = (uint8_t)b[i];
+    return true;
+}
+
+class ServiceRanking {
+public:
+    // 设备是否已有学习结果
+    bool HasRanking(BtAddr address) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.count(address & BT_ADDR_MASK) > 0;
+    }
+
+    // 按学习结果重新排列候选服务（只调整顺序，不增删）
+    std::vector<BtUuid> Order(BtAddr address, const std::vector<BtUuid>& candidates) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(address & BT_ADDR_MASK);
+        if (it == entries_.end()) return candidates;
+        const std::vector<Learned>& learned = it->second;
+
+        // 学习记录本身按"最近成功在前"保存，排名即在其中的位置
+        auto rank = [&](const BtUuid& uuid) {
+            for (size_t i = 0; i < learned.size(); i++) {
+                if (learned[i].uuid == uuid) return (int)i;
+            }
+            return (int)learned.size();
+        };
+        std::vector<BtUuid> ordered = candidates;
+        std::stable_sort(ordered.begin(), ordered.end(), [&](const BtUuid& a, const BtUuid& b) {
+            return rank(a) < rank(b);
+        });
+        return ordered;
+    }
+
+    // 记录某服务成功建立了连接：该服务移到最前，成功次数加一
+    void RecordSuccess(BtAddr address, const BtUuid& uuid) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Learned>& learned = entries_[address & BT_ADDR_MASK];
+        Learned entry = { uuid, 0 };
+        for (size_t i = 0; i < learned.size(); i++) {
+            if (learned[i].uuid == uuid) {
+                entry = learned[i];
+                learned.erase(learned.begin() + i);
+                break;
+            }
+        }
+        entry.successes++;
+        learned.insert(learned.begin(), entry);
+        // 最近成功者之后按成功次数排序
+        std::stable_sort(learned.begin() + 1, learned.end(), [](const Learned& a, const Learned& b) {
+            return a.successes > b.successes;
+        });
+    }
+
+    // 记录一次成功连接的耗时（从开始切换服务到确认连接）
+    void RecordConnectTime(uint64_t ms, bool learned) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (learned) {
+            timing_.learnedConnects++;
+            timing_.learnedTotalMs += ms;
+        } else {
+            timing_.unlearnedConnects++;
+            timing_.unlearnedTotalMs += ms;
+        }
+    }
+
+    ConnectTimingStats Timing() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timing_;
+    }
+
+    // 读取排名文件（替换内存中的结果），格式错误的行忽略
+    void Load(std::wistream& in) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        std::wstring line;
+        while (std::getline(in, line)) {
+            size_t commentPos = line.find(L'#');
+            if (commentPos != std::wstring::npos) line = line.substr(0, commentPos);
+
+            std::wistringstream fields(line);
+            std::wstring addrText, uuidText;
+            unsigned long successes = 0;
+            if (!(fields >> addrText >> uuidText >> successes)) continue;
+
+            BtAddr address;
+            Learned entry;
+            if (!ParseBtAddr(addrText, address) || !ParseBtUuid(uuidText, entry.uuid)) continue;
+            entry.successes = (uint32_t)successes;
+            entries_[address].push_back(entry);
+        }
+    }
+
+    void Save(std::wostream& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out << L"# 服务切换顺序学习结果（自动生成）：地址 服务UUID 成功次数\n";
+        for (const auto& device : entries_) {
+            for (const auto& entry : device.second) {
+                out << BtAddrToString(device.first) << L" " << BtUuidToString(entry.uuid) << L" " << entry.successes << L"\n";
+            }
+        }
+    }
+
+private:
+    struct Learned {
+        BtUuid uuid;
+        uint32_t successes;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<BtAddr, std::vector<Learned>> entries_;
+    ConnectTimingStats timing_;
+};
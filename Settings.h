@@ -0,0 +1,52 @@
+#pragma once
+
+// 运行参数（settings.txt）：与设备列表 config.txt 分开保存，GUI 改写 config.txt 时不会丢失。
+// 格式为每行 "键 = 值"，# 开头为注释，未知键忽略，缺失时使用默认值。
+
+#include <istream>
+#include <string>
+
+struct MonitorSettings {
+    int reconnectWorkers = 4;           // 重连工作线程数
+    int reconnectPerRadio = 2;          // 每个无线电同时进行的重连数
+    int linkDeadlineMs = 3000;          // 启用服务后等待链路建立的最长时间（自动调整的上限）
+    int connectDeadlineMs = 20000;      // 一次连接（依次切换全部服务）的最长时间
+    int inquiryBudgetMsPerMin = 12000;  // 每分钟主动扫描时长预算，0 表示不主动扫描
+};
+
+inline std::wstring TrimSetting(const std::wstring& s) {
+    size_t start = s.find_first_not_of(L" \t\r\n");
+    size_t end = s.find_last_not_of(L" \t\r\n");
+    if (start == std::wstring::npos) return L"";
+    return s.substr(start, end - start + 1);
+}
+
+// 解析整数设置，越界或格式错误时保留原值
+inline void ParseIntSetting(const std::wstring& value, int minValue, int maxValue, int& target) {
+    try {
+        int v = std::stoi(value);
+        if (v >= minValue && v <= maxValue) target = v;
+    } catch (...) {
+    }
+}
+
+inline MonitorSettings ParseSettings(std::wistream& in) {
+    MonitorSettings settings;
+    std::wstring line;
+    while (std::getline(in, line)) {
+        size_t commentPos = line.find(L'#');
+        if (commentPos != std::wstring::npos) line = line.substr(0, commentPos);
+
+        size_t eq = line.find(L'=');
+        if (eq == std::wstring::npos) continue;
+        std::wstring key = TrimSetting(line.substr(0, eq));
+        std::wstring value = TrimSetting(line.substr(eq + 1));
+
+        if (key == L"reconnect_workers") ParseIntSetting(value, 1, 32, settings.reconnectWorkers);
+        else if (key == L"reconnect_per_radio") ParseIntSetting(value, 1, 16, settings.reconnectPerRadio);
+        else if (key == L"link_deadline_ms") ParseIntSetting(value, 500, 30000, settings.linkDeadlineMs);
+        else if (key == L"connect_deadline_ms") ParseIntSetting(value, 2000, 120000, settings.connectDeadlineMs);
+        else if (key == L"inquiry_budget_ms_per_min") ParseIntSetting(value, 0, 60000, settings.inquiryBudgetMsPerMin);
+    }
+    return settings;
+}
@@ -0,0 +1,626 @@
+#pragma once
+
+// 模拟蓝牙组件：不依赖真实硬件，供基准程序与 Linux CI 使用
+
+#include "BtTypes.h"
+#include "Cancellation.h"
+#include "Clock.h"
+#include "LinkWaiter.h"
+#include "Metrics.h"
+#include "MonitorCore.h"
+#include "PresenceEngine.h"
+#include "RadioManager.h"
+#include "ReconnectPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 模拟事件源：由调用方直接注入事件，可模拟事件源失效
+class SimulatedPresenceSource : public IPresenceSource {
+public:
+    const wchar_t* Name() const override { return L"Simulated"; }
+
+    bool Start(IPresenceSink* sink) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sink_ = sink;
+        return alive_;
+    }
+
+    void Stop() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sink_ = nullptr;
+    }
+
+    // 注入一个事件，时间戳取当前时刻
+    void Emit(PresenceEventType type, BtAddr address) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!sink_ || !alive_) return;
+        PresenceEvent ev;
+        ev.type = type;
+        ev.address = address & BT_ADDR_MASK;
+        ev.observedAt = std::chrono::steady_clock::now();
+        emitted_++;
+        sink_->OnPresenceEvent(ev);
+    }
+
+    // 模拟事件源失效/恢复（例如适配器被拔出）
+    void SetAlive(bool alive) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (alive_ == alive) return;
+        alive_ = alive;
+        if (sink_) sink_->OnSourceState(alive);
+    }
+
+    uint64_t Emitted() const { return emitted_; }
+
+private:
+    std::mutex mutex_;
+    IPresenceSink* sink_ = nullptr;
+    bool alive_ = true;
+    std::atomic<uint64_t> emitted_{0};
+};
+
+// 模拟无线电：每次连接固定耗时，记录同时进行的最大连接数
+class SimulatedRadio {
+public:
+    explicit SimulatedRadio(int connectMs) : connectMs_(connectMs) {}
+
+    bool Connect(BtAddr address) {
+        (void)address;
+        int now = ++active_;
+        int prev = maxActive_.load();
+        while (now > prev && !maxActive_.compare_exchange_weak(prev, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(connectMs_));
+        --active_;
+        connects_++;
+        return true;
+    }
+
+    int MaxConcurrent() const { return maxActive_; }
+    uint64_t Connects() const { return connects_; }
+
+private:
+    int connectMs_;
+    std::atomic<int> active_{0};
+    std::atomic<int> maxActive_{0};
+    std::atomic<uint64_t> connects_{0};
+};
+
+// 模拟按服务禁用/启用触发连接的过程（与 ConnectDevice 的步骤相同）：查询设备信息、取已安装服务，
+// 再逐个服务禁用、间隔、启用并等待链路。每次蓝牙 API 调用阻塞 apiMs 且不可中断，linked 返回 false 时链路不会建立。
+// Connect 在每次调用之间检查 op 并在条件变量上等待；ConnectUncancellable 为原实现（固定 Sleep，不检查停止）
+struct SimToggleOptions {
+    int apiMs = 20;             // 单次蓝牙 API 调用耗时
+    int services = 3;           // 依次切换的服务数
+    int toggleGapMs = 150;      // 禁用与启用之间的间隔
+    uint32_t deviceClass = 0x04;
+};
+
+class SimServiceToggle {
+public:
+    SimServiceToggle(LinkWaiter& waiter, std::function<bool()> linked, const SimToggleOptions& options = SimToggleOptions())
+        : waiter_(waiter), linked_(linked), options_(options) {}
+
+    bool Connect(OperationContext& op) {
+        CallApi();                                  // BluetoothGetDeviceInfo
+        if (!op.Ok()) return false;
+        CallApi();                                  // 取已安装服务
+        for (int i = 0; i < options_.services; i++) {
+            if (!op.Ok()) return false;
+            CallApi();                              // 禁用
+            if (op.Wait(options_.toggleGapMs) != OperationStatus::Ok) return false;
+            CallApi();                              // 启用
+            if (!op.Ok()) return false;
+            LinkWaitResult wait = waiter_.Wait(options_.deviceClass, [this]() { CallApi(); return linked_(); }, &op);
+            if (wait.linked) return true;
+            if (wait.status != OperationStatus::Ok) return false;
+        }
+        return false;
+    }
+
+    bool ConnectUncancellable() {
+        CallApi();
+        CallApi();
+        for (int i = 0; i < options_.services; i++) {
+            CallApi();
+            std::this_thread::sleep_for(std::chrono::milliseconds(options_.toggleGapMs));
+            CallApi();
+            if (waiter_.Wait(options_.deviceClass, [this]() { CallApi(); return linked_(); }).linked) return true;
+        }
+        return false;
+    }
+
+    uint64_t ApiCalls() const { return apiCalls_; }
+
+private:
+    void CallApi() {
+        apiCalls_++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(options_.apiMs));
+    }
+
+    LinkWaiter& waiter_;
+    std::function<bool()> linked_;
+    SimToggleOptions options_;
+    std::atomic<uint64_t> apiCalls_{0};
+};
+
+// 模拟无线电后端：句柄为递增编号，可模拟适配器移除/插入；记录打开与关闭次数以检查泄漏
+class FakeRadioBackend : public IRadioBackend {
+public:
+    explicit FakeRadioBackend(int adapters = 1) : adapters_(adapters) {}
+
+    std::vector<RadioHandle> OpenRadios() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<RadioHandle> radios;
+        for (int i = 0; i < adapters_; i++) {
+            uintptr_t id = ++nextId_;
+            open_.insert(id);
+            radios.push_back((RadioHandle)id);
+            opened_++;
+        }
+        return radios;
+    }
+
+    void CloseRadio(RadioHandle handle) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_.erase((uintptr_t)handle);
+        stale_.erase((uintptr_t)handle);
+        closed_++;
+    }
+
+    // 句柄是否仍可用（适配器移除后旧句柄失效）
+    bool IsValid(RadioHandle handle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uintptr_t id = (uintptr_t)handle;
+        return open_.count(id) > 0 && stale_.count(id) == 0;
+    }
+
+    // 移除全部适配器并重新插入：已打开的句柄全部失效
+    void Replug() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stale_ = open_;
+    }
+
+    uint64_t Opened() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return opened_;
+    }
+
+    size_t OpenHandles() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return open_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    int adapters_;
+    uintptr_t nextId_ = 0;
+    std::set<uintptr_t> open_;
+    std::set<uintptr_t> stale_;
+    uint64_t opened_ = 0;
+    uint64_t closed_ = 0;
+};
+
+// 模拟设备群使用的 Win32 错误码（与 ConnectDevice 实际遇到的一致）
+const uint32_t SIM_ERROR_GEN_FAILURE = 31;              // ERROR_GEN_FAILURE
+const uint32_t SIM_ERROR_SEM_TIMEOUT = 121;             // ERROR_SEM_TIMEOUT
+const uint32_t SIM_ERROR_DEVICE_NOT_CONNECTED = 1167;   // ERROR_DEVICE_NOT_CONNECTED
+const uint32_t SIM_ERROR_TIMEOUT = 1460;                // ERROR_TIMEOUT：服务已启用但链路未建立
+
+struct SimFleetOptions {
+    int devices = 1000;
+    int64_t meanPresentMs = 20 * 60000;     // 设备在范围内的平均时长（指数分布）
+    int64_t meanAbsentMs = 5 * 60000;       // 离开范围的平均时长
+    double linkDropRate = 0.2;              // 在范围内期满时只是链路断开（不离开范围）的比例
+    int connectMinMs = 400;                 // 在范围内时连接耗时范围
+    int connectMaxMs = 4000;
+    int absentConnectMs = 9000;             // 不在范围内时一次连接尝试的耗时（逐个服务等到截止时间）
+    double failureRate = 0.1;               // 在范围内连接仍失败的概率
+    int enumerateMs = 20;                   // 枚举已配对设备耗时
+    int inquiryMs = 2560;                   // 主动扫描耗时（cTimeoutMultiplier = 2）
+    bool emitEvents = true;                 // 是否产生在场事件（模拟可用的事件源）
+    int radios = 1;                         // 本地适配器数，设备轮流分配到各适配器
+    int failingRadio = -1;                  // 经此适配器的连接全部失败（模拟故障适配器），-1 表示没有
+    bool startLinkDown = false;             // 开始时在范围内的设备也未连接（模拟重连风暴）
+    uint32_t seed = 1;
+};
+
+// 按脚本进出范围的一次到访（虚拟时间，毫秒）
+struct SimVisit {
+    int64_t arriveMs;
+    int64_t leaveMs;
+};
+
+// 模拟大量已配对设备：按虚拟时间进入/离开范围、链路断开，连接耗时随机并按真实错误码失败。
+// AddScripted 追加的设备只按给定的到访进出范围（用于回放日常规律），不受随机进出与链路断开影响。
+// 作为 IBluetoothBackend 供 MonitorCore 使用；单线程使用（配合 SimReconnectExecutor）
+class SimulatedFleet : public IBluetoothBackend {
+public:
+    SimulatedFleet(IClock& clock, const SimFleetOptions& options)
+        : clock_(clock), options_(options), rng_(options.seed) {
+        int64_t now = clock_.NowMs();
+        double presentShare = (double)options_.meanPresentMs / (options_.meanPresentMs + options_.meanAbsentMs);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        devices_.resize(options_.devices);
+        for (int i = 0; i < options_.devices; i++) {
+            Device& d = devices_[i];
+            d.address = 0x5A0000000000ull + (uint64_t)i * 0x10001ull;
+            d.name = L"Sim-" + std::to_wstring(i);
+            d.radio = i % (options_.radios > 0 ? options_.radios : 1);
+            d.present = unit(rng_) < presentShare;
+            d.connected = d.present && !options_.startLinkDown;
+            index_[d.address] = i;
+            changes_.push(Change{ now + Duration(d.present ? options_.meanPresentMs : options_.meanAbsentMs), i });
+        }
+    }
+
+    void SetMetrics(Metrics* metrics) { metrics_ = metrics; }
+
+    // 追加一台按 visits（按时间排序、互不重叠）进出范围的设备，开始时不在范围内；返回其地址
+    BtAddr AddScripted(const std::wstring& name, const std::vector<SimVisit>& visits) {
+        int i = (int)devices_.size();
+        Device d;
+        d.address = 0x5A0000000000ull + (uint64_t)i * 0x10001ull;
+        d.name = name;
+        d.radio = i % (options_.radios > 0 ? options_.radios : 1);
+        d.scripted = true;
+        d.visits = visits;
+        devices_.push_back(d);
+        index_[d.address] = i;
+        if (!visits.empty()) changes_.push(Change{ visits[0].arriveMs, i });
+        return d.address;
+    }
+
+    // 应用到期的状态变化，产生对应的在场事件（emitEvents 为 false 时只改变状态）
+    void Advance(std::vector<PresenceEvent>& events) {
+        events.clear();
+        int64_t now = clock_.NowMs();
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        for (const auto& pending : pendingEvents_) Emit(events, pending.first, pending.second);
+        pendingEvents_.clear();
+
+        while (!changes_.empty() && changes_.top().atMs <= now) {
+            Change change = changes_.top();
+            changes_.pop();
+            if (options_.emitEvents) eventDelay_.RecordMs((uint64_t)(now - change.atMs));
+            Device& d = devices_[change.index];
+            if (d.scripted) {
+                AdvanceScripted(events, d, change.index);
+            } else if (d.present && d.connected && unit(rng_) < options_.linkDropRate) {
+                // 仍在范围内，只是链路断开
+                d.connected = false;
+                linkDrops_++;
+                Emit(events, PresenceEventType::Disconnected, d.address);
+                changes_.push(Change{ now + Duration(options_.meanPresentMs), change.index });
+            } else if (d.present) {
+                bool wasConnected = d.connected;
+                d.present = false;
+                d.connected = false;
+                departures_++;
+                if (wasConnected) Emit(events, PresenceEventType::Disconnected, d.address);
+                Emit(events, PresenceEventType::Departed, d.address);
+                changes_.push(Change{ now + Duration(options_.meanAbsentMs), change.index });
+            } else {
+                d.present = true;
+                arrivals_++;
+                Emit(events, PresenceEventType::Arrived, d.address);
+                changes_.push(Change{ now + Duration(options_.meanPresentMs), change.index });
+            }
+        }
+    }
+
+    // 下一次状态变化的时间，没有时返回 -1
+    int64_t NextChangeMs() const {
+        if (!pendingEvents_.empty()) return clock_.NowMs();
+        return changes_.empty() ? -1 : changes_.top().atMs;
+    }
+
+    // 一次连接尝试的耗时（提交时决定）
+    int64_t ConnectDurationMs(BtAddr address) {
+        const Device* d = Find(address);
+        if (!d || !d->present) return options_.absentConnectMs;
+        std::uniform_int_distribution<int> ms(options_.connectMinMs, options_.connectMaxMs);
+        return ms(rng_);
+    }
+
+    void EnumeratePaired(bool inquiry, std::vector<PairedDevice>& out) override {
+        clock_.SleepMs(inquiry ? options_.inquiryMs : options_.enumerateMs);
+        Snapshot(out);
+    }
+
+    // 当前所有设备的状态（不消耗虚拟时间）
+    void Snapshot(std::vector<PairedDevice>& out) const {
+        out.resize(devices_.size());
+        for (size_t i = 0; i < devices_.size(); i++) {
+            out[i].address = devices_[i].address;
+            out[i].name = devices_[i].name;
+            out[i].connected = devices_[i].connected;
+            out[i].radio = devices_[i].radio;
+        }
+    }
+
+    int64_t InquiryMs() const { return options_.inquiryMs; }
+
+    bool IsConnected(BtAddr address) override {
+        const Device* d = Find(address);
+        return d && d->connected;
+    }
+
+    bool Connect(BtAddr address, int radio, const std::wstring& name, OperationContext& op) override {
+        Device* d = Find(address);
+        if (!d || !op.Ok()) return false;
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        uint32_t error = 0;
+        if (radio != d->radio) {
+            error = SIM_ERROR_DEVICE_NOT_CONNECTED;     // 设备没有与该适配器配对
+        } else if (radio == options_.failingRadio) {
+            error = SIM_ERROR_GEN_FAILURE;
+        } else if (!d->present) {
+            error = SIM_ERROR_TIMEOUT;
+        } else if (unit(rng_) < options_.failureRate) {
+            const uint32_t codes[] = { SIM_ERROR_GEN_FAILURE, SIM_ERROR_SEM_TIMEOUT, SIM_ERROR_DEVICE_NOT_CONNECTED };
+            error = codes[std::uniform_int_distribution<int>(0, 2)(rng_)];
+        }
+        if (error != 0) {
+            if (metrics_) metrics_->RecordConnectFailure(address, name, error);
+            RadioCounters(radio).failures++;
+            return false;
+        }
+        RadioCounters(radio).successes++;
+        d->connected = true;
+        if (metrics_) metrics_->RecordConnectSuccess(address, name);
+        pendingEvents_.push_back(std::make_pair(PresenceEventType::Connected, d->address));
+        return true;
+    }
+
+    size_t ConnectedCount() const {
+        size_t n = 0;
+        for (const auto& d : devices_) n += d.connected ? 1 : 0;
+        return n;
+    }
+
+    size_t PresentCount() const {
+        size_t n = 0;
+        for (const auto& d : devices_) n += d.present ? 1 : 0;
+        return n;
+    }
+
+    // 各适配器上的连接成功/失败次数
+    std::vector<std::pair<uint64_t, uint64_t>> RadioOutcomes() const {
+        std::vector<std::pair<uint64_t, uint64_t>> out;
+        for (const auto& r : radioCounters_) out.push_back(std::make_pair(r.successes, r.failures));
+        return out;
+    }
+
+    uint64_t Arrivals() const { return arrivals_; }
+    uint64_t Departures() const { return departures_; }
+    uint64_t LinkDrops() const { return linkDrops_; }
+    // 状态变化发生到事件交给监控循环的虚拟时间延迟（监控循环阻塞时变大）
+    HistogramSnapshot EventDelay() const { return eventDelay_.Snapshot(); }
+
+private:
+    struct Device {
+        BtAddr address = 0;
+        std::wstring name;
+        bool present = false;
+        bool connected = false;
+        int radio = 0;
+        bool scripted = false;
+        std::vector<SimVisit> visits;   // 仅脚本设备
+        size_t visit = 0;               // 当前（或下一次）到访
+    };
+
+    struct RadioCounter {
+        uint64_t successes = 0;
+        uint64_t failures = 0;
+    };
+
+    RadioCounter& RadioCounters(int radio) {
+        if (radio < 0) radio = 0;
+        if ((size_t)radio >= radioCounters_.size()) radioCounters_.resize(radio + 1);
+        return radioCounters_[radio];
+    }
+
+    struct Change {
+        int64_t atMs;
+        int index;
+        bool operator>(const Change& other) const { return atMs > other.atMs; }
+    };
+
+    // 脚本设备到达或离开，并安排下一次变化
+    void AdvanceScripted(std::vector<PresenceEvent>& events, Device& d, int index) {
+        if (!d.present) {
+            d.present = true;
+            arrivals_++;
+            Emit(events, PresenceEventType::Arrived, d.address);
+            changes_.push(Change{ d.visits[d.visit].leaveMs, index });
+            return;
+        }
+        bool wasConnected = d.connected;
+        d.present = false;
+        d.connected = false;
+        departures_++;
+        if (wasConnected) Emit(events, PresenceEventType::Disconnected, d.address);
+        Emit(events, PresenceEventType::Departed, d.address);
+        if (++d.visit < d.visits.size()) changes_.push(Change{ d.visits[d.visit].arriveMs, index });
+    }
+
+    Device* Find(BtAddr address) {
+        auto it = index_.find(address & BT_ADDR_MASK);
+        return it == index_.end() ? nullptr : &devices_[it->second];
+    }
+
+    int64_t Duration(int64_t meanMs) {
+        std::exponential_distribution<double> dist(1.0 / meanMs);
+        return 1 + (int64_t)dist(rng_);
+    }
+
+    void Emit(std::vector<PresenceEvent>& events, PresenceEventType type, BtAddr address) {
+        if (!options_.emitEvents) return;
+        PresenceEvent ev;
+        ev.type = type;
+        ev.address = address;
+        ev.observedAt = std::chrono::steady_clock::now();
+        events.push_back(ev);
+    }
+
+    IClock& clock_;
+    SimFleetOptions options_;
+    std::mt19937 rng_;
+    std::vector<Device> devices_;
+    std::unordered_map<BtAddr, int> index_;
+    std::priority_queue<Change, std::vector<Change>, std::greater<Change>> changes_;
+    std::vector<std::pair<PresenceEventType, BtAddr>> pendingEvents_;   // 连接成功后下一次 Advance 产生的事件
+    Metrics* metrics_ = nullptr;
+    uint64_t arrivals_ = 0;
+    uint64_t departures_ = 0;
+    uint64_t linkDrops_ = 0;
+    std::vector<RadioCounter> radioCounters_;
+    LatencyHistogram eventDelay_;
+};
+
+// 按虚拟时间完成的主动扫描阶段：Begin 之后经过 inquiryMs 才能取回结果（取回时的设备状态）
+class SimInquiryStage : public IInquiryStage {
+public:
+    SimInquiryStage(IClock& clock, SimulatedFleet& fleet) : clock_(clock), fleet_(fleet) {}
+
+    bool Begin() override {
+        if (doneAtMs_ >= 0) return false;
+        doneAtMs_ = clock_.NowMs() + fleet_.InquiryMs();
+        return true;
+    }
+
+    bool TakeResult(std::vector<PairedDevice>& out) override {
+        if (doneAtMs_ < 0 || clock_.NowMs() < doneAtMs_) return false;
+        doneAtMs_ = -1;
+        fleet_.Snapshot(out);
+        return true;
+    }
+
+    // 进行中扫描的完成时刻，没有时返回 -1
+    int64_t NextCompletionMs() const { return doneAtMs_; }
+
+private:
+    IClock& clock_;
+    SimulatedFleet& fleet_;
+    int64_t doneAtMs_ = -1;
+};
+
+// 按虚拟时间执行重连的执行器：与 ReconnectPool 相同的并发限制（工作线程数、每个无线电的上限），
+// 任务在完成时刻才调用，耗时由 durationMs 决定。单线程使用，由调用方在时间前进后调用 Advance
+class SimReconnectExecutor : public IReconnectExecutor {
+public:
+    SimReconnectExecutor(IClock& clock, int workers, int perRadioLimit, std::function<int64_t(BtAddr)> durationMs)
+        : clock_(clock), workers_(workers > 0 ? workers : 1), perRadioLimit_(perRadioLimit > 0 ? perRadioLimit : 1),
+          durationMs_(durationMs) {}
+
+    bool Submit(BtAddr address, int radio, Task task) override {
+        if (pending_.count(address) > 0) return false;
+        Job job;
+        job.address = address;
+        job.radio = radio;
+        job.task = task;
+        job.submittedMs = clock_.NowMs();
+        queue_.push_back(job);
+        pending_.insert(address);
+        StartQueued();
+        return true;
+    }
+
+    bool IsPending(BtAddr address) override {
+        return pending_.count(address) > 0;
+    }
+
+    size_t DrainResults(std::vector<ReconnectResult>& out) override {
+        out.assign(results_.begin(), results_.end());
+        results_.clear();
+        return out.size();
+    }
+
+    // 完成到期的任务（此时调用任务本身），并启动排队中的任务
+    void Advance() {
+        int64_t now = clock_.NowMs();
+        for (size_t i = 0; i < running_.size();) {
+            if (running_[i].finishMs > now) {
+                i++;
+                continue;
+            }
+            Job job = running_[i].job;
+            int64_t startMs = running_[i].startMs;
+            int64_t finishMs = running_[i].finishMs;
+            running_.erase(running_.begin() + i);
+            radioRunning_[job.radio]--;
+
+            ReconnectResult result;
+            result.address = job.address;
+            result.radio = job.radio;
+            result.connected = job.task();
+            result.queueDelayMs = startMs - job.submittedMs;
+            result.runMs = finishMs - startMs;
+            results_.push_back(result);
+            pending_.erase(job.address);
+        }
+        StartQueued();
+    }
+
+    // 下一个任务完成的时间，没有执行中的任务返回 -1
+    int64_t NextCompletionMs() const {
+        int64_t next = -1;
+        for (const auto& r : running_) {
+            if (next < 0 || r.finishMs < next) next = r.finishMs;
+        }
+        return next;
+    }
+
+    bool HasResults() const { return !results_.empty(); }
+
+private:
+    struct Job {
+        BtAddr address;
+        int radio;
+        Task task;
+        int64_t submittedMs;
+    };
+
+    struct Running {
+        Job job;
+        int64_t startMs;
+        int64_t finishMs;
+    };
+
+    void StartQueued() {
+        int64_t now = clock_.NowMs();
+        for (auto it = queue_.begin(); it != queue_.end() && (int)running_.size() < workers_;) {
+            if (radioRunning_[it->radio] >= perRadioLimit_) {
+                ++it;
+                continue;
+            }
+            radioRunning_[it->radio]++;
+            running_.push_back(Running{ *it, now, now + durationMs_(it->address) });
+            it = queue_.erase(it);
+        }
+    }
+
+    IClock& clock_;
+    int workers_;
+    int perRadioLimit_;
+    std::function<int64_t(BtAddr)> durationMs_;
+    std::deque<Job> queue_;
+    std::vector<Running> running_;
+    std::unordered_set<BtAddr> pending_;
+    std::unordered_map<int, int> radioRunning_;
+    std::deque<ReconnectResult> results_;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+// 不可变快照发布（RCU 风格）：写入方复制当前快照、修改后整体替换，读取方只取一次 shared_ptr，
+// 拿到的快照在用完之前不会被修改或释放。每次发布版本号加一，同一读取方看到的版本单调不减。
+//
+// 读取不加锁：当前快照的持有节点放在原子指针中，读取方在两个纪元计数之一上登记，
+// 读出指针并复制其中的 shared_ptr 后注销（两次原子加减、一次指针读取、一次引用计数加一）。
+// 写入方之间用互斥量串行：换上新节点后切换纪元，等旧纪元的读取方全部注销（只需等完一次
+// shared_ptr 复制）再释放旧节点。不使用 std::atomic_load(shared_ptr)：libstdc++/MSVC 以全局自旋锁池实现，
+// 读取方与写入方争用同一把锁。
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+template <class T>
+struct Snapshot {
+    uint64_t version = 0;
+    T value;
+};
+
+template <class T>
+class SnapshotCell {
+public:
+    typedef std::shared_ptr<const Snapshot<T>> Ptr;
+
+    explicit SnapshotCell(T initial = T()) {
+        std::shared_ptr<Snapshot<T>> first = std::make_shared<Snapshot<T>>();
+        first->value = std::move(initial);
+        current_.store(new Node{ first }, std::memory_order_release);
+    }
+
+    ~SnapshotCell() { delete current_.load(std::memory_order_acquire); }
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    // 当前快照（任意线程，不加锁；写入方切换纪元时最多重试一次）
+    Ptr Load() const {
+        while (true) {
+            uint32_t epoch = epoch_.load(std::memory_order_seq_cst);
+            std::atomic<uint32_t>& readers = readers_[epoch & 1];
+            readers.fetch_add(1, std::memory_order_seq_cst);
+            // 登记后纪元未变：写入方一定会等本次读取注销后才释放读到的节点
+            if (epoch_.load(std::memory_order_seq_cst) == epoch) {
+                Ptr snapshot = current_.load(std::memory_order_acquire)->snapshot;
+                readers.fetch_sub(1, std::memory_order_release);
+                return snapshot;
+            }
+            readers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // 用 value 整体替换当前快照
+    void Publish(T value) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        std::shared_ptr<Snapshot<T>> next = std::make_shared<Snapshot<T>>();
+        next->value = std::move(value);
+        Replace(std::move(next));
+    }
+
+    // 复制当前快照交给 mutate 修改后发布；写入方串行，mutate 只调用一次
+    template <class Mutate>
+    void Update(Mutate mutate) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        std::shared_ptr<Snapshot<T>> next = std::make_shared<Snapshot<T>>(*current_.load(std::memory_order_relaxed)->snapshot);
+        mutate(next->value);
+        Replace(std::move(next));
+    }
+
+private:
+    struct Node {
+        Ptr snapshot;
+    };
+
+    // 需持有 writeMutex_
+    void Replace(std::shared_ptr<Snapshot<T>> next) {
+        Node* old = current_.load(std::memory_order_relaxed);
+        next->version = old->snapshot->version + 1;
+        current_.store(new Node{ std::move(next) }, std::memory_order_seq_cst);
+
+        // 之后登记的读取方在新纪元上，只能读到新节点；等旧纪元上的读取方注销
+        uint32_t epoch = epoch_.load(std::memory_order_relaxed);
+        epoch_.store(epoch + 1, std::memory_order_seq_cst);
+        while (readers_[epoch & 1].load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+        delete old;     // 没有读取方还持有旧快照时，快照在这里（写入线程）析构
+    }
+
+    std::atomic<Node*> current_{ nullptr };
+    mutable std::atomic<uint32_t> epoch_{ 0 };
+    mutable std::atomic<uint32_t> readers_[2] = {};
+    std::mutex writeMutex_;
+};
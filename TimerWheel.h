@@ -0,0 +1,264 @@
+#pragma once
+
+// 分层时间轮：4 层 × 64 槽，默认 100ms 一格，可覆盖约 19 天的定时范围。
+// 添加/取消/重新调度均为 O(1)；推进时间时直接跳到下一个有定时器的格，
+// 空闲期间不逐格遍历。非线程安全，只在监控线程中使用。
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TimerWheel {
+public:
+    typedef int32_t Handle;
+    static constexpr Handle INVALID_TIMER = -1;
+
+    struct Fired {
+        Handle handle;      // 已失效，仅用于调用方清理自己保存的句柄
+        uint64_t key;
+        int kind;
+        int64_t deadlineMs;
+    };
+
+    explicit TimerWheel(int64_t originMs = 0, int tickMs = 100)
+        : originMs_(originMs), tickMs_(tickMs > 0 ? tickMs : 1) {
+        for (int l = 0; l < LEVELS; l++) {
+            for (int s = 0; s < SLOTS; s++) heads_[l][s] = INVALID_TIMER;
+        }
+    }
+
+    // 添加定时器，deadlineMs 已过期时在下一次 Advance 中立即触发
+    Handle Add(int64_t deadlineMs, uint64_t key, int kind) {
+        Handle h;
+        if (!free_.empty()) {
+            h = free_.back();
+            free_.pop_back();
+        } else {
+            h = (Handle)nodes_.size();
+            nodes_.push_back(Node());
+        }
+        Node& n = nodes_[h];
+        n.key = key;
+        n.kind = kind;
+        n.deadlineMs = deadlineMs;
+        n.tick = MsToTick(deadlineMs);
+        n.active = true;
+        Insert(h);
+        count_++;
+        return h;
+    }
+
+    void Cancel(Handle h) {
+        if (!IsActive(h)) return;
+        Unlink(h);
+        Release(h);
+    }
+
+    // 修改已有定时器的到期时间；句柄无效时新建
+    Handle Reschedule(Handle h, int64_t deadlineMs, uint64_t key, int kind) {
+        if (!IsActive(h)) return Add(deadlineMs, key, kind);
+        Unlink(h);
+        Node& n = nodes_[h];
+        n.key = key;
+        n.kind = kind;
+        n.deadlineMs = deadlineMs;
+        n.tick = MsToTick(deadlineMs);
+        Insert(h);
+        return h;
+    }
+
+    bool IsActive(Handle h) const {
+        return h >= 0 && h < (Handle)nodes_.size() && nodes_[h].active;
+    }
+
+    int64_t DeadlineOf(Handle h) const {
+        return IsActive(h) ? nodes_[h].deadlineMs : -1;
+    }
+
+    size_t Size() const { return count_; }
+
+    // 推进到 nowMs，把到期的定时器追加到 out，返回触发数量
+    size_t Advance(int64_t nowMs, std::vector<Fired>& out) {
+        size_t before = out.size();
+        FireList(dueHead_, out);
+
+        int64_t target = (nowMs - originMs_) / tickMs_;
+        while (currentTick_ < target) {
+            int64_t next = NextEventTick();
+            if (next < 0 || next > target) {
+                currentTick_ = target;
+                break;
+            }
+            Step(next, out);
+        }
+        return out.size() - before;
+    }
+
+    // 最早一个定时器到期的时间（按格取整）；没有定时器返回 -1。
+    // 不含层间迁移的边界：等到这个时间再 Advance 即可，途经的迁移在 Advance 中依次完成，空闲时不为迁移唤醒
+    int64_t NextDeadlineMs() const {
+        if (dueHead_ != INVALID_TIMER) return originMs_ + currentTick_ * tickMs_;
+        int64_t tick = NextFireTick();
+        return tick < 0 ? -1 : originMs_ + tick * tickMs_;
+    }
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int64_t SLOT_MASK = SLOTS - 1;
+    static const int DUE_LEVEL = -1;
+
+    struct Node {
+        int64_t tick = 0;
+        int64_t deadlineMs = 0;
+        uint64_t key = 0;
+        int kind = 0;
+        Handle prev = INVALID_TIMER;
+        Handle next = INVALID_TIMER;
+        int level = 0;
+        int slot = 0;
+        bool active = false;
+    };
+
+    // 向上取整，保证定时器不会提前触发
+    int64_t MsToTick(int64_t ms) const {
+        int64_t rel = ms - originMs_;
+        if (rel <= 0) return 0;
+        return (rel + tickMs_ - 1) / tickMs_;
+    }
+
+    Handle& HeadOf(int level, int slot) {
+        return level == DUE_LEVEL ? dueHead_ : heads_[level][slot];
+    }
+
+    void Insert(Handle h) {
+        Node& n = nodes_[h];
+        int64_t delta = n.tick - currentTick_;
+        if (delta <= 0) {
+            n.level = DUE_LEVEL;
+            n.slot = 0;
+        } else {
+            int64_t tick = n.tick;
+            const int64_t maxDelta = ((int64_t)1 << (SLOT_BITS * LEVELS)) - 1;
+            if (delta > maxDelta) tick = currentTick_ + maxDelta;   // 超出范围：先放在最高层，迁移时再重新计算
+            int level = 0;
+            while (level < LEVELS - 1 && (tick - currentTick_) >= ((int64_t)1 << (SLOT_BITS * (level + 1)))) level++;
+            n.level = level;
+            n.slot = (int)((tick >> (SLOT_BITS * level)) & SLOT_MASK);
+        }
+        Handle& head = HeadOf(n.level, n.slot);
+        n.prev = INVALID_TIMER;
+        n.next = head;
+        if (head != INVALID_TIMER) nodes_[head].prev = h;
+        head = h;
+    }
+
+    void Unlink(Handle h) {
+        Node& n = nodes_[h];
+        if (n.prev != INVALID_TIMER) nodes_[n.prev].next = n.next;
+        else HeadOf(n.level, n.slot) = n.next;
+        if (n.next != INVALID_TIMER) nodes_[n.next].prev = n.prev;
+        n.prev = n.next = INVALID_TIMER;
+    }
+
+    void Release(Handle h) {
+        nodes_[h].active = false;
+        free_.push_back(h);
+        count_--;
+    }
+
+    void FireList(Handle& head, std::vector<Fired>& out) {
+        while (head != INVALID_TIMER) {
+            Handle h = head;
+            Node& n = nodes_[h];
+            head = n.next;
+            if (head != INVALID_TIMER) nodes_[head].prev = INVALID_TIMER;
+            out.push_back(Fired{ h, n.key, n.kind, n.deadlineMs });
+            Release(h);
+        }
+    }
+
+    // 把高层某个槽中的定时器重新分配到低层
+    void Cascade(int level, int slot) {
+        Handle h = heads_[level][slot];
+        heads_[level][slot] = INVALID_TIMER;
+        while (h != INVALID_TIMER) {
+            Handle next = nodes_[h].next;
+            Insert(h);
+            h = next;
+        }
+    }
+
+    void Step(int64_t tick, std::vector<Fired>& out) {
+        currentTick_ = tick;
+        for (int level = 1; level < LEVELS; level++) {
+            if ((tick & (((int64_t)1 << (SLOT_BITS * level)) - 1)) != 0) break;
+            Cascade(level, (int)((tick >> (SLOT_BITS * level)) & SLOT_MASK));
+        }
+        FireList(heads_[0][tick & SLOT_MASK], out);
+        FireList(dueHead_, out);
+    }
+
+    // 下一个需要处理的格：第 0 层为精确到期格，高层为对应槽的迁移边界
+    int64_t NextEventTick() const {
+        if (count_ == 0) return -1;
+        int64_t best = -1;
+        for (int j = 1; j < SLOTS; j++) {
+            int64_t tick = currentTick_ + j;
+            if (heads_[0][tick & SLOT_MASK] != INVALID_TIMER) {
+                best = tick;
+                break;
+            }
+        }
+        for (int level = 1; level < LEVELS; level++) {
+            int shift = SLOT_BITS * level;
+            int64_t base = currentTick_ >> shift;
+            for (int j = 1; j <= SLOTS; j++) {
+                int64_t boundary = (base + j) << shift;
+                if (best >= 0 && boundary >= best) break;
+                if (heads_[level][(base + j) & SLOT_MASK] != INVALID_TIMER) {
+                    best = boundary;
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    // 最早的到期格：第 0 层取第一个非空格；高层每层只看第一个非空槽（同层的槽按时间先后排列）中最早的定时器
+    int64_t NextFireTick() const {
+        if (count_ == 0) return -1;
+        int64_t best = -1;
+        for (int j = 1; j < SLOTS; j++) {
+            int64_t tick = currentTick_ + j;
+            if (heads_[0][tick & SLOT_MASK] != INVALID_TIMER) {
+                best = tick;
+                break;
+            }
+        }
+        for (int level = 1; level < LEVELS; level++) {
+            int shift = SLOT_BITS * level;
+            int64_t base = currentTick_ >> shift;
+            for (int j = 1; j <= SLOTS; j++) {
+                if (best >= 0 && ((base + j) << shift) >= best) break;
+                Handle h = heads_[level][(base + j) & SLOT_MASK];
+                if (h == INVALID_TIMER) continue;
+                for (; h != INVALID_TIMER; h = nodes_[h].next) {
+                    if (best < 0 || nodes_[h].tick < best) best = nodes_[h].tick;
+                }
+                break;
+            }
+        }
+        return best;
+    }
+
+    int64_t originMs_;
+    int tickMs_;
+    int64_t currentTick_ = 0;
+    size_t count_ = 0;
+    std::vector<Node> nodes_;
+    std::vector<Handle> free_;
+    Handle heads_[LEVELS][SLOTS];
+    Handle dueHead_ = INVALID_TIMER;
+};
@@ -0,0 +1,540 @@
+#pragma once
+
+// 控制台与 GUI 共用的 Windows 蓝牙实现：地址/GUID 转换、按适配器枚举已配对设备、已安装服务缓存、
+// 服务切换顺序与到达时段的持久化、通过禁用/启用服务发起连接，以及供监控核心使用的 WinBluetoothBackend。
+// 共享状态（适配器句柄、服务缓存、学习结果、运行指标等）是本头文件中的全局对象，每个程序只有一个翻译单元包含它。
+// 日志经 SetWinBluetoothLog 设置的回调输出（控制台写标准输出，GUI 写日志环形缓冲区），未设置时丢弃。
+
+#include <windows.h>
+#include <bluetoothapis.h>
+
+#include <chrono>
+#include <codecvt>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <locale>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ArrivalPredictor.h"
+#include "BtTypes.h"
+#include "Cancellation.h"
+#include "LinkWaiter.h"
+#include "Metrics.h"
+#include "MonitorCore.h"
+#include "RadioManager.h"
+#include "ScanArena.h"
+#include "ServiceCache.h"
+#include "ServiceRanking.h"
+#include "WinRadioBackend.h"
+
+typedef void (*WinBluetoothLogFn)(const std::wstring& line);
+
+inline WinBluetoothLogFn g_winBluetoothLog = nullptr;
+
+// 设置日志回调（启动时、创建任何线程之前调用一次）
+inline void SetWinBluetoothLog(WinBluetoothLogFn log) {
+    g_winBluetoothLog = log;
+}
+
+inline void WinBluetoothLog(const std::wstring& line) {
+    if (g_winBluetoothLog) g_winBluetoothLog(line);
+}
+
+// 运行指标（控制台 Ctrl+Break / GUI“运行统计”按钮输出）
+inline Metrics g_metrics;
+
+inline uint64_t ElapsedUs(std::chrono::steady_clock::time_point start) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 输出全部运行指标
+inline void DumpMetrics() {
+    std::wostringstream out;
+    g_metrics.Dump(out);
+    std::wistringstream lines(out.str());
+    std::wstring line;
+    while (std::getline(lines, line)) WinBluetoothLog(line);
+}
+
+// 将 BLUETOOTH_ADDRESS 转换为字符串
+inline std::wstring BluetoothAddressToString(const BLUETOOTH_ADDRESS& addr) {
+    wchar_t buffer[18];
+    swprintf_s(buffer, L"%02X:%02X:%02X:%02X:%02X:%02X",
+        addr.rgBytes[5], addr.rgBytes[4], addr.rgBytes[3],
+        addr.rgBytes[2], addr.rgBytes[1], addr.rgBytes[0]);
+    return std::wstring(buffer);
+}
+
+// 将 BLUETOOTH_ADDRESS 打包为 48 位整数
+inline BtAddr ToBtAddr(const BLUETOOTH_ADDRESS& addr) {
+    return addr.ullLong & BT_ADDR_MASK;
+}
+
+inline BLUETOOTH_ADDRESS ToBluetoothAddress(BtAddr addr) {
+    BLUETOOTH_ADDRESS address = { 0 };
+    address.ullLong = addr & BT_ADDR_MASK;
+    return address;
+}
+
+// GUID 与 BtUuid 内存布局一致，直接按字节复制
+static_assert(sizeof(BtUuid) == sizeof(GUID), "BtUuid 必须与 GUID 布局一致");
+
+inline BtUuid ToBtUuid(const GUID& guid) {
+    BtUuid uuid;
+    memcpy(&uuid, &guid, sizeof(uuid));
+    return uuid;
+}
+
+inline GUID ToGuid(const BtUuid& uuid) {
+    GUID guid;
+    memcpy(&guid, &uuid, sizeof(guid));
+    return guid;
+}
+
+// 辅助：错误码转字符串
+inline std::wstring Win32ErrorToString(DWORD code) {
+    LPWSTR buf = nullptr;
+    DWORD len = FormatMessageW(
+        FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+        NULL, code, 0, (LPWSTR)&buf, 0, NULL);
+    std::wstring msg = len ? std::wstring(buf) : L"";
+    if (buf) LocalFree(buf);
+    return msg;
+}
+
+// 辅助：GUID 转字符串
+inline std::wstring GuidToString(const GUID& g) {
+    wchar_t buf[64];
+    swprintf_s(buf, 64, L"{%08lX-%04hX-%04hX-%02X%02X-%02X%02X%02X%02X%02X%02X}",
+        g.Data1, g.Data2, g.Data3,
+        g.Data4[0], g.Data4[1], g.Data4[2], g.Data4[3], g.Data4[4], g.Data4[5], g.Data4[6], g.Data4[7]);
+    return std::wstring(buf);
+}
+
+// 蓝牙设备信息结构
+struct BluetoothDeviceInfo {
+    BLUETOOTH_ADDRESS address;
+    std::wstring name;
+    bool connected;
+    int radio = 0;      // 所属适配器（g_radios 下标）
+};
+
+// 本地适配器句柄：只打开一次并在各线程间共享，出错或适配器移除后重新打开
+inline WinRadioBackend g_radioBackend;
+inline RadioManager g_radios(g_radioBackend);
+
+// 枚举一个适配器上的已配对设备（hRadio 为 NULL 时不区分适配器），原始记录追加到 arena，返回枚举的错误码
+inline DWORD EnumerateRadioDevices(HANDLE hRadio, int radioIndex, bool doInquiry, ScanArena& arena) {
+    BLUETOOTH_DEVICE_SEARCH_PARAMS searchParams = { 0 };
+    searchParams.dwSize = sizeof(BLUETOOTH_DEVICE_SEARCH_PARAMS);
+    searchParams.fReturnAuthenticated = TRUE;
+    searchParams.fReturnRemembered = TRUE;
+    searchParams.fReturnConnected = TRUE;
+    searchParams.fReturnUnknown = FALSE;
+    searchParams.fIssueInquiry = doInquiry ? TRUE : FALSE; // 主动扫描
+    searchParams.cTimeoutMultiplier = doInquiry ? 2 : 1;   // 适当延长一点扫描时间
+    searchParams.hRadio = hRadio;
+
+    BLUETOOTH_DEVICE_INFO deviceInfo = { 0 };
+    deviceInfo.dwSize = sizeof(BLUETOOTH_DEVICE_INFO);
+
+    HBLUETOOTH_DEVICE_FIND hFind = BluetoothFindFirstDevice(&searchParams, &deviceInfo);
+    if (hFind == NULL) {
+        DWORD error = GetLastError();
+        return error == ERROR_NO_MORE_ITEMS ? ERROR_SUCCESS : error;
+    }
+    do {
+        arena.Add(ToBtAddr(deviceInfo.Address), deviceInfo.szName, deviceInfo.fConnected != FALSE, radioIndex);
+    } while (BluetoothFindNextDevice(hFind, &deviceInfo));
+
+    BluetoothFindDeviceClose(hFind);
+    return ERROR_SUCCESS;
+}
+
+// 一次枚举用到的全部缓冲区，逐次复用；同时进行的枚举（轮询与异步扫描）各用一份
+struct EnumerationScratch {
+    ScanArena merged;
+    std::vector<ScanArena> perRadio;
+    std::vector<RadioLease> radios;
+    std::vector<DWORD> errors;
+};
+
+// 设备名称驻留表：每台设备的名称只保存一份
+inline NameTable g_deviceNames;
+
+// 枚举全部适配器的已配对设备到 scratch.merged（按地址排序，同一设备与多个适配器配对时取已连接的那个）。
+// 带主动扫描且有多个适配器时各适配器并行扫描（扫描总耗时不随适配器数增加）；普通枚举很快，依次进行且不创建线程。
+// 某个适配器出错只影响它自己的结果与句柄
+inline void EnumeratePairedInto(bool doInquiry, EnumerationScratch& scratch) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t radioCount = g_radios.RadioCount();
+    scratch.radios.clear();
+    for (size_t i = 0; i < radioCount; i++) scratch.radios.push_back(g_radios.Acquire((int)i));
+    size_t slots = scratch.radios.empty() ? 1 : scratch.radios.size();
+    if (scratch.perRadio.size() != slots) scratch.perRadio.resize(slots);
+    scratch.errors.assign(slots, ERROR_SUCCESS);
+    for (auto& arena : scratch.perRadio) arena.Reset();
+
+    if (scratch.radios.empty()) {
+        scratch.errors[0] = EnumerateRadioDevices(NULL, 0, doInquiry, scratch.perRadio[0]);
+    } else if (!doInquiry || scratch.radios.size() == 1) {
+        for (size_t i = 0; i < scratch.radios.size(); i++) {
+            if (!scratch.radios[i]) continue;
+            scratch.errors[i] = EnumerateRadioDevices(scratch.radios[i].Get(), (int)i, doInquiry, scratch.perRadio[i]);
+        }
+    } else {
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < scratch.radios.size(); i++) {
+            if (!scratch.radios[i]) continue;
+            workers.emplace_back([&scratch, i, doInquiry]() {
+                scratch.errors[i] = EnumerateRadioDevices(scratch.radios[i].Get(), (int)i, doInquiry, scratch.perRadio[i]);
+            });
+        }
+        for (auto& t : workers) t.join();
+    }
+
+    scratch.merged.Reset();
+    for (size_t i = 0; i < slots; i++) {
+        if (i < scratch.radios.size() && scratch.radios[i] && IsRadioHandleError(scratch.errors[i])) {
+            g_radios.ReportFailure(scratch.radios[i]);
+        }
+        scratch.merged.Append(scratch.perRadio[i]);
+    }
+    scratch.merged.Merge();
+    scratch.radios.clear();
+
+    (doInquiry ? g_metrics.inquiry : g_metrics.enumeration).Record(ElapsedUs(start));
+}
+
+// 带可选主动查询的设备获取（用于提高“在线/可连接”检测的及时性），供启动与界面刷新使用；
+// 监控循环的枚举直接写入复用的 PairedDevice 列表（WinBluetoothBackend::EnumeratePaired）
+inline std::vector<BluetoothDeviceInfo> GetPairedDevicesWithInquiry(bool doInquiry) {
+    EnumerationScratch scratch;
+    EnumeratePairedInto(doInquiry, scratch);
+    std::vector<BluetoothDeviceInfo> devices;
+    devices.reserve(scratch.merged.Size());
+    for (const auto& record : scratch.merged.Records()) {
+        BluetoothDeviceInfo info;
+        info.address = ToBluetoothAddress(record.address);
+        g_deviceNames.Intern(record.address, scratch.merged.Name(record), record.nameLength, info.name);
+        info.connected = record.connected;
+        info.radio = record.radio;
+        devices.push_back(info);
+    }
+    return devices;
+}
+
+// 输出适配器句柄统计
+inline void LogRadioStats() {
+    RadioStats stats = g_radios.Stats();
+    WinBluetoothLog(L"[统计] 适配器句柄：借用 " + std::to_wstring(stats.acquires) + L"，复用 " + std::to_wstring(stats.reuses) +
+        L"，打开 " + std::to_wstring(stats.opens) + L"，重新打开 " + std::to_wstring(stats.reopens) +
+        L"，句柄错误 " + std::to_wstring(stats.failures) + L"，适配器 " + std::to_wstring(stats.radios) + L" 个");
+    for (size_t i = 0; i < stats.radioFailures.size(); i++) {
+        if (stats.radioFailures[i] > 0) {
+            WinBluetoothLog(L"[统计]   适配器 #" + std::to_wstring(i) + L" 句柄错误 " + std::to_wstring(stats.radioFailures[i]));
+        }
+    }
+}
+
+// 已安装服务缓存（连接与断开共用）
+inline ServiceCache g_serviceCache;
+
+// 获取设备已安装的服务：优先使用缓存，未命中时枚举并写入缓存；fromCache 为非空时写入是否来自缓存
+inline std::vector<GUID> GetInstalledServices(HANDLE hRadio, const BLUETOOTH_DEVICE_INFO& deviceInfo, bool* fromCache = nullptr) {
+    BtAddr addr = ToBtAddr(deviceInfo.Address);
+    std::vector<BtUuid> cached;
+    std::vector<GUID> installed;
+    bool hit = g_serviceCache.Lookup(addr, cached);
+    if (fromCache) *fromCache = hit;
+    if (hit) {
+        for (const auto& uuid : cached) installed.push_back(ToGuid(uuid));
+        return installed;
+    }
+
+    const DWORD CAP = 32;
+    GUID guids[CAP] = {};
+    DWORD returned = CAP;
+    DWORD er = BluetoothEnumerateInstalledServices(hRadio, &deviceInfo, &returned, guids);
+    if (er == ERROR_SUCCESS && returned > 0) {
+        for (DWORD i = 0; i < returned; ++i) {
+            installed.push_back(guids[i]);
+            cached.push_back(ToBtUuid(guids[i]));
+        }
+        g_serviceCache.Store(addr, cached);
+    }
+    return installed;
+}
+
+// 服务切换顺序学习结果（持久化到 service_ranking.txt）
+inline ServiceRanking g_serviceRanking;
+inline const wchar_t SERVICE_RANKING_FILE[] = L"service_ranking.txt";
+inline std::mutex g_serviceRankingFileMutex;
+
+inline void LoadServiceRanking() {
+    std::wifstream file(SERVICE_RANKING_FILE);
+    if (!file.is_open()) return;
+    file.imbue(std::locale(std::locale(), new std::codecvt_utf8<wchar_t>));
+    g_serviceRanking.Load(file);
+}
+
+inline void SaveServiceRanking() {
+    std::lock_guard<std::mutex> lock(g_serviceRankingFileMutex);
+    std::wofstream file(SERVICE_RANKING_FILE, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) return;
+    file.imbue(std::locale(std::locale(), new std::codecvt_utf8<wchar_t>));
+    g_serviceRanking.Save(file);
+}
+
+// 设备到达时段记录（持久化到 arrival_history.txt），用于安排主动扫描的疏密
+inline ArrivalPredictor g_arrivalPredictor;
+inline const wchar_t ARRIVAL_HISTORY_FILE[] = L"arrival_history.txt";
+
+inline void LoadArrivalHistory() {
+    std::wifstream file(ARRIVAL_HISTORY_FILE);
+    if (!file.is_open()) return;
+    file.imbue(std::locale(std::locale(), new std::codecvt_utf8<wchar_t>));
+    g_arrivalPredictor.Load(file);
+}
+
+// 只在监控线程中调用
+inline void SaveArrivalHistory() {
+    std::wofstream file(ARRIVAL_HISTORY_FILE, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) return;
+    file.imbue(std::locale(std::locale(), new std::codecvt_utf8<wchar_t>));
+    g_arrivalPredictor.Save(file);
+}
+
+// 本地时间一天中的毫秒数与 clock.NowMs() 的差，供 MonitorCore 换算到达时段
+inline int64_t LocalDayOffsetMs(IClock& clock) {
+    SYSTEMTIME st;
+    GetLocalTime(&st);
+    int64_t msOfDay = (((int64_t)st.wHour * 60 + st.wMinute) * 60 + st.wSecond) * 1000 + st.wMilliseconds;
+    return msOfDay - clock.NowMs();
+}
+
+// 记录一次成功连接：耗时计入学习前/后统计，建立连接的服务（已知时）排到最前并保存
+inline void RecordConnectSuccess(BtAddr addr, const GUID* service, bool learned, std::chrono::steady_clock::time_point start) {
+    uint64_t ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    g_serviceRanking.RecordConnectTime(ms, learned);
+    if (service) {
+        g_serviceRanking.RecordSuccess(addr, ToBtUuid(*service));
+        SaveServiceRanking();
+    }
+    WinBluetoothLog(L"  连接耗时 " + std::to_wstring(ms) + L" ms" + (learned ? L"（按学习顺序）" : L""));
+}
+
+// 输出连接耗时统计（学习前/后）
+inline void LogConnectTimingStats() {
+    ConnectTimingStats stats = g_serviceRanking.Timing();
+    WinBluetoothLog(L"[统计] 连接耗时：默认顺序平均 " + std::to_wstring(stats.UnlearnedAvgMs()) + L" ms（" + std::to_wstring(stats.unlearnedConnects) +
+        L" 次），学习顺序平均 " + std::to_wstring(stats.LearnedAvgMs()) + L" ms（" + std::to_wstring(stats.learnedConnects) + L" 次）");
+}
+
+// 链路建立等待（按设备类别学习截止时间）
+inline SteadyClock g_linkClock;
+inline LinkWaiter g_linkWaiter(g_linkClock);
+
+// 输出各设备类别的建链耗时分布
+inline void LogLinkWaitStats() {
+    for (const auto& s : g_linkWaiter.Stats()) {
+        WinBluetoothLog(L"[统计] 建链耗时（" + std::wstring(MajorDeviceClassName(s.deviceClass)) + L"）：成功 " + std::to_wstring(s.linked) +
+            L" 次，超时 " + std::to_wstring(s.timeouts) + L" 次，p50 " + std::to_wstring(s.p50Ms) + L" ms，p95 " + std::to_wstring(s.p95Ms) +
+            L" ms，最大 " + std::to_wstring(s.maxMs) + L" ms，当前截止 " + std::to_wstring(s.deadlineMs) + L" ms");
+    }
+}
+
+// 输出服务缓存统计
+inline void LogServiceCacheStats() {
+    ServiceCacheStats stats = g_serviceCache.Stats();
+    WinBluetoothLog(L"[统计] 服务缓存：命中 " + std::to_wstring(stats.hits) + L"，未命中 " + std::to_wstring(stats.misses) +
+        L"，失效 " + std::to_wstring(stats.invalidations) + L"，缓存设备 " + std::to_wstring(stats.entries) +
+        L"，约节省 " + std::to_wstring((uint64_t)stats.HitsPerHour()) + L" 次服务枚举/小时");
+}
+
+// 辅助：判断服务是否为音频相关
+inline bool IsAudioService(const GUID& guid) {
+    // Audio Source, Audio Sink, A/V Remote Control, Handsfree, Headset
+    return (guid == AudioSinkServiceClass_UUID ||
+            guid == AudioSourceServiceClass_UUID ||
+            guid == AVRemoteControlTargetServiceClass_UUID ||
+            guid == AVRemoteControlServiceClass_UUID ||
+            guid == HandsfreeServiceClass_UUID ||
+            guid == HeadsetServiceClass_UUID);
+}
+
+// 辅助：判断服务是否为 GATT 服务
+inline bool IsGATTService(const GUID& guid) {
+    // Generic Access (0x1800), Generic Attribute (0x1801)
+    return (guid.Data1 == 0x1800 || guid.Data1 == 0x1801) &&
+           guid.Data2 == 0x0000 && guid.Data3 == 0x1000;
+}
+
+// 连接蓝牙设备（参考提供的代码：通过禁用/启用音频相关服务触发连接）
+// op 在每次蓝牙 API 调用之间检查：取消（停止监控）时立即放弃，超过截止时间记为超时
+inline bool ConnectDevice(const BLUETOOTH_ADDRESS& address, const std::wstring& deviceName, int radioIndex, OperationContext& op) {
+    WinBluetoothLog(L"尝试连接设备: " + deviceName + L" [" + BluetoothAddressToString(address) + L"]");
+    BtAddr addr = ToBtAddr(address);
+    // 已取消或超时时记下原因并返回 true
+    auto stopped = [&]() {
+        OperationStatus status = op.Check();
+        if (status == OperationStatus::Ok) return false;
+        WinBluetoothLog(std::wstring(L"  连接") + OperationStatusName(status));
+        if (status == OperationStatus::TimedOut) g_metrics.RecordConnectFailure(addr, deviceName, ERROR_TIMEOUT);
+        return true;
+    };
+
+    BLUETOOTH_DEVICE_INFO deviceInfo = { 0 };
+    deviceInfo.dwSize = sizeof(BLUETOOTH_DEVICE_INFO);
+    deviceInfo.Address = address;
+
+    // 获取设备信息
+    DWORD result = BluetoothGetDeviceInfo(NULL, &deviceInfo);
+    if (result != ERROR_SUCCESS) {
+        WinBluetoothLog(L"  获取设备信息失败: " + std::to_wstring(result) + L" " + Win32ErrorToString(result));
+        g_metrics.RecordConnectFailure(addr, deviceName, result);
+        return false;
+    }
+
+    if (deviceInfo.fConnected) {
+        WinBluetoothLog(L"  设备已连接");
+        return true;
+    }
+    if (stopped()) return false;
+
+    // 借用设备所属适配器的句柄（共享，无需关闭）；适配器已不存在时退回第一个
+    RadioLease radio = g_radios.Acquire(radioIndex);
+    if (!radio) radio = g_radios.Acquire();
+    if (!radio) {
+        WinBluetoothLog(L"  未找到蓝牙适配器");
+        return false;
+    }
+    HANDLE hRadio = radio.Get();
+
+    // 优先从“已安装服务”中过滤目标服务，减少 1060/87 错误
+    bool installedFromCache = false;
+    std::vector<GUID> installed = GetInstalledServices(hRadio, deviceInfo, &installedFromCache);
+    if (stopped()) return false;
+
+    auto contains = [](const std::vector<GUID>& vec, const GUID& g) {
+        for (const auto& x : vec) if (x == g) return true; return false;
+    };
+
+    // 参考实现：先禁用再启用常见音频相关服务（按优先级）
+    std::vector<GUID> wanted = {
+        AudioSinkServiceClass_UUID,                 // A2DP 音频接收器
+        AudioSourceServiceClass_UUID,               // A2DP 音频源
+        HandsfreeServiceClass_UUID,                 // 免提
+        HeadsetServiceClass_UUID,                   // 头戴式/耳机
+        AVRemoteControlTargetServiceClass_UUID,     // AVRCP 目标
+        AVRemoteControlServiceClass_UUID            // AVRCP 控制器
+    };
+
+    std::vector<GUID> services;
+    if (!installed.empty()) {
+        for (const auto& g : wanted) if (contains(installed, g)) services.push_back(g);
+    }
+    if (services.empty()) services = wanted; // 无法枚举时按全量尝试
+
+    // 按学习结果排列：上次建立连接的服务优先
+    bool learned = g_serviceRanking.HasRanking(addr);
+    if (learned) {
+        std::vector<BtUuid> candidates;
+        for (const auto& g : services) candidates.push_back(ToBtUuid(g));
+        services.clear();
+        for (const auto& u : g_serviceRanking.Order(addr, candidates)) services.push_back(ToGuid(u));
+    }
+    // 设备类别决定等待链路建立的截止时间
+    uint32_t deviceClass = MajorDeviceClass(deviceInfo.ulClassofDevice);
+    auto toggleStart = std::chrono::steady_clock::now();
+
+    bool anySuccess = false;
+    DWORD lastError = ERROR_SUCCESS;
+    for (const auto& svc : services) {
+        if (stopped()) return false;
+        // 先禁用
+        auto serviceStart = std::chrono::steady_clock::now();
+        BluetoothSetServiceState(hRadio, &deviceInfo, &svc, BLUETOOTH_SERVICE_DISABLE);
+        op.Wait(150);
+        if (stopped()) return false;
+
+        // 再启用（先用 hRadio，87 时回退到 NULL）
+        DWORD r = BluetoothSetServiceState(hRadio, &deviceInfo, &svc, BLUETOOTH_SERVICE_ENABLE);
+        if (r == ERROR_INVALID_PARAMETER) {
+            r = BluetoothSetServiceState(NULL, &deviceInfo, &svc, BLUETOOTH_SERVICE_ENABLE);
+        }
+        if (IsRadioHandleError(r)) g_radios.ReportFailure(radio);
+        if (r == ERROR_SUCCESS) {
+            anySuccess = true;
+            g_metrics.serviceToggle.Record(ElapsedUs(serviceStart));
+            WinBluetoothLog(L"  成功启用服务: " + GuidToString(svc));
+            // 按递增间隔检查连接状态，链路建立后立即返回
+            LinkWaitResult wait = g_linkWaiter.Wait(deviceClass, [&]() {
+                DWORD r2 = BluetoothGetDeviceInfo(NULL, &deviceInfo);
+                return r2 == ERROR_SUCCESS && deviceInfo.fConnected;
+            }, &op);
+            if (wait.linked) {
+                WinBluetoothLog(L"  连接成功（链路建立 " + std::to_wstring(wait.elapsedMs) + L" ms）");
+                RecordConnectSuccess(addr, &svc, learned, toggleStart);
+                g_metrics.RecordConnectSuccess(addr, deviceName);
+                return true;
+            }
+        } else if (r == ERROR_SERVICE_DOES_NOT_EXIST) {
+            // 跳过未安装的服务，减少噪声；该服务取自缓存的服务列表时，说明缓存已过期
+            g_serviceCache.OnServiceMissing(addr, ToBtUuid(svc), installedFromCache);
+            lastError = r;
+        } else {
+            WinBluetoothLog(L"  启用服务失败: " + std::to_wstring(r) + L" " + Win32ErrorToString(r));
+            lastError = r;
+        }
+    }
+
+    if (stopped()) return false;
+    // 最终再检查一次连接状态
+    DWORD r3 = BluetoothGetDeviceInfo(NULL, &deviceInfo);
+    if (r3 == ERROR_SUCCESS && deviceInfo.fConnected) {
+        WinBluetoothLog(L"  连接成功");
+        RecordConnectSuccess(addr, nullptr, learned, toggleStart);
+        g_metrics.RecordConnectSuccess(addr, deviceName);
+        return true;
+    }
+
+    WinBluetoothLog(L"  连接失败");
+    // 服务已启用但链路未建立记为超时，否则记最后一次启用失败的错误码
+    g_metrics.RecordConnectFailure(addr, deviceName, anySuccess ? ERROR_TIMEOUT : lastError);
+    return false;
+}
+
+// Windows 蓝牙后端：供监控核心枚举设备、确认连接状态与发起连接
+class WinBluetoothBackend : public IBluetoothBackend {
+public:
+    // 轮询与扫描可能在不同线程同时进行，各用一份暂存区；稳态下不分配内存
+    void EnumeratePaired(bool inquiry, std::vector<PairedDevice>& out) override {
+        EnumerationScratch& scratch = inquiry ? inquiryScratch_ : pollScratch_;
+        EnumeratePairedInto(inquiry, scratch);
+        scratch.merged.CopyTo(out, g_deviceNames);
+    }
+
+    // 确认设备是否真的断开（列表/事件状态可能短暂不同步）
+    bool IsConnected(BtAddr address) override {
+        BLUETOOTH_DEVICE_INFO di = {0};
+        di.dwSize = sizeof(BLUETOOTH_DEVICE_INFO);
+        di.Address = ToBluetoothAddress(address);
+        DWORD rchk = BluetoothGetDeviceInfo(NULL, &di);
+        return rchk == ERROR_SUCCESS && di.fConnected;
+    }
+
+    bool Connect(BtAddr address, int radio, const std::wstring& name, OperationContext& op) override {
+        return ConnectDevice(ToBluetoothAddress(address), name, radio, op);
+    }
+
+private:
+    EnumerationScratch pollScratch_;
+    EnumerationScratch inquiryScratch_;
+};
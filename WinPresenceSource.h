@@ -0,0 +1,253 @@
+#pragma once
+
+// Windows 事件源：在独立线程上创建仅消息窗口，针对每个本地蓝牙无线电句柄注册设备通知，
+// 将 HCI 连接/断开、设备进入/离开范围转换为 PresenceEvent。
+// 通知只在注册了的无线电上产生：任一无线电注册失败或被移除时全部撤销并报告事件源失效（回退到轮询），
+// 不以只覆盖部分适配器的状态运行。另外监听蓝牙适配器接口的接入：适配器接入（包括移除后重新接入）时
+// 重新打开全部无线电并注册，成功后报告事件源恢复；共享句柄（RadioManager）同时失效，以便打开新接入的适配器。
+
+#include <windows.h>
+#include <dbt.h>
+#include <bluetoothapis.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PresenceEngine.h"
+#include "RadioManager.h"
+#include "WinRadioBackend.h"
+
+// 与 bthdef.h 中的定义一致；在此直接给出数值，避免依赖 initguid.h 的实例化方式
+static const GUID BT_EVENT_HCI = { 0xfc240062, 0x1541, 0x49be, { 0xb4, 0x63, 0x84, 0xc4, 0xdc, 0xd7, 0xbf, 0x7f } };
+static const GUID BT_EVENT_RADIO_IN_RANGE = { 0xea3b5b82, 0x26ee, 0x450e, { 0xb0, 0xd8, 0xd2, 0x6f, 0xe3, 0x0a, 0x38, 0x69 } };
+static const GUID BT_EVENT_RADIO_OUT_OF_RANGE = { 0xe28867c9, 0xc2aa, 0x4ced, { 0xb9, 0x69, 0x45, 0x70, 0x86, 0x60, 0x37, 0xc4 } };
+// GUID_BTHPORT_DEVICE_INTERFACE：本地蓝牙适配器的设备接口类
+static const GUID BT_BTHPORT_INTERFACE = { 0x0850302a, 0xb344, 0x4fda, { 0x9b, 0xe9, 0x90, 0x57, 0x6b, 0x8d, 0x46, 0xf0 } };
+
+// HCI 连接类型：SCO 为通话语音链路，不代表设备上下线
+static const unsigned char BT_HCI_CONNECTION_TYPE_SCO = 2;
+
+class WinPresenceSource : public IPresenceSource {
+public:
+    // radios 为程序共享的适配器句柄（可为空），适配器接入时使其失效
+    explicit WinPresenceSource(RadioManager* radios = nullptr) : radios_(radios) {}
+
+    ~WinPresenceSource() {
+        Stop();
+    }
+
+    const wchar_t* Name() const override { return L"WM_DEVICECHANGE"; }
+
+    bool Start(IPresenceSink* sink) override {
+        Stop();
+        sink_ = sink;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            startState_ = StartState::Pending;
+        }
+        thread_ = std::thread(&WinPresenceSource::Run, this);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return startState_ != StartState::Pending; });
+        return startState_ == StartState::Running;
+    }
+
+    void Stop() override {
+        if (!thread_.joinable()) return;
+        HWND hwnd = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            hwnd = hwnd_;
+        }
+        if (hwnd) PostMessageW(hwnd, WM_CLOSE, 0, 0);
+        thread_.join();
+        sink_ = nullptr;
+    }
+
+private:
+    // Standby：窗口已创建但无线电注册失败，等待适配器接入后再报告可用
+    enum class StartState { Pending, Running, Standby, Failed };
+
+    void SetStartState(StartState state) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        startState_ = state;
+        cv_.notify_all();
+    }
+
+    void Run() {
+        static const wchar_t SINK_CLASS[] = L"BluetoothPresenceSink";
+        HINSTANCE hInst = GetModuleHandleW(NULL);
+
+        WNDCLASSW wc = {};
+        wc.lpfnWndProc = WndProc;
+        wc.hInstance = hInst;
+        wc.lpszClassName = SINK_CLASS;
+        RegisterClassW(&wc);  // 重复注册失败无妨
+
+        HWND hwnd = CreateWindowExW(0, SINK_CLASS, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, hInst, NULL);
+        if (!hwnd) {
+            SetStartState(StartState::Failed);
+            return;
+        }
+        SetWindowLongPtrW(hwnd, GWLP_USERDATA, (LONG_PTR)this);
+
+        DEV_BROADCAST_DEVICEINTERFACE_W filter = {};
+        filter.dbcc_size = sizeof(DEV_BROADCAST_DEVICEINTERFACE_W);
+        filter.dbcc_devicetype = DBT_DEVTYP_DEVICEINTERFACE;
+        filter.dbcc_classguid = BT_BTHPORT_INTERFACE;
+        HDEVNOTIFY interfaceNotify = RegisterDeviceNotificationW(hwnd, &filter, DEVICE_NOTIFY_WINDOW_HANDLE);
+
+        bool registered = RegisterRadios(hwnd);
+        if (!registered && !interfaceNotify) {
+            DestroyWindow(hwnd);
+            SetStartState(StartState::Failed);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            hwnd_ = hwnd;
+        }
+        SetStartState(registered ? StartState::Running : StartState::Standby);
+
+        MSG msg = {};
+        while (GetMessageW(&msg, NULL, 0, 0) > 0) {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+
+        UnregisterRadios();
+        if (interfaceNotify) UnregisterDeviceNotification(interfaceNotify);
+        std::lock_guard<std::mutex> lock(mutex_);
+        hwnd_ = nullptr;
+    }
+
+    // 打开全部本地无线电（与 g_radios 相同的枚举顺序），逐个注册针对该句柄的自定义事件通知。
+    // 任一无线电注册失败时全部撤销并返回 false
+    bool RegisterRadios(HWND hwnd) {
+        std::vector<RadioHandle> handles = WinRadioBackend().OpenRadios();
+        bool ok = !handles.empty();
+        for (RadioHandle handle : handles) {
+            HDEVNOTIFY notify = nullptr;
+            if (ok) {
+                DEV_BROADCAST_HANDLE filter = {};
+                filter.dbch_size = sizeof(DEV_BROADCAST_HANDLE);
+                filter.dbch_devicetype = DBT_DEVTYP_HANDLE;
+                filter.dbch_handle = handle;
+                notify = RegisterDeviceNotificationW(hwnd, &filter, DEVICE_NOTIFY_WINDOW_HANDLE);
+                ok = notify != nullptr;
+            }
+            notifies_.push_back(RadioNotify{ handle, notify });
+        }
+        if (!ok) UnregisterRadios();
+        return ok;
+    }
+
+    void UnregisterRadios() {
+        for (const auto& radio : notifies_) {
+            if (radio.notify) UnregisterDeviceNotification(radio.notify);
+            if (radio.handle) CloseHandle(radio.handle);
+        }
+        notifies_.clear();
+    }
+
+    bool IsOurRadio(HANDLE handle) const {
+        for (const auto& radio : notifies_) {
+            if (radio.handle == handle) return true;
+        }
+        return false;
+    }
+
+    // 适配器接入：重新打开全部无线电并注册（覆盖新接入的适配器），可用性变化时通知引擎
+    void OnRadioArrival(HWND hwnd) {
+        bool wasLive = !notifies_.empty();
+        UnregisterRadios();
+        if (radios_) radios_->Invalidate();
+        bool live = RegisterRadios(hwnd);
+        if (live != wasLive && sink_) sink_->OnSourceState(live);
+    }
+
+    static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        auto* self = (WinPresenceSource*)GetWindowLongPtrW(hwnd, GWLP_USERDATA);
+        switch (msg) {
+        case WM_DEVICECHANGE:
+            if (self) self->OnDeviceChange(hwnd, wParam, lParam);
+            return TRUE;
+        case WM_CLOSE:
+            DestroyWindow(hwnd);
+            return 0;
+        case WM_DESTROY:
+            PostQuitMessage(0);
+            return 0;
+        }
+        return DefWindowProcW(hwnd, msg, wParam, lParam);
+    }
+
+    void Emit(PresenceEventType type, BTH_ADDR address) {
+        PresenceEvent ev;
+        ev.type = type;
+        ev.address = (BtAddr)address & BT_ADDR_MASK;
+        ev.observedAt = std::chrono::steady_clock::now();
+        if (sink_) sink_->OnPresenceEvent(ev);
+    }
+
+    void OnDeviceChange(HWND hwnd, WPARAM wParam, LPARAM lParam) {
+        PDEV_BROADCAST_HDR hdr = (PDEV_BROADCAST_HDR)lParam;
+        if (!hdr) return;
+        // 只注册了适配器接口类的通知
+        if (hdr->dbch_devicetype == DBT_DEVTYP_DEVICEINTERFACE) {
+            if (wParam == DBT_DEVICEARRIVAL) OnRadioArrival(hwnd);
+            return;
+        }
+        if (hdr->dbch_devicetype != DBT_DEVTYP_HANDLE) return;
+        PDEV_BROADCAST_HANDLE dbh = (PDEV_BROADCAST_HANDLE)hdr;
+
+        // 某个适配器即将移除：必须释放它的句柄。其余适配器的通知一并撤销，回退到轮询直到适配器重新接入
+        if (wParam == DBT_DEVICEQUERYREMOVE || wParam == DBT_DEVICEREMOVECOMPLETE) {
+            if (!IsOurRadio(dbh->dbch_handle)) return;
+            UnregisterRadios();
+            if (sink_) sink_->OnSourceState(false);
+            return;
+        }
+        if (wParam != DBT_CUSTOMEVENT) return;
+
+        if (dbh->dbch_eventguid == BT_EVENT_HCI) {
+            const BTH_HCI_EVENT_INFO* info = (const BTH_HCI_EVENT_INFO*)dbh->dbch_data;
+            if (info->connectionType == BT_HCI_CONNECTION_TYPE_SCO) return;
+            Emit(info->connected ? PresenceEventType::Connected : PresenceEventType::Disconnected, info->bthAddress);
+        }
+        else if (dbh->dbch_eventguid == BT_EVENT_RADIO_IN_RANGE) {
+            const BTH_RADIO_IN_RANGE* range = (const BTH_RADIO_IN_RANGE*)dbh->dbch_data;
+            bool nowConnected = (range->deviceInfo.flags & BDIF_CONNECTED) != 0;
+            bool wasConnected = (range->previousDeviceFlags & BDIF_CONNECTED) != 0;
+            if (nowConnected && !wasConnected) {
+                Emit(PresenceEventType::Connected, range->deviceInfo.address);
+            } else if (!nowConnected && wasConnected) {
+                Emit(PresenceEventType::Disconnected, range->deviceInfo.address);
+            } else if (!nowConnected) {
+                Emit(PresenceEventType::Arrived, range->deviceInfo.address);
+            }
+        }
+        else if (dbh->dbch_eventguid == BT_EVENT_RADIO_OUT_OF_RANGE) {
+            const BLUETOOTH_ADDRESS* addr = (const BLUETOOTH_ADDRESS*)dbh->dbch_data;
+            Emit(PresenceEventType::Departed, addr->ullLong);
+        }
+    }
+
+    RadioManager* radios_;
+    IPresenceSink* sink_ = nullptr;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    StartState startState_ = StartState::Pending;
+    HWND hwnd_ = nullptr;
+
+    struct RadioNotify {
+        HANDLE handle;
+        HDEVNOTIFY notify;
+    };
+    std::vector<RadioNotify> notifies_;     // 仅在事件源线程中访问
+};
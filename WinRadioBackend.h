@@ -0,0 +1,35 @@
+#pragma once
+
+// Windows 无线电后端：通过 BluetoothFindFirstRadio/BluetoothFindNextRadio 打开全部本地适配器
+
+#include <windows.h>
+#include <bluetoothapis.h>
+
+#include <vector>
+
+#include "RadioManager.h"
+
+class WinRadioBackend : public IRadioBackend {
+public:
+    std::vector<RadioHandle> OpenRadios() override {
+        std::vector<RadioHandle> radios;
+        BLUETOOTH_FIND_RADIO_PARAMS params = { sizeof(BLUETOOTH_FIND_RADIO_PARAMS) };
+        HANDLE hRadio = nullptr;
+        HBLUETOOTH_RADIO_FIND hFind = BluetoothFindFirstRadio(&params, &hRadio);
+        if (hFind == NULL) return radios;
+        do {
+            radios.push_back(hRadio);
+        } while (BluetoothFindNextRadio(hFind, &hRadio));
+        BluetoothFindRadioClose(hFind);
+        return radios;
+    }
+
+    void CloseRadio(RadioHandle handle) override {
+        if (handle) CloseHandle(handle);
+    }
+};
+
+// 句柄或适配器失效类错误：需要重新打开句柄
+inline bool IsRadioHandleError(DWORD error) {
+    return error == ERROR_INVALID_HANDLE || error == ERROR_DEVICE_REMOVED;
+}